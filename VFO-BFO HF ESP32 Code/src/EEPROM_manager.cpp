@@ -28,23 +28,8 @@ bool EEPROMManager::write(uint16_t address, const uint8_t* data, uint16_t len) {
     uint16_t bytesWritten = 0;
     
     while (bytesWritten < len) {
-        uint16_t pageBoundary = (address + bytesWritten + 32) & 0xFFE0;
-        uint16_t bytesInThisPage = min((uint16_t)(pageBoundary - (address + bytesWritten)), (uint16_t)(len - bytesWritten));
-        bytesInThisPage = min(bytesInThisPage, (uint16_t)32);
-        
-        Wire.beginTransmission(EXTERNAL_EEPROM_ADDRESS);
-        Wire.write((uint8_t)((address + bytesWritten) >> 8));
-        Wire.write((uint8_t)((address + bytesWritten) & 0xFF));
-        
-        for (uint16_t i = 0; i < bytesInThisPage; i++) {
-            if (Wire.write(data[bytesWritten + i]) != 1) {
-                Wire.endTransmission();
-                return false;
-            }
-        }
-        
-        byte error = Wire.endTransmission();
-        if (error != 0) {
+        uint16_t bytesInThisPage = writePage(address + bytesWritten, data + bytesWritten, len - bytesWritten);
+        if (bytesInThisPage == 0) {
             return false;
         }
         
@@ -55,6 +40,31 @@ bool EEPROMManager::write(uint16_t address, const uint8_t* data, uint16_t len) {
     return true;
 }
 
+// Scrive fino alla fine della pagina da 32 byte: byte scritti, 0 se errore.
+// Dopo la scrittura la EEPROM resta occupata per il ciclo interno (max 5ms)
+uint16_t EEPROMManager::writePage(uint16_t address, const uint8_t* data, uint16_t len) {
+    uint16_t pageBoundary = (address + 32) & 0xFFE0;
+    uint16_t bytesInThisPage = min((uint16_t)(pageBoundary - address), len);
+    
+    Wire.beginTransmission(EXTERNAL_EEPROM_ADDRESS);
+    Wire.write((uint8_t)(address >> 8));
+    Wire.write((uint8_t)(address & 0xFF));
+    
+    for (uint16_t i = 0; i < bytesInThisPage; i++) {
+        if (Wire.write(data[i]) != 1) {
+            Wire.endTransmission();
+            return 0;
+        }
+    }
+    
+    byte error = Wire.endTransmission();
+    if (error != 0) {
+        return 0;
+    }
+    
+    return bytesInThisPage;
+}
+
 bool EEPROMManager::read(uint16_t address, uint8_t* data, uint16_t len) {
     if (address + len > EEPROM_SIZE) {
         return false;
@@ -201,15 +211,44 @@ void EEPROMManager::requestQuickSave() {
     pendingConfig.attenuator = attenuatorEnabled;
 }
 
+// Una pagina per chiamata, senza attese: tra due pagine passa almeno il ciclo
+// di scrittura della EEPROM (EEPROM_WRITE_CYCLE_MS) invece di un delay()
 void EEPROMManager::update() {
-    if (savePending && (millis() - lastSaveRequest > saveDelay)) {
-        saveConfig(pendingConfig);
+    if (!writing) {
+        if (!savePending || millis() - lastSaveRequest <= saveDelay) {
+            return;
+        }
+        writeImage = pendingConfig;
+        writeImage.checksum = 0;
+        writeImage.checksum = calculateChecksum((uint8_t*)&writeImage, sizeof(RXConfig) - 1);
+        writeOffset = 0;
+        writing = true;
         savePending = false;
+    } else if (millis() - lastPageWrite < EEPROM_WRITE_CYCLE_MS) {
+        return;
+    }
+    
+    uint16_t written = writePage(EEPROM_CONFIG_START + writeOffset,
+                                 (const uint8_t*)&writeImage + writeOffset,
+                                 sizeof(RXConfig) - writeOffset);
+    lastPageWrite = millis();
+    
+    // Errore sul bus: la configurazione si riscrive da capo alla prossima richiesta
+    if (written == 0) {
+        writing = false;
+        savePending = true;
+        lastSaveRequest = millis();
+        return;
+    }
+    
+    writeOffset += written;
+    if (writeOffset >= sizeof(RXConfig)) {
+        writing = false;
     }
 }
 
 bool EEPROMManager::isSavePending() {
-    return savePending;
+    return savePending || writing;
 }
 
 // ==================== GESTIONE CONFIGURAZIONE RX ====================
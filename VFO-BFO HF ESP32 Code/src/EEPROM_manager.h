@@ -68,6 +68,7 @@ public:
     
 private:
     bool write(uint16_t address, const uint8_t* data, uint16_t len);
+    uint16_t writePage(uint16_t address, const uint8_t* data, uint16_t len);
     bool read(uint16_t address, uint8_t* data, uint16_t len);
     uint8_t calculateChecksum(const uint8_t* data, size_t len);
     bool verifyChecksum(const uint8_t* data, size_t len, uint8_t checksum);
@@ -77,6 +78,12 @@ private:
     unsigned long saveDelay = EEPROM_SAVE_DELAY;
     bool savePending = false;
     RXConfig pendingConfig;
+    
+    // Scrittura a pagine da update()
+    bool writing = false;
+    uint16_t writeOffset = 0;
+    unsigned long lastPageWrite = 0;
+    RXConfig writeImage;
     RXConfig currentConfig;
 }; 
 
@@ -1,77 +1,356 @@
-#include "si5351.h"
-#include "config.h"
-#include "modes.h"
-#include <Wire.h>
-
-Si5351 si5351;
-
-// Variabile per calibrazione
-long si5351Calibration = 0;
-
-// Variabili per stato BFO
-bool bfoEnabled = false;
-unsigned long bfoFrequency = 0;
-
-// Offset pitch per ogni modalità (LSB, USB, CW)
-int bfoPitchOffset[3] = {0, 0, 0}; // Inizialmente zero
-int currentBFOOffset = 0;
-
-
-void setupSI5351() {
-
-  if (si5351.init(SI5351_CRYSTAL_LOAD_8PF, 0, 0) == false) {
-    while(1) {
-      delay(1000);
-    }
-  }
-
-  si5351.set_pll(SI5351_PLL_FIXED, SI5351_PLLA);
-  si5351.drive_strength(SI5351_CLK0, SI5351_DRIVE_8MA);
-  si5351.drive_strength(SI5351_CLK1, SI5351_DRIVE_8MA);
-  si5351.output_enable(SI5351_CLK0, 1);
-  si5351.output_enable(SI5351_CLK1, 0); 
-
-  // Applica calibrazione se presente
-  if (si5351Calibration != 0) {
-    si5351.set_correction(si5351Calibration, SI5351_PLL_INPUT_XO);
-  }
-}
-
-// Aggiorna frequenza VFO
-void updateFrequency() {
-  si5351.set_freq(vfoFrequency * 100ULL, SI5351_CLK0);
-}
-
-// Aggiorna frequenza BFO
-void updateBFO() {
-  if (bfoEnabled) {
-    si5351.set_freq(bfoFrequency * 100ULL, SI5351_CLK1);
-  }
-}
-
-// Abilita BFO
-void enableBFO() {
-  bfoEnabled = true;
-  si5351.output_enable(SI5351_CLK1, 1);
-  updateBFO();// Aggiorna con l'offset corrente
-}
-// Disabilita BFO
-void disableBFO() {
-  bfoEnabled = false;
-  si5351.output_enable(SI5351_CLK1, 0);
-}
-
-// Calibrazione SI5351
-void calibrateSI5351(long calibration_factor) {
-  si5351Calibration = calibration_factor;
-  si5351.set_correction(calibration_factor, SI5351_PLL_INPUT_XO);
-  
-  // Riapplica le frequenze correnti
-  updateFrequency();
-  if (bfoEnabled) {
-    updateBFO();
-  }
-  
-  Serial.print("SI5351 calibrato con fattore: ");
-  Serial.println(calibration_factor);
-}
+#include "si5351.h"
+#include "config.h"
+#include "modes.h"
+#include "PLL.h"
+#include "PLL_plan.h"
+#include "PLL_cache.h"
+#include "PLL_spur.h"
+#include "bands.h"
+#include "radio_task.h"
+#include "radio_state.h"
+#include "keyer.h"
+#include "wspr.h"
+#include <Wire.h>
+
+Si5351 si5351;
+Si5351Shadow si5351Shadow;
+
+// Variabile per calibrazione (scritta da si5351ApplyCalibration)
+std::atomic<int32_t> si5351Calibration{0};
+
+// Variabili per stato BFO
+bool bfoEnabled = false;
+unsigned long bfoFrequency = 0;
+
+// Offset pitch per ogni modalità (LSB, USB, CW)
+int bfoPitchOffset[3] = {0, 0, 0}; // Inizialmente zero
+int currentBFOOffset = 0;
+
+// Sintonia glide del VFO (Multisynth intero fisso, si muove solo il PLLA)
+std::atomic<bool> vfoGlideMode{VFO_GLIDE_TUNING};
+static GlideWindow vfoWindow = {0, 0, 0};
+
+// PLL già programmati e resettati (A, B)
+static bool pllLocked[2] = {false, false};
+
+// Ultime frequenze scritte, riscritte da una nuova calibrazione (0 = spento)
+static unsigned long appliedVFO = 0;
+static unsigned long appliedBFO = 0;
+
+// Immagini registri pronte per i richiami (bande, BFO dei modi)
+SynthCache synthCache;
+
+// Immagini CLK2 per la manipolazione, indice = livello (KEY_SPACE / KEY_MARK o tono)
+static SynthImage keyImage[KEYER_LEVELS];
+static uint8_t keyCtrl[KEYER_LEVELS];
+static uint8_t keyLevels = 0;
+static bool keyReady = false;
+
+#define CLK_POWER_DOWN 0x80     // Bit CLKx_PDN del registro di controllo
+
+// Scrittura burst sul bus I2C con auto-incremento del registro
+static uint8_t si5351BusWrite(uint8_t reg, const uint8_t* data, uint8_t len) {
+  Wire.beginTransmission(SI5351_BUS_BASE_ADDR);
+  Wire.write(reg);
+  Wire.write(data, len);
+  return Wire.endTransmission();
+}
+
+// Immagine registri di un clock: dalla cache per i richiami, altrimenti calcolata
+static bool synthImage(enum si5351_clock clk, unsigned long freq, uint32_t msDiv, bool recall, SynthImage& image) {
+  SynthKey key = {(uint8_t)clk, (uint32_t)freq, si5351Calibration.load(), msDiv};
+  if (recall && synthCache.lookup(key, image)) return true;
+
+  SynthPlan plan;
+  uint32_t ref = correctedRef(key.correction);
+  bool planned = msDiv ? planGlide(freq, msDiv, ref, plan)
+                       : planFixedPLL(freq, PLL_FIXED_FREQ, ref, plan);
+  if (!planned) return false;
+
+  encodeSynthImage(plan, image);
+  if (recall) synthCache.insert(key, image);
+  return true;
+}
+
+// Scrive un'immagine inviando solo i registri cambiati
+static void writeClock(enum si5351_clock clk, enum si5351_pll pll, const SynthImage& image, bool msInt, bool resetPLL) {
+  uint8_t pllReg = (pll == SI5351_PLLA) ? SI5351_PLLA_PARAMETERS : SI5351_PLLB_PARAMETERS;
+  uint8_t msReg = SI5351_CLK0_PARAMETERS + 8 * clk;
+  uint8_t ctrlReg = SI5351_CLK0_CTRL + clk;
+
+  si5351Shadow.stage(msReg, image.ms, 8);
+
+  // Modo intero del Multisynth (meno jitter con divisore pari)
+  uint8_t ctrl;
+  if (si5351Shadow.get(ctrlReg, ctrl)) {
+    ctrl = msInt ? (ctrl | SI5351_CLK_INTEGER_MODE) : (ctrl & ~SI5351_CLK_INTEGER_MODE);
+    si5351Shadow.stage(ctrlReg, &ctrl, 1);
+  }
+
+  si5351Shadow.stage(pllReg, image.pll, 8);
+  if (si5351Shadow.flush() == 0) return;
+
+  // Reset del PLL solo alla prima programmazione o a un cambio di divisore
+  if (!pllLocked[pll] || resetPLL) {
+    si5351.pll_reset(pll);
+    pllLocked[pll] = true;
+  }
+}
+
+// Precalcola le immagini di inizio banda e dei BFO base
+static void prewarmSynthCache() {
+  synthCache.clear();
+
+  SynthImage image;
+  bool glide = vfoGlideMode.load();
+  for (int i = 0; i < totalBands; i++) {
+    unsigned long freq = bands[i].startFreq + IF_FREQUENCY;
+    GlideWindow window = {0, 0, 0};
+    if (glide) planSpurAwareWindow(freq, correctedRef(si5351Calibration), GlideWindow{0, 0, 0}, window);
+    synthImage(SI5351_CLK0, freq, window.msDiv, true, image);
+  }
+  synthImage(SI5351_CLK1, BFO_USB_BASE, 0, true, image);
+  synthImage(SI5351_CLK1, BFO_LSB_BASE, 0, true, image);
+  synthImage(SI5351_CLK1, BFO_CW_BASE, 0, true, image);
+
+  // Il precaricamento non conta nelle statistiche
+  synthCache.hits = 0;
+  synthCache.misses = 0;
+}
+
+// Copia dei registri ripartita da zero: controlli dei clock riletti dal chip,
+// PLL da resettare alla prossima scrittura, finestra glide e cache da rifare
+static void resyncSynth() {
+  si5351Shadow.invalidate();
+  si5351Shadow.seed(SI5351_CLK0_CTRL, si5351.si5351_read(SI5351_CLK0_CTRL));
+  si5351Shadow.seed(SI5351_CLK1_CTRL, si5351.si5351_read(SI5351_CLK1_CTRL));
+  si5351Shadow.seed(SI5351_CLK2_CTRL, si5351.si5351_read(SI5351_CLK2_CTRL));
+  pllLocked[SI5351_PLLA] = false;
+  pllLocked[SI5351_PLLB] = false;
+  vfoWindow.msDiv = 0;
+
+  prewarmSynthCache();
+}
+
+void setupSI5351() {
+
+  if (si5351.init(SI5351_CRYSTAL_LOAD_8PF, 0, 0) == false) {
+    while(1) {
+      delay(1000);
+    }
+  }
+
+  si5351.set_pll(SI5351_PLL_FIXED, SI5351_PLLA);
+  si5351.drive_strength(SI5351_CLK0, SI5351_DRIVE_8MA);
+  si5351.drive_strength(SI5351_CLK1, SI5351_DRIVE_8MA);
+  si5351.output_enable(SI5351_CLK0, 1);
+  si5351.output_enable(SI5351_CLK1, 0); 
+
+  // CLK2 (RTTY/CW) spento finché non parte la manipolazione
+  si5351.drive_strength(SI5351_CLK2, SI5351_DRIVE_8MA);
+  si5351.output_enable(SI5351_CLK2, 0);
+  si5351.set_clock_pwr(SI5351_CLK2, 0);
+
+  // Il BFO usa il PLLB: il PLLA resta libero per la sintonia glide del VFO
+  si5351.set_ms_source(SI5351_CLK1, SI5351_PLLB);
+  si5351.set_ms_source(SI5351_CLK2, SI5351_PLLB);
+
+  // La calibrazione non passa dalla libreria: i piani usano correctedRef()
+  // Da qui in poi PLL e Multisynth sono scritti tramite la copia dei registri
+  si5351Shadow.begin(si5351BusWrite);
+  resyncSynth();
+  keyReady = false;
+}
+
+// Scrive la frequenza VFO sul chip (solo dal task radio)
+void si5351ApplyVFO(unsigned long freq, bool recall) {
+  SynthImage image;
+  appliedVFO = freq;
+
+  if (!vfoGlideMode.load()) {
+    // Uscendo dal glide il PLLA torna a 800MHz: serve un reset
+    bool wasGlide = vfoWindow.msDiv != 0;
+    vfoWindow.msDiv = 0;
+
+    if (!synthImage(SI5351_CLK0, freq, 0, recall, image)) return;
+    writeClock(SI5351_CLK0, SI5351_PLLA, image, false, wasGlide);
+    return;
+  }
+
+  // Divisore dal piano della banda: cambia solo se esce dalla finestra o entra
+  // in una zona spuria. Un richiamo riparte dal divisore primario della banda.
+  GlideWindow next;
+  GlideWindow current = recall ? GlideWindow{0, 0, 0} : vfoWindow;
+  planSpurAwareWindow(freq, correctedRef(si5351Calibration), current, next);
+  if (next.msDiv == 0) return;
+
+  bool replan = next.msDiv != vfoWindow.msDiv;
+  vfoWindow = next;
+
+  if (!synthImage(SI5351_CLK0, freq, vfoWindow.msDiv, recall, image)) return;
+  writeClock(SI5351_CLK0, SI5351_PLLA, image, true, replan);
+}
+
+// Scrive la frequenza BFO sul chip, 0 = BFO spento (solo dal task radio)
+void si5351ApplyBFO(unsigned long freq, bool recall) {
+  static bool outputOn = false;
+  appliedBFO = freq;
+
+  if (freq == 0) {
+    si5351.output_enable(SI5351_CLK1, 0);
+    outputOn = false;
+    return;
+  }
+
+  SynthImage image;
+  if (!synthImage(SI5351_CLK1, freq, 0, recall, image)) return;
+  writeClock(SI5351_CLK1, SI5351_PLLB, image, false, false);
+
+  if (!outputOn) {
+    si5351.output_enable(SI5351_CLK1, 1);
+    outputOn = true;
+  }
+}
+
+// Nuovo fattore di calibrazione (solo dal task radio). Cambia il riferimento di
+// tutti i piani: copia dei registri e cache ripartono da zero e VFO e BFO
+// vengono ripianificati e riscritti per intero. La manipolazione rifà le sue
+// immagini da sola (rtty_cw.cpp segue si5351Calibration).
+void si5351ApplyCalibration(int32_t correction) {
+  si5351Calibration.store(correction);
+  resyncSynth();
+
+  if (appliedVFO != 0) si5351ApplyVFO(appliedVFO, false);
+  if (appliedBFO != 0) si5351ApplyBFO(appliedBFO, false);
+}
+
+// Immagine CLK2 di un tono (in mHz) con il PLLB a 800MHz come il BFO.
+// exact: denominatore scelto per tono, per spaziature sotto l'Hz (WSPR)
+static bool keyToneImage(uint64_t freqMilliHz, bool exact, SynthImage& image) {
+  SynthPlan plan;
+  uint32_t ref = correctedRef(si5351Calibration);
+  if (!planFixedPLLMilliHz(freqMilliHz, PLL_FIXED_FREQ, ref, plan)) return false;
+  if (exact) refineMultisynth(freqMilliHz, ref, plan);
+  encodeSynthImage(plan, image);
+  return true;
+}
+
+// Prepara le immagini CLK2 di ogni livello e accende l'uscita sul livello idle:
+// RTTY mark/space, CW tasto giù/su, WSPR i 4 toni sopra freq. Tra un livello e
+// l'altro cambiano solo i registri del Multisynth 2 o il bit di power down.
+// freq = 0 spegne il CLK2 (solo dal task radio).
+void si5351PrepareKey(uint8_t mode, unsigned long freq, uint8_t idle) {
+  if (mode == KEYER_OFF || freq == 0) {
+    if (keyReady) {
+      uint8_t ctrl = keyCtrl[0] | CLK_POWER_DOWN;
+      si5351Shadow.stage(SI5351_CLK2_CTRL, &ctrl, 1);
+      si5351Shadow.flush();
+      si5351.output_enable(SI5351_CLK2, 0);
+      keyReady = false;
+    }
+    return;
+  }
+
+  uint64_t base = (uint64_t)freq * 1000;
+  uint8_t tones = (mode == KEYER_WSPR) ? WSPR_TONES : 2;
+  if (idle >= tones) return;
+
+  for (uint8_t level = 0; level < tones; level++) {
+    uint64_t tone = base;
+    if (mode == KEYER_RTTY && level == KEY_SPACE) tone -= (uint64_t)RTTY_SHIFT * 1000;
+    if (mode == KEYER_WSPR) tone += wsprToneMilliHz(level);
+    if (!keyToneImage(tone, mode == KEYER_WSPR, keyImage[level])) return;
+  }
+
+  // Controllo CLK2 dalla copia dei registri: frazionario, sorgente PLLB
+  uint8_t ctrl;
+  if (!si5351Shadow.get(SI5351_CLK2_CTRL, ctrl)) return;
+  ctrl &= ~(CLK_POWER_DOWN | SI5351_CLK_INTEGER_MODE);
+  for (uint8_t level = 0; level < tones; level++) keyCtrl[level] = ctrl;
+  if (mode == KEYER_CW) keyCtrl[KEY_SPACE] |= CLK_POWER_DOWN;
+
+  // PLLB e Multisynth 2 sul livello di partenza
+  writeClock(SI5351_CLK2, SI5351_PLLB, keyImage[idle], false, false);
+  si5351Shadow.stage(SI5351_CLK2_CTRL, &keyCtrl[idle], 1);
+  si5351Shadow.flush();
+  keyLevels = tones;
+
+  if (!keyReady) {
+    si5351.output_enable(SI5351_CLK2, 1);
+    keyReady = true;
+  }
+}
+
+// Cambio di livello sul fronte di un simbolo: nessun calcolo, solo i byte
+// diversi tra le immagini (solo dal task radio)
+void si5351ApplyKey(uint8_t level) {
+  if (!keyReady || level >= keyLevels) return;
+  si5351Shadow.stage(SI5351_CLK2_PARAMETERS, keyImage[level].ms, 8);
+  si5351Shadow.stage(SI5351_CLK2_CTRL, &keyCtrl[level], 1);
+  si5351Shadow.flush();
+}
+
+// Sweep su CLK2: PLLB e Multisynth 2 sul primo punto, uscita accesa.
+// La manipolazione deve essere spenta; al termine si5351EndSweep() spegne il CLK2.
+bool si5351BeginSweep(const SynthImage& first) {
+  uint8_t ctrl;
+  if (!si5351Shadow.get(SI5351_CLK2_CTRL, ctrl)) return false;
+  ctrl &= ~(CLK_POWER_DOWN | SI5351_CLK_INTEGER_MODE);
+
+  keyReady = false;
+  writeClock(SI5351_CLK2, SI5351_PLLB, first, false, false);
+  si5351Shadow.stage(SI5351_CLK2_CTRL, &ctrl, 1);
+  si5351Shadow.flush();
+  si5351.output_enable(SI5351_CLK2, 1);
+  return true;
+}
+
+// Prepara nella copia dei registri il Multisynth del punto successivo:
+// la scrittura parte con si5351Shadow.flush() appena finite le letture ADC
+void si5351StageSweep(const uint8_t ms[8]) {
+  si5351Shadow.stage(SI5351_CLK2_PARAMETERS, ms, 8);
+}
+
+void si5351EndSweep() {
+  uint8_t ctrl;
+  if (si5351Shadow.get(SI5351_CLK2_CTRL, ctrl)) {
+    ctrl |= CLK_POWER_DOWN;
+    si5351Shadow.stage(SI5351_CLK2_CTRL, &ctrl, 1);
+  }
+  si5351Shadow.flush();
+  si5351.output_enable(SI5351_CLK2, 0);
+}
+
+// Riapplica la frequenza VFO corrente (la scrive il commit del loop)
+void updateFrequency() {
+  radioState.mark(DIRTY_VFO);
+}
+
+// Richiama la frequenza VFO corrente (memoria, avvio): usa la cache
+void recallFrequency() {
+  radioState.mark(DIRTY_VFO | DIRTY_VFO_RECALL);
+}
+
+// Riapplica la frequenza BFO corrente
+void updateBFO() {
+  if (bfoEnabled) {
+    radioState.mark(DIRTY_BFO);
+  }
+}
+
+// Abilita BFO (cambio modo: frequenza base dalla cache)
+void enableBFO() {
+  radioState.setBFO(true, bfoFrequency, true);
+}
+// Disabilita BFO
+void disableBFO() {
+  radioState.setBFO(false, bfoFrequency);
+}
+
+// Calibrazione SI5351: la applica il task radio, che riscrive anche VFO e BFO
+void calibrateSI5351(long calibration_factor) {
+  radioPostCalibration(calibration_factor);
+
+  Serial.print("SI5351 calibrato con fattore: ");
+  Serial.println(calibration_factor);
+}
@@ -1,15 +1,35 @@
-#ifndef PLL_H
-#define PLL_H
-
-#include <si5351.h>
-
-extern Si5351 si5351;
-
-void setupSI5351();
-void updateFrequency();
-void updateBFO();
-void enableBFO();
-void disableBFO();
-void calibrateSI5351(long calibration_factor);
-
+#ifndef PLL_H
+#define PLL_H
+
+#include <si5351.h>
+#include "PLL_shadow.h"
+#include "PLL_cache.h"
+#include <atomic>
+
+extern Si5351 si5351;
+extern Si5351Shadow si5351Shadow;   // Copia dei registri PLL/Multisynth
+extern SynthCache synthCache;       // Immagini registri per i richiami
+// Fattore di calibrazione (ppb): lo scrive solo il task radio, gli altri lo leggono
+extern std::atomic<int32_t> si5351Calibration;
+// Sintonia glide del VFO attiva: la scrive il loop (comando GLIDE), la legge il task radio
+extern std::atomic<bool> vfoGlideMode;
+
+void setupSI5351();
+void updateFrequency();
+void recallFrequency();
+void updateBFO();
+void enableBFO();
+void disableBFO();
+void calibrateSI5351(long calibration_factor);
+
+// Scrittura diretta sul chip, usate solo dal task radio
+void si5351ApplyVFO(unsigned long freq, bool recall);
+void si5351ApplyBFO(unsigned long freq, bool recall);
+void si5351ApplyCalibration(int32_t correction);          // Ripianifica e riscrive VFO e BFO
+void si5351PrepareKey(uint8_t mode, unsigned long freq, uint8_t idle);  // CLK2, freq = 0 spento
+void si5351ApplyKey(uint8_t level);                       // KEY_MARK / KEY_SPACE o tono
+bool si5351BeginSweep(const SynthImage& first);           // CLK2 acceso sul primo punto
+void si5351StageSweep(const uint8_t ms[8]);               // Multisynth 2 del punto successivo
+void si5351EndSweep();                                    // CLK2 spento
+
 #endif
\ No newline at end of file
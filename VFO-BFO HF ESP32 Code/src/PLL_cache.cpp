@@ -0,0 +1,46 @@
+#include "PLL_cache.h"
+
+bool SynthCache::lookup(const SynthKey& key, SynthImage& image) {
+    for (uint8_t i = 0; i < SYNTH_CACHE_SIZE; i++) {
+        if (entries[i].lastUse != 0 && entries[i].key == key) {
+            entries[i].lastUse = ++useCounter;
+            image = entries[i].image;
+            hits++;
+            return true;
+        }
+    }
+    misses++;
+    return false;
+}
+
+void SynthCache::insert(const SynthKey& key, const SynthImage& image) {
+    // Aggiorna l'elemento esistente, altrimenti sostituisce il meno usato
+    uint8_t victim = 0;
+    for (uint8_t i = 0; i < SYNTH_CACHE_SIZE; i++) {
+        if (entries[i].lastUse != 0 && entries[i].key == key) {
+            victim = i;
+            break;
+        }
+        if (entries[i].lastUse < entries[victim].lastUse) victim = i;
+    }
+
+    entries[victim].key = key;
+    entries[victim].image = image;
+    entries[victim].lastUse = ++useCounter;
+}
+
+void SynthCache::clear() {
+    for (uint8_t i = 0; i < SYNTH_CACHE_SIZE; i++) {
+        entries[i].lastUse = 0;
+    }
+    hits = 0;
+    misses = 0;
+}
+
+uint8_t SynthCache::size() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SYNTH_CACHE_SIZE; i++) {
+        if (entries[i].lastUse != 0) n++;
+    }
+    return n;
+}
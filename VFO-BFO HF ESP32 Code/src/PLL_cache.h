@@ -0,0 +1,46 @@
+#ifndef PLL_CACHE_H
+#define PLL_CACHE_H
+
+#include <stdint.h>
+#include "PLL_plan.h"
+
+// Cache LRU delle immagini registri già calcolate, per i richiami di banda,
+// modo e memoria: in caso di successo l'immagine si scrive senza rifare i calcoli.
+// Senza dipendenze Arduino: compila anche su host.
+
+#define SYNTH_CACHE_SIZE 24   // Bande + BFO + qualche richiamo recente
+
+struct SynthKey {
+    uint8_t clk;            // Uscita del Si5351
+    uint32_t freq;          // Frequenza richiesta (Hz)
+    int32_t correction;     // Calibrazione (ppb) usata nel calcolo
+    uint32_t msDiv;         // Divisore glide, 0 = PLL fisso
+
+    bool operator==(const SynthKey& other) const {
+        return clk == other.clk && freq == other.freq &&
+               correction == other.correction && msDiv == other.msDiv;
+    }
+};
+
+class SynthCache {
+public:
+    bool lookup(const SynthKey& key, SynthImage& image);
+    void insert(const SynthKey& key, const SynthImage& image);
+    void clear();
+    uint8_t size() const;
+
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+
+private:
+    struct Entry {
+        SynthKey key;
+        SynthImage image;
+        uint32_t lastUse;   // 0 = vuota
+    };
+
+    Entry entries[SYNTH_CACHE_SIZE] = {};
+    uint32_t useCounter = 0;
+};
+
+#endif
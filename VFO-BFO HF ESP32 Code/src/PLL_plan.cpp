@@ -0,0 +1,166 @@
+#include "PLL_plan.h"
+
+// Frazione a + num/den con den > 2^40: si riduce la precisione quanto basta
+// perché num * PLL_DENOM_MAX stia in 64 bit
+static void fraction(uint64_t num, uint64_t den, uint32_t& a, uint32_t& b, uint32_t& c) {
+  a = (uint32_t)(num / den);
+  uint64_t rem = num % den;
+
+  while (den > 0xFFFFFFFFFFULL) {
+    den >>= 1;
+    rem >>= 1;
+  }
+
+  c = PLL_DENOM_MAX;
+  b = (uint32_t)((rem * PLL_DENOM_MAX + den / 2) / den);
+  if (b >= c) {       // Arrotondamento oltre l'unità
+    a++;
+    b = 0;
+  }
+  if (b == 0) c = 1;  // Divisore intero
+}
+
+// Migliore approssimazione di rem/den con denominatore <= PLL_DENOM_MAX
+// (frazioni continue): errore ~1/c^2 invece di 1/(2c)
+static void bestFraction(uint64_t rem, uint64_t den, uint32_t& b, uint32_t& c) {
+  uint64_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+  uint64_t n = rem, d = den;
+
+  while (d != 0) {
+    uint64_t a = n / d;
+    uint64_t q2 = q0 + a * q1;
+    if (q2 > PLL_DENOM_MAX) {
+      // Semiconvergente con il denominatore più grande ammesso, se è più vicina
+      uint64_t k = (PLL_DENOM_MAX - q0) / q1;
+      uint64_t ps = p0 + k * p1, qs = q0 + k * q1;
+      double target = (double)rem / den;
+      double errorS = (double)ps / qs - target;
+      double error1 = (double)p1 / q1 - target;
+      if (k > 0 && errorS * errorS < error1 * error1) {
+        p1 = ps;
+        q1 = qs;
+      }
+      break;
+    }
+    uint64_t p2 = p0 + a * p1;
+    p0 = p1; q0 = q1;
+    p1 = p2; q1 = q2;
+
+    uint64_t r = n - a * d;
+    n = d;
+    d = r;
+  }
+
+  b = (uint32_t)p1;
+  c = (uint32_t)q1;
+  if (b == 0) c = 1;
+}
+
+uint32_t correctedRef(int32_t correction) {
+  int64_t delta = ((int64_t)PLL_XTAL_FREQ * correction) / 1000000000LL;
+  return (uint32_t)((int64_t)PLL_XTAL_FREQ + delta);
+}
+
+bool planFixedPLL(uint32_t freq, uint32_t pllFreq, uint32_t ref, SynthPlan& plan) {
+  return planFixedPLLMilliHz((uint64_t)freq * 1000, pllFreq, ref, plan);
+}
+
+bool planFixedPLLMilliHz(uint64_t freqMilliHz, uint32_t pllFreq, uint32_t ref, SynthPlan& plan) {
+  if (freqMilliHz == 0 || ref == 0) return false;
+
+  // PLL: pllFreq / ref
+  fraction(pllFreq, ref, plan.pllA, plan.pllB, plan.pllC);
+
+  // Divisore R per le uscite sotto il minimo del Multisynth (es. BFO a 455kHz)
+  uint8_t rDiv = 0;
+  while ((freqMilliHz << rDiv) < (uint64_t)PLL_MS_OUT_MIN * 1000 && rDiv < PLL_RDIV_MAX) {
+    rDiv++;
+  }
+  plan.rDiv = rDiv;
+
+  // Multisynth calcolato sulla frequenza PLL effettiva (ref * (a + b/c)),
+  // in mHz: ref * (a*c + b) * 1000 resta sotto 2^60
+  uint64_t pllNum = (uint64_t)ref * ((uint64_t)plan.pllA * plan.pllC + plan.pllB) * 1000;
+  uint64_t msDen = (uint64_t)plan.pllC * (freqMilliHz << rDiv);
+  fraction(pllNum, msDen, plan.msA, plan.msB, plan.msC);
+
+  return plan.msA >= PLL_MS_MIN && plan.msA < PLL_MS_MAX;
+}
+
+void refineMultisynth(uint64_t freqMilliHz, uint32_t ref, SynthPlan& plan) {
+  uint64_t pllNum = (uint64_t)ref * ((uint64_t)plan.pllA * plan.pllC + plan.pllB) * 1000;
+  uint64_t msDen = (uint64_t)plan.pllC * (freqMilliHz << plan.rDiv);
+  plan.msA = (uint32_t)(pllNum / msDen);
+  bestFraction(pllNum % msDen, msDen, plan.msB, plan.msC);
+}
+
+bool planGlideWindow(uint32_t freq, GlideWindow& window) {
+  window.msDiv = 0;
+  if (freq == 0) return false;
+
+  // Divisore pari più vicino al centro del VCO
+  uint32_t msDiv = ((PLL_VCO_CENTER + freq) / (2 * freq)) * 2;
+  if (msDiv < PLL_MS_MIN) msDiv = PLL_MS_MIN;
+  if (msDiv > PLL_MS_MAX) msDiv = PLL_MS_MAX;
+
+  GlideWindow candidate;
+  glideWindowFor(msDiv, candidate);
+  if (freq < candidate.low || freq > candidate.high) return false;
+
+  window = candidate;
+  return true;
+}
+
+void glideWindowFor(uint32_t msDiv, GlideWindow& window) {
+  window.msDiv = msDiv;
+  window.low = (PLL_VCO_MIN + msDiv - 1) / msDiv;
+  window.high = PLL_VCO_MAX / msDiv;
+}
+
+bool glideWindowContains(const GlideWindow& window, uint32_t freq) {
+  return window.msDiv != 0 && freq >= window.low && freq <= window.high;
+}
+
+bool planGlide(uint32_t freq, uint32_t msDiv, uint32_t ref, SynthPlan& plan) {
+  if (ref == 0 || msDiv < PLL_MS_MIN || msDiv > PLL_MS_MAX || (msDiv & 1)) return false;
+
+  uint64_t pllFreq = (uint64_t)freq * msDiv;
+  if (pllFreq < PLL_VCO_MIN || pllFreq > PLL_VCO_MAX) return false;
+
+  fraction(pllFreq, ref, plan.pllA, plan.pllB, plan.pllC);
+  plan.msA = msDiv;
+  plan.msB = 0;
+  plan.msC = 1;
+  plan.rDiv = 0;
+  return true;
+}
+
+// p1/p2/p3 secondo AN619
+static void encodeBlock(uint32_t a, uint32_t b, uint32_t c, uint8_t* regs) {
+  uint32_t f = (uint32_t)(((uint64_t)b << 7) / c);
+  uint32_t p1 = 128 * a + f - 512;
+  uint32_t p2 = (b << 7) - c * f;
+  uint32_t p3 = c;
+
+  regs[0] = (p3 >> 8) & 0xFF;
+  regs[1] = p3 & 0xFF;
+  regs[2] = (p1 >> 16) & 0x03;
+  regs[3] = (p1 >> 8) & 0xFF;
+  regs[4] = p1 & 0xFF;
+  regs[5] = ((p3 >> 12) & 0xF0) | ((p2 >> 16) & 0x0F);
+  regs[6] = (p2 >> 8) & 0xFF;
+  regs[7] = p2 & 0xFF;
+}
+
+void encodeSynthImage(const SynthPlan& plan, SynthImage& image) {
+  encodeBlock(plan.pllA, plan.pllB, plan.pllC, image.pll);
+  encodeBlock(plan.msA, plan.msB, plan.msC, image.ms);
+  image.ms[2] |= (plan.rDiv & 0x07) << 4;  // R_DIV nei bit 6:4
+}
+
+uint64_t planOutputMilliHz(const SynthPlan& plan, uint32_t ref) {
+  // uscita = ref * (pllA*pllC + pllB) * msC / (pllC * (msA*msC + msB) * 2^rDiv)
+  double pll = (double)ref * ((double)plan.pllA + (double)plan.pllB / plan.pllC);
+  double ms = (double)plan.msA + (double)plan.msB / plan.msC;
+  return (uint64_t)(pll / ms / (double)(1UL << plan.rDiv) * 1000.0 + 0.5);
+}
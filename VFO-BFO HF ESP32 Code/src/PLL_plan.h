@@ -0,0 +1,65 @@
+#ifndef PLL_PLAN_H
+#define PLL_PLAN_H
+
+#include <stdint.h>
+
+// Calcolo dei parametri PLL/Multisynth del Si5351 (AN619).
+// Modulo senza dipendenze Arduino: compila anche su host.
+
+// Limiti del Si5351
+#define PLL_XTAL_FREQ       25000000UL  // Quarzo di riferimento 25MHz
+#define PLL_VCO_MIN         600000000UL // VCO minimo 600MHz
+#define PLL_VCO_MAX         900000000UL // VCO massimo 900MHz
+#define PLL_FIXED_FREQ      800000000UL // PLL fisso usato in sintonia normale
+#define PLL_VCO_CENTER      750000000UL // Centro VCO per la finestra glide
+#define PLL_DENOM_MAX       1048575UL   // Denominatore massimo (20 bit)
+#define PLL_MS_MIN          8           // Divisore Multisynth minimo (frazionario)
+#define PLL_MS_MAX          2048        // Divisore Multisynth massimo
+#define PLL_MS_OUT_MIN      500000UL    // Uscita Multisynth minima (sotto serve R)
+#define PLL_RDIV_MAX        7           // R = 1..128 (log2)
+
+// Parametri di sintesi: PLL = ref * (pllA + pllB/pllC)
+//                       uscita = PLL / (msA + msB/msC) / 2^rDiv
+struct SynthPlan {
+  uint32_t pllA, pllB, pllC;
+  uint32_t msA, msB, msC;
+  uint8_t rDiv;
+};
+
+// Finestra di sintonia glide: Multisynth intero pari fisso, si muove solo il PLL
+struct GlideWindow {
+  uint32_t msDiv;       // Divisore intero pari (0 = nessuna finestra)
+  uint32_t low, high;   // Uscite coperte senza cambiare divisore
+};
+
+// Immagine dei registri di un clock (blocco PLL + blocco Multisynth)
+struct SynthImage {
+  uint8_t pll[8];
+  uint8_t ms[8];
+};
+
+// Frequenza di riferimento corretta (correzione in ppb, come la libreria Etherkit)
+uint32_t correctedRef(int32_t correction);
+
+// Pianifica un'uscita con PLL fisso: tutta la sintonia è nel Multisynth
+bool planFixedPLL(uint32_t freq, uint32_t pllFreq, uint32_t ref, SynthPlan& plan);
+bool planFixedPLLMilliHz(uint64_t freqMilliHz, uint32_t pllFreq, uint32_t ref, SynthPlan& plan);  // Toni sotto l'Hz
+// Rifinisce il Multisynth di un piano fisso scegliendo anche il denominatore:
+// precisione al mHz, ma p3 cambia con la frequenza (più byte per scrittura)
+void refineMultisynth(uint64_t freqMilliHz, uint32_t ref, SynthPlan& plan);
+
+// Sceglie il divisore pari che porta freq al centro del VCO
+bool planGlideWindow(uint32_t freq, GlideWindow& window);
+bool glideWindowContains(const GlideWindow& window, uint32_t freq);
+void glideWindowFor(uint32_t msDiv, GlideWindow& window);  // Finestra di un divisore dato
+
+// Pianifica un'uscita con Multisynth intero fisso: PLL = freq * msDiv
+bool planGlide(uint32_t freq, uint32_t msDiv, uint32_t ref, SynthPlan& plan);
+
+// Codifica p1/p2/p3 nei due blocchi da 8 registri
+void encodeSynthImage(const SynthPlan& plan, SynthImage& image);
+
+// Frequenza di uscita effettiva del piano, in millesimi di Hz
+uint64_t planOutputMilliHz(const SynthPlan& plan, uint32_t ref);
+
+#endif
@@ -0,0 +1,100 @@
+#include "PLL_shadow.h"
+#include <string.h>
+
+void Si5351Shadow::begin(Si5351BusWrite busWrite) {
+    write = busWrite;
+    invalidate();
+}
+
+void Si5351Shadow::invalidate() {
+    memset(valid, 0, sizeof(valid));
+    memset(dirty, 0, sizeof(dirty));
+}
+
+void Si5351Shadow::seed(uint8_t reg, uint8_t value) {
+    if (reg >= SHADOW_REG_COUNT) return;
+    regs[reg] = value;
+    set(valid, reg);
+    clear(dirty, reg);
+}
+
+bool Si5351Shadow::get(uint8_t reg, uint8_t& value) const {
+    if (reg >= SHADOW_REG_COUNT || !isSet(valid, reg)) return false;
+    value = regs[reg];
+    return true;
+}
+
+bool Si5351Shadow::stage(uint8_t reg, const uint8_t* data, uint8_t len) {
+    bool changed = false;
+
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t r = reg + i;
+        if (r >= SHADOW_REG_COUNT) break;
+
+        pending[r] = data[i];
+        if (!isSet(valid, r) || regs[r] != data[i]) {
+            set(dirty, r);
+            changed = true;
+        } else {
+            clear(dirty, r);
+        }
+    }
+    return changed;
+}
+
+uint8_t Si5351Shadow::flush() {
+    lastTransactions = 0;
+    lastBytes = 0;
+    if (write == nullptr) return 0;
+
+    uint8_t buffer[SHADOW_REG_COUNT];
+    uint16_t r = 0;
+
+    while (r < SHADOW_REG_COUNT) {
+        if (!isSet(dirty, r)) {
+            r++;
+            continue;
+        }
+
+        // Estende il burst finché i buchi tra byte cambiati sono piccoli
+        // e contengono registri di valore noto
+        uint16_t start = r;
+        uint16_t end = r;
+        uint16_t next = r + 1;
+        while (next < SHADOW_REG_COUNT) {
+            if (isSet(dirty, next)) {
+                end = next++;
+                continue;
+            }
+            if (next - end > SHADOW_MERGE_GAP || !isSet(valid, next)) break;
+            next++;
+        }
+
+        uint8_t len = end - start + 1;
+        for (uint16_t i = start; i <= end; i++) {
+            buffer[i - start] = isSet(dirty, i) ? pending[i] : regs[i];
+        }
+
+        if (write(start, buffer, len) == 0) {
+            for (uint16_t i = start; i <= end; i++) {
+                regs[i] = buffer[i - start];
+                set(valid, i);
+                clear(dirty, i);
+            }
+        } else {
+            // Errore di bus: lo stato del chip non è più noto
+            for (uint16_t i = start; i <= end; i++) {
+                clear(valid, i);
+                clear(dirty, i);
+            }
+        }
+
+        lastTransactions++;
+        lastBytes += len + 1;
+        r = end + 1;
+    }
+
+    transactions += lastTransactions;
+    bytesSent += lastBytes;
+    return lastTransactions;
+}
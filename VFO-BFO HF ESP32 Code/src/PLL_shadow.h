@@ -0,0 +1,45 @@
+#ifndef PLL_SHADOW_H
+#define PLL_SHADOW_H
+
+#include <stdint.h>
+
+// Copia locale dei registri del Si5351: si scrivono sul bus solo i byte cambiati,
+// raggruppati in burst con auto-incremento dell'indirizzo.
+// Il trasporto è una funzione esterna, così il modulo compila anche su host.
+
+#define SHADOW_REG_COUNT  192   // Registri 0..191 (PLL reset = 177)
+#define SHADOW_MERGE_GAP  2     // Byte invariati accettati dentro un burst
+
+typedef uint8_t (*Si5351BusWrite)(uint8_t reg, const uint8_t* data, uint8_t len);
+
+class Si5351Shadow {
+public:
+    void begin(Si5351BusWrite busWrite);
+    void invalidate();                      // Forza la riscrittura completa
+    void seed(uint8_t reg, uint8_t value);  // Valore noto letto dal chip
+    bool get(uint8_t reg, uint8_t& value) const;  // Ultimo valore scritto, se noto
+
+    // Prepara un blocco; ritorna true se differisce da quanto già scritto
+    bool stage(uint8_t reg, const uint8_t* data, uint8_t len);
+    // Scrive i byte preparati; ritorna il numero di transazioni
+    uint8_t flush();
+
+    // Statistiche bus
+    uint32_t transactions = 0;      // Transazioni totali
+    uint32_t bytesSent = 0;         // Byte totali (indirizzo registro compreso)
+    uint8_t lastTransactions = 0;   // Ultimo flush
+    uint16_t lastBytes = 0;         // Ultimo flush
+
+private:
+    bool isSet(const uint8_t* bits, uint8_t reg) const { return bits[reg >> 3] & (1 << (reg & 7)); }
+    void set(uint8_t* bits, uint8_t reg) { bits[reg >> 3] |= (1 << (reg & 7)); }
+    void clear(uint8_t* bits, uint8_t reg) { bits[reg >> 3] &= ~(1 << (reg & 7)); }
+
+    Si5351BusWrite write = nullptr;
+    uint8_t regs[SHADOW_REG_COUNT];                 // Ultimo valore scritto
+    uint8_t pending[SHADOW_REG_COUNT];              // Valore da scrivere
+    uint8_t valid[SHADOW_REG_COUNT / 8] = {0};      // regs[] allineato al chip
+    uint8_t dirty[SHADOW_REG_COUNT / 8] = {0};      // pending[] da scrivere
+};
+
+#endif
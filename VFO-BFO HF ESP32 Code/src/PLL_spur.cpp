@@ -0,0 +1,44 @@
+#include "PLL_spur.h"
+
+const BandPlan* findBandPlan(uint32_t vfoFreq) {
+  for (const BandPlan& plan : bandPlans) {
+    if (vfoFreq >= plan.low && vfoFreq <= plan.high) return &plan;
+  }
+  return nullptr;
+}
+
+bool planSpurAwareWindow(uint32_t freq, uint32_t ref, const GlideWindow& current, GlideWindow& next) {
+  const BandPlan* plan = findBandPlan(freq);
+
+  // Fuori banda: finestra centrata sul VCO, come la sintonia glide normale
+  if (plan == nullptr) {
+    if (glideWindowContains(current, freq)) {
+      next = current;
+      return false;
+    }
+    planGlideWindow(freq, next);
+    return true;
+  }
+
+  // Prima il divisore corrente (isteresi), poi il primario, poi l'alternativo
+  uint32_t candidates[3] = {
+    glideWindowContains(current, freq) ? current.msDiv : 0,
+    plan->msPrimary,
+    plan->msAlternate
+  };
+
+  uint32_t chosen = 0;
+  for (uint32_t msDiv : candidates) {
+    if (msDiv == 0) continue;
+    if (!spurProne(freq, msDiv, ref)) {
+      chosen = msDiv;
+      break;
+    }
+  }
+
+  // Tutti in zona spuria: si resta dove si è
+  if (chosen == 0) chosen = candidates[0] ? candidates[0] : plan->msPrimary;
+
+  glideWindowFor(chosen, next);
+  return next.msDiv != current.msDiv;
+}
@@ -0,0 +1,151 @@
+#ifndef PLL_SPUR_H
+#define PLL_SPUR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include "config.h"
+#include "bands.h"
+#include "PLL_plan.h"
+
+// Piano PLL per banda attento alle spurie frazionarie.
+// Con Multisynth intero N il PLL vale f*N: quando la parte frazionaria di f*N/ref
+// cade vicino a un rapporto semplice p/q (q <= SPUR_MAX_DENOM) nascono spurie
+// a una distanza di circa ref*|frazione - p/q|/N dall'uscita. Le frequenze
+// d'uscita a rischio sono quindi (k + p/q) * ref / N, ciascuna con una zona
+// di +/- SPUR_GUARD_HZ (fischi udibili in banda audio).
+// I piani sono calcolati in compilazione dalle bande + IF_FREQUENCY: a run time
+// si fa solo una ricerca nella tabella e un controllo della zona corrente.
+
+struct BandPlan {
+  uint32_t low, high;       // Uscita VFO della banda (banda + IF)
+  uint16_t msPrimary;       // Divisore pari con meno zone spurie in banda
+  uint16_t msAlternate;     // Secondo divisore, usato dentro le zone del primo
+};
+
+constexpr uint32_t spurGcd(uint32_t a, uint32_t b) {
+  while (b != 0) {
+    uint32_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Peso delle zone spurie dentro [low, high] usando il divisore msDiv
+constexpr uint64_t spurCost(uint32_t low, uint32_t high, uint32_t msDiv) {
+  const uint64_t ref = PLL_XTAL_FREQ;
+  const uint64_t guard = (uint64_t)SPUR_GUARD_HZ * msDiv;     // Zona riportata al VCO
+  const uint64_t vcoLow = (uint64_t)low * msDiv;
+  const uint64_t vcoHigh = (uint64_t)high * msDiv;
+  uint64_t cost = 0;
+
+  for (uint32_t q = 1; q <= SPUR_MAX_DENOM; q++) {
+    // Punti m*ref/q con frazione ridotta di denominatore esattamente q
+    uint64_t first = (vcoLow - guard) * q / ref;
+    uint64_t last = (vcoHigh + guard) * q / ref + 1;
+    for (uint64_t m = first; m <= last; m++) {
+      if (q > 1 && spurGcd((uint32_t)(m % q), q) != 1) continue;
+
+      uint64_t point = m * ref / q;
+      uint64_t from = point > guard ? point - guard : 0;
+      uint64_t to = point + guard;
+      if (from < vcoLow) from = vcoLow;
+      if (to > vcoHigh) to = vcoHigh;
+      if (to <= from) continue;
+
+      // Le spurie con q piccolo sono le più forti
+      cost += (to - from) / msDiv * (SPUR_MAX_DENOM + 1 - q);
+    }
+  }
+  return cost;
+}
+
+// true se l'uscita cade in una zona spuria con il divisore msDiv
+constexpr bool spurProne(uint32_t freq, uint32_t msDiv, uint32_t ref) {
+  // Resto del VCO rispetto al riferimento, confrontato con i punti p*ref/q
+  uint64_t rem = ((uint64_t)freq * msDiv) % ref;
+  uint64_t guard = (uint64_t)SPUR_GUARD_HZ * msDiv;
+
+  for (uint32_t q = 1; q <= SPUR_MAX_DENOM; q++) {
+    uint64_t m = (rem * q) % ref;
+    uint64_t distance = m < ref - m ? m : ref - m;
+    if (distance < guard * q) return true;
+  }
+  return false;
+}
+
+// Campioni della banda in zona spuria con entrambi i divisori
+constexpr uint32_t spurOverlap(uint32_t low, uint32_t high, uint32_t msA, uint32_t msB) {
+  uint32_t count = 0;
+  for (uint32_t f = low; f <= high; f += SPUR_GUARD_HZ / 2) {
+    if (spurProne(f, msA, PLL_XTAL_FREQ) && spurProne(f, msB, PLL_XTAL_FREQ)) count++;
+  }
+  return count;
+}
+
+constexpr uint32_t spurDistance(uint64_t a, uint64_t b) {
+  return (uint32_t)(a > b ? a - b : b - a);
+}
+
+// Sceglie il divisore con meno spurie in banda e quello che meglio copre le sue zone
+constexpr BandPlan makeBandPlan(uint32_t low, uint32_t high) {
+  BandPlan plan = {low, high, 0, 0};
+
+  uint32_t msMin = (uint32_t)((PLL_VCO_MIN + low - 1) / low);
+  uint32_t msMax = (uint32_t)(PLL_VCO_MAX / high);
+  if (msMin & 1) msMin++;
+  if (msMin < PLL_MS_MIN) msMin = PLL_MS_MIN;
+  if (msMax > PLL_MS_MAX) msMax = PLL_MS_MAX;
+
+  const uint64_t center = (uint64_t)PLL_VCO_CENTER;
+  const uint32_t mid = low / 2 + high / 2;
+
+  // Primario: meno spurie; a parità, VCO più vicino al centro
+  uint64_t bestCost = UINT64_MAX;
+  for (uint32_t ms = msMin; ms <= msMax; ms += 2) {
+    uint64_t cost = spurCost(low, high, ms);
+    if (cost < bestCost ||
+        (cost == bestCost && spurDistance((uint64_t)mid * ms, center) <
+                             spurDistance((uint64_t)mid * plan.msPrimary, center))) {
+      plan.msPrimary = ms;
+      bestCost = cost;
+    }
+  }
+
+  // Alternativo: pulito dove il primario non lo è; a parità, meno spurie proprie
+  uint32_t bestOverlap = UINT32_MAX;
+  uint64_t alternateCost = UINT64_MAX;
+  for (uint32_t ms = msMin; ms <= msMax; ms += 2) {
+    if (ms == plan.msPrimary) continue;
+    uint32_t overlap = spurOverlap(low, high, plan.msPrimary, ms);
+    uint64_t cost = spurCost(low, high, ms);
+    if (overlap < bestOverlap || (overlap == bestOverlap && cost < alternateCost)) {
+      plan.msAlternate = ms;
+      bestOverlap = overlap;
+      alternateCost = cost;
+    }
+  }
+  return plan;
+}
+
+template <size_t N>
+constexpr std::array<BandPlan, N> makeBandPlans(const Band (&table)[N], uint32_t ifFreq) {
+  std::array<BandPlan, N> plans = {};
+  for (size_t i = 0; i < N; i++) {
+    plans[i] = makeBandPlan(table[i].startFreq + ifFreq, table[i].endFreq + ifFreq);
+  }
+  return plans;
+}
+
+// Piani per tutte le bande, calcolati dal compilatore
+inline constexpr auto bandPlans = makeBandPlans(bands, IF_FREQUENCY);
+
+// Piano della banda che contiene l'uscita VFO, nullptr fuori banda
+const BandPlan* findBandPlan(uint32_t vfoFreq);
+
+// Finestra glide per freq: dentro una banda usa il piano precalcolato, lasciando
+// il divisore corrente finché è pulito. Ritorna true se il divisore cambia.
+bool planSpurAwareWindow(uint32_t freq, uint32_t ref, const GlideWindow& current, GlideWindow& next);
+
+#endif
@@ -7,146 +7,169 @@
 #include "PLL.h"
 #include "DigiOUT.h"
 #include "EEPROM_manager.h"
+#include "pcnt_encoder.h"
+#include "quadrature.h"
+#include "tuning_accel.h"
+#include "radio_state.h"
 #include <Arduino.h>
 
-// Variabili globali esterne
-extern unsigned long lastEncoderRead;
-extern int lastEncoded;
-extern int encoderCount;
-extern bool buttonPressed;
-extern unsigned long lastButtonPress;
-
-// Variabili encoder pitch BFO
-static int lastPitchEncoded = 0;
-static int pitchEncoderCount = 0;
+// Decodificatori encoder: tabella comune, scatti e filtro per encoder.
+// Con il PCNT la quadratura è in hardware e qui si contano solo gli scatti.
+static QuadratureDecoder vfoDecoder;
+static QuadratureDecoder bfoDecoder;
+
+// Encoder sul contatore di impulsi
+#if VFO_ENC_PCNT
+static PcntEncoder vfoEncoder;
+#endif
+#if BFO_ENC_PCNT
+static PcntEncoder bfoEncoder;
+#endif
+
+// Encoder letti a interrupt: ultimo stato dei pin e scatti arrivati dalla coda eventi
+#if !VFO_ENC_PCNT
+static uint8_t vfoPinState = 0b11;
+static int32_t vfoPendingDetents = 0;
+#endif
+#if !BFO_ENC_PCNT
+static uint8_t bfoPinState = 0b11;
+static int32_t bfoPendingDetents = 0;
+#endif
+
+// Accelerazione della sintonia VFO
+static const AccelPoint vfoAccelCurve[] = ENC_ACCEL_CURVE;
+static TuningAccel vfoAccel;
+
+uint32_t vfoDetents = 0;        // Scatti letti dall'avvio (scritto solo dal loop)
+
+// Stato dei pin di un encoder: (CLK << 1) | DT
+static uint8_t readEncoderPins(uint8_t clkPin, uint8_t dtPin) {
+  return (digitalRead(clkPin) << 1) | digitalRead(dtPin);
+}
 
 // ==================== INIZIALIZZAZIONE ENCODER ====================
 
 void setupEncoders() {
   // Inizializzazione encoder VFO
-  lastEncoded = (digitalRead(VFO_ENC_DT) << 1) | digitalRead(VFO_ENC_CLK);
+  vfoDecoder.begin(readEncoderPins(VFO_ENC_CLK, VFO_ENC_DT), ENC_COUNTS_PER_STEP, VFO_ENC_STABLE_US);
+#if !VFO_ENC_PCNT
+  vfoPinState = readEncoderPins(VFO_ENC_CLK, VFO_ENC_DT);
+#endif
+  vfoAccel.begin(vfoAccelCurve, sizeof(vfoAccelCurve) / sizeof(vfoAccelCurve[0]), ENC_ACCEL_IDLE_US);
+#if VFO_ENC_PCNT
+  if (!vfoEncoder.begin(PCNT_UNIT_0, VFO_ENC_CLK, VFO_ENC_DT, ENC_FILTER_CYCLES)) {
+    Serial.println("Errore configurazione PCNT encoder VFO");
+  }
+#endif
   
   // Inizializzazione encoder BFO
-  lastPitchEncoded = (digitalRead(BFO_ENC_DT) << 1) | digitalRead(BFO_ENC_CLK);
+  bfoDecoder.begin(readEncoderPins(BFO_ENC_CLK, BFO_ENC_DT), ENC_COUNTS_PER_STEP, BFO_ENC_STABLE_US);
+#if !BFO_ENC_PCNT
+  bfoPinState = readEncoderPins(BFO_ENC_CLK, BFO_ENC_DT);
+#endif
+#if BFO_ENC_PCNT
+  if (!bfoEncoder.begin(PCNT_UNIT_1, BFO_ENC_CLK, BFO_ENC_DT, ENC_FILTER_CYCLES)) {
+    Serial.println("Errore configurazione PCNT encoder BFO");
+  }
+#endif
 }
 
 // ==================== ENCODER VFO ====================
 
-void readVFOEncoder() {
-  static unsigned long lastUpdate = 0;
-  const unsigned long UPDATE_INTERVAL = 50000; // 50ms tra gli aggiornamenti
-  
-  int MSB = digitalRead(VFO_ENC_CLK);
-  int LSB = digitalRead(VFO_ENC_DT);
-
-  int encoded = (MSB << 1) | LSB;
-  int sum = (lastEncoded << 2) | encoded;
-
-  if (sum == 0b1101 || sum == 0b0100 || sum == 0b0010 || sum == 0b1011) {
-    encoderCount++;
-    if (encoderCount >= 2) {
-      if (micros() - lastUpdate > UPDATE_INTERVAL) {
-        displayedFrequency += step;
-        if (displayedFrequency > maxFreq) displayedFrequency = maxFreq;
-        vfoFrequency = displayedFrequency + IF_FREQUENCY;
-        updateFrequency();
-        updateFrequencyDisplay(); 
-        updateBandInfo();
-        updateModeOutputs(); 
-        encoderCount = 0;
-        lastUpdate = micros();
-
-        eepromManager.requestSave(); // Salvataggio ritardato per VFO
-      }
-    }
-  }
-  else if (sum == 0b1110 || sum == 0b0111 || sum == 0b0001 || sum == 0b1000) {
-    encoderCount++;
-    if (encoderCount >= 2) {
-      if (micros() - lastUpdate > UPDATE_INTERVAL) {
-        displayedFrequency -= step;
-        if (displayedFrequency < minFreq) displayedFrequency = minFreq;
-        vfoFrequency = displayedFrequency + IF_FREQUENCY;
-        updateFrequency();
-        updateFrequencyDisplay(); 
-        updateBandInfo();
-        updateModeOutputs();
-        encoderCount = 0;
-        lastUpdate = micros();
-
-        eepromManager.requestSave(); // Salvataggio ritardato per VFO
-      }
-    }
-  }
+// Sintonia VFO di steps passi (+ avanti, - indietro), entro minFreq..maxFreq
+static void tuneVFO(int32_t steps) {
+  int64_t target = (int64_t)displayedFrequency + (int64_t)steps * step;
+  if (target > (int64_t)maxFreq) target = maxFreq;
+  if (target < (int64_t)minFreq) target = minFreq;
+  if ((unsigned long)target == displayedFrequency) return;
+
+  radioState.setFrequency(target);
+  radioState.requestSave(false); // Salvataggio ritardato per VFO
+}
 
-  lastEncoded = encoded;
-  delayMicroseconds(100);
+void readVFOEncoder() {
+#if VFO_ENC_PCNT
+  // Conteggi dal PCNT: nessuna lettura dei pin e nessuna attesa
+  int32_t detents = vfoDecoder.accumulate(vfoEncoder.readDelta());
+#else
+  // Scatti dagli eventi; l'ultimo stato ripassato al filtro conclude un cambio
+  // rimasto fermo dopo l'ultimo fronte
+  int32_t detents = vfoPendingDetents + vfoDecoder.update(vfoPinState, micros());
+  vfoPendingDetents = 0;
+#endif
+
+  if (detents == 0) return;
+  vfoDetents += detents > 0 ? detents : -detents;
+
+  // Tutti gli scatti del giro in una sola risintonia, con il passo per scatto
+  // dato dalla velocità (multiplo di step, al più ENC_ACCEL_MAX_STEP)
+  tuneVFO(vfoAccel.apply(detents, micros(), step));
 }
 
-void changeStep() {
-  switch(step) {
-    case 10: step = 100; break;
-    case 100: step = 1000; break;
-    case 1000: step = 10000; break;
-    case 10000: step = 10; break;
-    default: step = 1000;
+// Step successivo, o precedente con reverse (pressione lunga)
+void changeStep(bool reverse) {
+  unsigned long next;
+  if (reverse) {
+    switch(step) {
+      case 10: next = 10000; break;
+      case 100: next = 10; break;
+      case 1000: next = 100; break;
+      case 10000: next = 1000; break;
+      default: next = 1000;
+    }
+  } else {
+    switch(step) {
+      case 10: next = 100; break;
+      case 100: next = 1000; break;
+      case 1000: next = 10000; break;
+      case 10000: next = 10; break;
+      default: next = 1000;
+    }
   }
+  radioState.setStep(next);
+  radioState.requestSave(true);
 }
 
 // ==================== ENCODER BFO ====================
 
 
-// Legge encoder pitch BFO e ritorna -1 (indietro), +1 (avanti) o 0 (nessun movimento)
+// Legge encoder pitch BFO e ritorna gli scatti: + avanti, - indietro, 0 nessun movimento
 int readBFOEncoder() {
-  static unsigned long lastStableTime = 0;
-  const unsigned long STABLE_TIME = 3; // 3ms di stabilità
-  
-  int MSB = digitalRead(BFO_ENC_CLK);
-  int LSB = digitalRead(BFO_ENC_DT);
-  
-  int encoded = (MSB << 1) | LSB;
-
-  // Aspetta che il segnale sia stabile per 3ms
-  static int lastEncoded = 0;
-  static unsigned long changeTime = 0;
-  
-  if (encoded != lastEncoded) {
-    changeTime = millis();
-    lastEncoded = encoded;
-    return 0;
-  }
-  
-  if (millis() - changeTime < STABLE_TIME) {
-    return 0;
-  }
-
-  int sum = (lastPitchEncoded << 2) | encoded;
-  int direction = 0;
+#if BFO_ENC_PCNT
+  return bfoDecoder.accumulate(bfoEncoder.readDelta());
+#else
+  int detents = bfoPendingDetents + bfoDecoder.update(bfoPinState, micros());
+  bfoPendingDetents = 0;
+  return detents;
+#endif
+}
 
-  if (sum == 0b1101 || sum == 0b0100 || sum == 0b0010 || sum == 0b1011) {
-    pitchEncoderCount++;
-    if (pitchEncoderCount >= 2) {
-      direction = 1;
-      pitchEncoderCount = 0;
-    }
-  }
-  else if (sum == 0b1110 || sum == 0b0111 || sum == 0b0001 || sum == 0b1000) {
-    pitchEncoderCount++;
-    if (pitchEncoderCount >= 2) {
-      direction = -1;
-      pitchEncoderCount = 0;
-    }
-  }
+// Fronti dalla coda eventi, decodificati con il tempo dell'interrupt
+void vfoEncoderEdge(uint8_t state, uint32_t us) {
+#if VFO_ENC_PCNT
+  (void)state;    // Con il PCNT i fronti non passano dalla coda
+  (void)us;
+#else
+  vfoPinState = state;
+  vfoPendingDetents += vfoDecoder.update(state, us);
+#endif
+}
 
-  lastPitchEncoded = encoded;
-  return direction;
+void bfoEncoderEdge(uint8_t state, uint32_t us) {
+#if BFO_ENC_PCNT
+  (void)state;    // Con il PCNT i fronti non passano dalla coda
+  (void)us;
+#else
+  bfoPinState = state;
+  bfoPendingDetents += bfoDecoder.update(state, us);
+#endif
 }
 
 // Aggiorna BFO in base al movimento dell'encoder pitch
 void updateBFOFromEncoder() {
-  if (!bfoEnabled) return;
-  
+  // Letto anche a BFO spento: gli scatti in coda si scartano invece di accumularsi
   int direction = readBFOEncoder();
+  if (!bfoEnabled) return;
   
   if (direction != 0) {
     int newOffset = currentBFOOffset + (direction * BFO_PITCH_STEP);
@@ -159,13 +182,14 @@ void updateBFOFromEncoder() {
       currentBFOOffset = newOffset;
       
       // Calcola frequenza BFO con offset
+      unsigned long freq = bfoFrequency;
       switch(currentMode) {
-        case MODE_LSB: bfoFrequency = BFO_LSB_BASE + currentBFOOffset; break;
-        case MODE_USB: bfoFrequency = BFO_USB_BASE + currentBFOOffset; break;
-        case MODE_CW: bfoFrequency = BFO_CW_BASE + currentBFOOffset; break;
+        case MODE_LSB: freq = BFO_LSB_BASE + currentBFOOffset; break;
+        case MODE_USB: freq = BFO_USB_BASE + currentBFOOffset; break;
+        case MODE_CW: freq = BFO_CW_BASE + currentBFOOffset; break;
       }
       
-      updateBFO();
+      radioState.setBFO(true, freq);
     }
   }
 }
\ No newline at end of file
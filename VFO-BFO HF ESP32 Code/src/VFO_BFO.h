@@ -1,13 +1,20 @@
 #ifndef VFO_BFO_H
 #define VFO_BFO_H
 
+#include <stdint.h>
+
 // Funzioni encoder VFO
 void setupEncoders();
 void readVFOEncoder();
-void changeStep();
+void changeStep(bool reverse = false);
+extern uint32_t vfoDetents;     // Scatti dell'encoder VFO dall'avvio (comando ALLOC)
 
 // Funzioni encoder BFO
 int readBFOEncoder();
 void updateBFOFromEncoder();
 
+// Fronti degli encoder letti a interrupt (eventi INPUT_ENC_VFO / INPUT_ENC_BFO)
+void vfoEncoderEdge(uint8_t state, uint32_t us);
+void bfoEncoderEdge(uint8_t state, uint32_t us);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "alloc_counter.h"
+#include "VFO_BFO.h"
+#include <Arduino.h>
+#include <atomic>
+
+static std::atomic<uint32_t> allocs[2];
+static uint32_t exempt[2];                  // Scritti solo dal task esente
+static uint32_t openStart[2];               // AllocExempt aperto: conteggio all'inizio
+static bool open[2];
+
+static uint32_t resetAllocs[2];
+static uint32_t resetExempt[2];
+static uint32_t resetDetents = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  allocs[xPortGetCoreID()].fetch_add(1, std::memory_order_relaxed);
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  allocs[xPortGetCoreID()].fetch_add(1, std::memory_order_relaxed);
+  return __real_calloc(count, size);
+}
+
+// Anche realloc: le String crescono così
+void* __wrap_realloc(void* ptr, size_t size) {
+  if (size > 0) allocs[xPortGetCoreID()].fetch_add(1, std::memory_order_relaxed);
+  return __real_realloc(ptr, size);
+}
+}
+
+AllocExempt::AllocExempt() : core(xPortGetCoreID()) {
+  start = allocs[core].load(std::memory_order_relaxed);
+  openStart[core] = start;
+  open[core] = true;
+}
+
+AllocExempt::~AllocExempt() {
+  exempt[core] += allocs[core].load(std::memory_order_relaxed) - start;
+  open[core] = false;
+}
+
+// Allocazioni nei blocchi esenti, anche quello in corso
+static uint32_t exemptCount(uint8_t core) {
+  uint32_t skip = exempt[core];
+  if (open[core]) skip += allocs[core].load(std::memory_order_relaxed) - openStart[core];
+  return skip;
+}
+
+uint32_t allocCount(uint8_t core) {
+  return allocs[core].load(std::memory_order_relaxed) - exemptCount(core);
+}
+
+void resetAllocStats() {
+  for (uint8_t c = 0; c < 2; c++) {
+    resetAllocs[c] = allocCount(c);
+    resetExempt[c] = exemptCount(c);
+  }
+  resetDetents = vfoDetents;
+}
+
+void printAllocStats() {
+  uint32_t detents = vfoDetents - resetDetents;
+  Serial.println("=== Allocazioni heap ===");
+  Serial.print("Scatti encoder VFO: ");
+  Serial.println(detents);
+  for (uint8_t c = 2; c-- > 0;) {
+    uint32_t count = allocCount(c) - resetAllocs[c];
+    Serial.print(c == 1 ? "Core 1 (loop, radio): " : "Core 0 (UI): ");
+    Serial.print(count);
+    Serial.print(", per scatto: ");
+    Serial.println(detents ? (float)count / detents : 0.0f, 2);
+  }
+  Serial.print("Comandi seriali (esclusi): ");
+  Serial.println(exemptCount(1) - resetExempt[1]);
+}
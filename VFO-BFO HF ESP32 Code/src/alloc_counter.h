@@ -0,0 +1,29 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stdint.h>
+
+// Contatore delle allocazioni di heap: malloc, calloc e realloc passano dai
+// wrapper di alloc_counter.cpp (-Wl,--wrap in platformio.ini), new compreso.
+// Conteggi per core: sul core 1 girano loop e task radio, sul core 0 il task
+// UI. Il comando ALLOC li divide per gli scatti dell'encoder VFO: dopo l'avvio
+// la sintonia e il display non devono allocare niente.
+// I comandi seriali leggono la riga in una String: le loro allocazioni si
+// contano a parte con AllocExempt.
+
+uint32_t allocCount(uint8_t core);
+void resetAllocStats();
+void printAllocStats();
+
+// Allocazioni fuori dal percorso di sintonia, dalla costruzione alla fine
+// del blocco (stesso task)
+class AllocExempt {
+public:
+  AllocExempt();
+  ~AllocExempt();
+private:
+  uint8_t core;
+  uint32_t start;
+};
+
+#endif
@@ -1,18 +1,33 @@
-#ifndef BANDS_H
-#define BANDS_H
-
-struct Band {
-  const char* name;
-  unsigned long startFreq;
-  unsigned long endFreq;
-};
-
-extern Band bands[];
-extern int currentBandIndex;
-extern int totalBands;
-
-int getBandIndex(unsigned long freq);
-void changeBand();
-void updateBandInfo();
-
+#ifndef BANDS_H
+#define BANDS_H
+
+struct Band {
+  const char* name;
+  unsigned long startFreq;
+  unsigned long endFreq;
+};
+
+// Definizione delle bande (constexpr: usata anche dal piano PLL in compilazione)
+inline constexpr Band bands[] = {
+  {"160m", 1830000, 1850000},
+  {"80m", 3500000, 3800000},
+  {"60m", 5351000, 5366000},
+  {"40m", 7000000, 7200000},
+  {"30m", 10100000, 10150000},
+  {"20m", 14000000, 14350000},
+  {"17m", 18068000, 18168000},
+  {"15m", 21000000, 21450000},
+  {"12m", 24890000, 24990000},
+  {"10m", 28000000, 29700000}
+};
+
+inline constexpr int totalBands = sizeof(bands) / sizeof(bands[0]);
+
+extern int currentBandIndex;
+
+int getBandIndex(unsigned long freq);
+void changeBand(bool reverse = false);
+void updateBandInfo(unsigned long freq);  // Dal task UI
+void updateBandOutputs();                 // Dal loop: banda corrente e DigiOUT
+
 #endif
\ No newline at end of file
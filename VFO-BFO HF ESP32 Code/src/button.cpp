@@ -0,0 +1,79 @@
+#include "button.h"
+
+void Button::begin(const ButtonTiming& t, bool pressed) {
+  timing = t;
+  state = IDLE;
+  raw = stable = pressed;
+  changeUs = 0;
+  markUs = 0;
+}
+
+// Debounce sul primo fronte: il cambio vale subito, poi per debounceUs i
+// rimbalzi si ignorano. Un livello diverso rimasto alla fine della finestra
+// (rilascio rapido) lo accetta poll().
+ButtonAction Button::edge(bool pressed, uint32_t us) {
+  raw = pressed;
+  if (pressed == stable) return BUTTON_NONE;
+  if (us - changeUs < timing.debounceUs) return BUTTON_NONE;
+  return accept(pressed, us);
+}
+
+ButtonAction Button::accept(bool pressed, uint32_t us) {
+  stable = pressed;
+  changeUs = us;
+
+  if (pressed) {
+    if (state == WAIT_SECOND) {
+      state = SECOND_DOWN;
+      return BUTTON_DOUBLE;
+    }
+    state = DOWN;
+    markUs = us;
+    // Niente da distinguere: click subito alla pressione
+    if (timing.longUs == 0 && timing.doubleUs == 0) return BUTTON_CLICK;
+    return BUTTON_NONE;
+  }
+
+  State was = state;
+  state = IDLE;
+  if (was != DOWN || (timing.longUs == 0 && timing.doubleUs == 0)) return BUTTON_NONE;
+  if (timing.doubleUs != 0) {
+    state = WAIT_SECOND;
+    markUs = us;
+    return BUTTON_NONE;
+  }
+  return BUTTON_CLICK;
+}
+
+ButtonAction Button::poll(uint32_t nowUs) {
+  if (raw != stable && nowUs - changeUs >= timing.debounceUs) {
+    ButtonAction action = accept(raw, nowUs);
+    if (action != BUTTON_NONE) return action;
+  }
+
+  switch (state) {
+    case DOWN:
+      if (timing.longUs != 0 && nowUs - markUs >= timing.longUs) {
+        state = HELD;
+        markUs += timing.longUs;
+        return BUTTON_LONG;
+      }
+      break;
+    case HELD:
+      if (timing.repeatUs != 0 && nowUs - markUs >= timing.repeatUs) {
+        // Loop in ritardo di più periodi: una ripetizione sola, non una raffica
+        markUs = nowUs - markUs >= 2 * timing.repeatUs ? nowUs : markUs + timing.repeatUs;
+        return BUTTON_REPEAT;
+      }
+      break;
+    case WAIT_SECOND:
+      if (nowUs - markUs >= timing.doubleUs) {
+        state = IDLE;
+        return BUTTON_CLICK;
+      }
+      break;
+    default:
+      break;
+  }
+  return BUTTON_NONE;
+}
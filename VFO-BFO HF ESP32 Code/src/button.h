@@ -0,0 +1,51 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <stdint.h>
+
+// Pulsante senza attese: debounce, pressione lunga, ripetizione e doppio click
+// calcolati dai tempi degli eventi, mai con delay(). edge() riceve i fronti dalla
+// coda degli interrupt, poll() a ogni giro del loop fa scattare le azioni a tempo.
+// Senza dipendenze Arduino: compila anche su host.
+//
+// Il click arriva alla pressione se il pulsante non ha né pressione lunga né
+// doppio click; altrimenti al rilascio, o a fine finestra del doppio click.
+
+enum ButtonAction : uint8_t {
+  BUTTON_NONE,
+  BUTTON_CLICK,
+  BUTTON_DOUBLE,            // Seconda pressione entro doubleUs dal rilascio
+  BUTTON_LONG,              // Tenuto premuto per longUs
+  BUTTON_REPEAT             // Ancora premuto: ogni repeatUs dopo BUTTON_LONG
+};
+
+struct ButtonTiming {
+  uint32_t debounceUs;      // Fronti ignorati dopo un cambio accettato
+  uint32_t longUs;          // 0 = nessuna pressione lunga
+  uint32_t repeatUs;        // 0 = nessuna ripetizione
+  uint32_t doubleUs;        // 0 = nessun doppio click
+};
+
+class Button {
+public:
+  void begin(const ButtonTiming& timing, bool pressed = false);
+
+  ButtonAction edge(bool pressed, uint32_t us);   // Fronte dal pin (pressed = livello basso)
+  ButtonAction poll(uint32_t nowUs);              // Azioni a tempo
+
+  bool pressed() const { return stable; }
+
+private:
+  enum State : uint8_t { IDLE, DOWN, HELD, WAIT_SECOND, SECOND_DOWN };
+
+  ButtonAction accept(bool pressed, uint32_t us);
+
+  ButtonTiming timing = {0, 0, 0, 0};
+  State state = IDLE;
+  bool raw = false;         // Ultimo livello visto, anche se ignorato
+  bool stable = false;      // Livello accettato
+  uint32_t changeUs = 0;    // Ultimo cambio accettato
+  uint32_t markUs = 0;      // Pressione, rilascio o ultima ripetizione
+};
+
+#endif
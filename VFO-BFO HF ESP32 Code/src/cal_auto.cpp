@@ -0,0 +1,102 @@
+#include "cal_auto.h"
+#include "config.h"
+#include "cal_search.h"
+#include "radio_task.h"
+#include "PLL.h"
+#include "EEPROM_manager.h"
+
+extern int32_t currentCalibration;  // main.cpp
+
+static CalSearch search;
+static bool running = false;
+static uint32_t referenceFreq = 0;
+static unsigned long startFrequency = 0;    // Frequenza visualizzata alla partenza
+static int32_t searchCalibration = 0;       // Fattore con cui il VFO fa la ricerca
+static unsigned long retuneTime = 0;
+
+// Il VFO segue la ricerca, il display resta sulla frequenza di partenza
+static void tuneSearch(uint32_t freq) {
+  radioPostVFO(freq + IF_FREQUENCY);
+  retuneTime = millis();
+}
+
+bool startAutoCalibration(uint32_t freq) {
+  if (running) return false;
+  if (!search.begin(freq, CAL_AUTO_SPAN, CAL_AUTO_COARSE_STEP, CAL_AUTO_FINE_STEP, CAL_AUTO_MIN_DELTA)) return false;
+
+  referenceFreq = freq;
+  startFrequency = displayedFrequency;
+  searchCalibration = si5351Calibration.load();
+  running = true;
+
+  uint32_t first;
+  search.next(first);
+  tuneSearch(first);
+  return true;
+}
+
+void stopAutoCalibration() {
+  if (!running) return;
+  running = false;
+  updateFrequency();
+  Serial.println("CAL_AUTO interrotta");
+}
+
+bool autoCalibrationRunning() {
+  return running;
+}
+
+void updateAutoCalibration() {
+  if (!running) return;
+
+  // Encoder o cambio banda: la nuova frequenza è già stata inviata al VFO
+  if (displayedFrequency != startFrequency) {
+    running = false;
+    Serial.println("CAL_AUTO interrotta: frequenza cambiata");
+    return;
+  }
+  if (millis() - retuneTime < CAL_AUTO_SETTLE_MS) return;
+
+  // S-meter mediato come in readSMeter()
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < CAL_AUTO_SAMPLES; i++) sum += analogRead(S_METER_PIN);
+  search.report(sum / CAL_AUTO_SAMPLES);
+
+  uint32_t freq;
+  if (search.next(freq)) {
+    tuneSearch(freq);
+    return;
+  }
+  running = false;
+
+  if (!search.found()) {
+    updateFrequency();
+    Serial.print("CAL_AUTO: portante non trovata attorno a ");
+    Serial.print(referenceFreq);
+    Serial.println(" Hz (segnale debole o fuori span)");
+    return;
+  }
+
+  // Centro trovato sul VFO nominale -> correzione che ce lo riporta, rispetto
+  // al fattore in uso durante la ricerca
+  uint64_t target = ((uint64_t)referenceFreq + IF_FREQUENCY) * 1000;
+  uint64_t measured = search.centerMilliHz() + (uint64_t)IF_FREQUENCY * 1000;
+  int32_t correction = calCorrection(searchCalibration, target, measured);
+
+  Serial.print("CAL_AUTO: centro a ");
+  Serial.print((long)(search.centerMilliHz() / 1000));
+  Serial.print(".");
+  Serial.print((long)(search.centerMilliHz() % 1000 / 100));
+  Serial.print(" Hz, larghezza ");
+  Serial.print((long)(search.widthMilliHz() / 1000));
+  Serial.print(" Hz, ");
+  Serial.print(search.measurements());
+  Serial.println(" misure");
+
+  // Il task radio riscrive il VFO sull'ultimo punto della ricerca: poi torna
+  // sulla frequenza visualizzata
+  calibrateSI5351(correction);
+  updateFrequency();
+  eepromManager.saveCalibration(correction);
+  currentCalibration = correction;
+}
@@ -0,0 +1,17 @@
+#ifndef CAL_AUTO_H
+#define CAL_AUTO_H
+
+#include <Arduino.h>
+
+// Calibrazione automatica su una portante di riferimento nota (comando
+// CAL_AUTO <Hz>, es. un segnale campione a 10MHz): il VFO (CLK0) scorre attorno
+// alla portante, l'S-meter misura la curva del filtro IF e dalla posizione del
+// centro si ricava la correzione, applicata e salvata come con CAL.
+// Si suppone il filtro IF centrato su IF_FREQUENCY.
+
+bool startAutoCalibration(uint32_t freq);
+void stopAutoCalibration();
+bool autoCalibrationRunning();
+void updateAutoCalibration();   // Dal loop: una misura ogni CAL_AUTO_SETTLE_MS
+
+#endif
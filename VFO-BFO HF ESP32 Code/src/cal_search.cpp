@@ -0,0 +1,145 @@
+#include "cal_search.h"
+
+bool CalSearch::begin(uint32_t center, uint32_t span, uint32_t coarse, uint32_t fine, uint16_t delta) {
+  phase = PHASE_DONE;
+  success = false;
+  total = 0;
+  if (coarse == 0 || fine == 0 || fine > coarse) return false;
+  if (span / coarse + 1 > CAL_SEARCH_MAX_POINTS) return false;
+  if (2 * coarse / fine + 1 > CAL_SEARCH_MAX_POINTS) return false;
+
+  uint32_t half = span / coarse / 2 * coarse;
+  if (half >= center) return false;
+
+  coarseStep = coarse;
+  fineStep = fine;
+  minDelta = delta;
+  first = center - half;
+  step = coarse;
+  count = 2 * half / coarse + 1;
+  index = 0;
+  phase = PHASE_COARSE;
+  return true;
+}
+
+bool CalSearch::next(uint32_t& freq) const {
+  if (phase == PHASE_DONE) return false;
+  freq = first + (uint32_t)index * step;
+  return true;
+}
+
+void CalSearch::fail() {
+  success = false;
+  phase = PHASE_DONE;
+}
+
+// Scansione fine di +-un passo grosso attorno al fronte stimato
+void CalSearch::startFine(uint64_t edgeMilliHz, Phase nextPhase) {
+  uint32_t edge = (uint32_t)((edgeMilliHz + 500) / 1000);
+  uint32_t half = coarseStep / fineStep * fineStep;
+  first = edge - half;
+  step = fineStep;
+  count = 2 * half / fineStep + 1;
+  index = 0;
+  phase = nextPhase;
+}
+
+// Punto a metà livello, interpolato tra i due campioni a cavallo della soglia:
+// rising = primo campione sopra la soglia (fronte basso), altrimenti l'ultimo
+bool CalSearch::crossing(bool rising, uint64_t& edgeMilliHz) const {
+  int below, above;
+  if (rising) {
+    above = 0;
+    while (above < count && levels[above] < threshold) above++;
+    below = above - 1;
+    if (above >= count || below < 0) return false;
+  } else {
+    above = count - 1;
+    while (above >= 0 && levels[above] < threshold) above--;
+    below = above + 1;
+    if (above < 0 || below >= count) return false;
+  }
+
+  // Dal campione sotto soglia verso quello sopra, in proporzione al livello
+  uint64_t belowFreq = (uint64_t)(first + (uint32_t)below * step) * 1000;
+  uint32_t rise = levels[above] - levels[below];
+  uint64_t part = (uint64_t)(threshold - levels[below]) * step * 1000 / rise;
+  edgeMilliHz = rising ? belowFreq + part : belowFreq - part;
+  return true;
+}
+
+// Scansione fine: retta ai minimi quadrati sui campioni del fianco (20-80%
+// dell'escursione) e soglia sulla retta, così il rumore dei singoli punti si
+// media. Con meno di 3 campioni sul fianco resta l'interpolazione a due punti.
+bool CalSearch::fitEdge(bool rising, uint64_t& edgeMilliHz) const {
+  uint16_t span = top - bottom;
+  uint16_t low = bottom + span / 5, high = top - span / 5;
+
+  // La soglia deve essere attraversata dentro la finestra fine
+  uint64_t guess;
+  if (!crossing(rising, guess)) return false;
+
+  double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (levels[i] < low || levels[i] > high) continue;
+    double x = (double)i;
+    n++;
+    sx += x;
+    sy += levels[i];
+    sxx += x * x;
+    sxy += x * levels[i];
+  }
+
+  double den = n * sxx - sx * sx;
+  if (n < 3 || den <= 0) {
+    edgeMilliHz = guess;
+    return true;
+  }
+  double slope = (n * sxy - sx * sy) / den;
+  if (rising ? slope <= 0 : slope >= 0) {
+    edgeMilliHz = guess;
+    return true;
+  }
+
+  double x = (threshold - (sy - slope * sx) / n) / slope;
+  if (x < 0 || x > count - 1) return false;
+  edgeMilliHz = (uint64_t)first * 1000 + (uint64_t)(x * step * 1000 + 0.5);
+  return true;
+}
+
+void CalSearch::report(uint16_t level) {
+  if (phase == PHASE_DONE) return;
+  levels[index++] = level;
+  total++;
+  if (index < count) return;
+
+  if (phase == PHASE_COARSE) {
+    uint16_t low = UINT16_MAX, high = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      if (levels[i] < low) low = levels[i];
+      if (levels[i] > high) high = levels[i];
+    }
+    // Nessuna portante, o portante (e fronti) non tutta dentro lo span
+    if (high - low < minDelta) return fail();
+    bottom = low;
+    top = high;
+    threshold = low + (high - low) / 2;
+    if (!crossing(true, lowerMilliHz) || !crossing(false, upperMilliHz)) return fail();
+    startFine(lowerMilliHz, PHASE_LOWER);
+  } else if (phase == PHASE_LOWER) {
+    if (!fitEdge(true, lowerMilliHz)) return fail();
+    startFine(upperMilliHz, PHASE_UPPER);
+  } else {
+    if (!fitEdge(false, upperMilliHz)) return fail();
+    success = upperMilliHz > lowerMilliHz;
+    phase = PHASE_DONE;
+  }
+}
+
+// Uscita reale = nominale * riferimento vero / riferimento supposto, e il
+// riferimento supposto è 25MHz * (1 + correzione / 1e9) (correctedRef)
+int32_t calCorrection(int32_t current, uint64_t targetMilliHz, uint64_t measuredMilliHz) {
+  double scale = (double)targetMilliHz / (double)measuredMilliHz;
+  double corrected = (1e9 + current) * scale - 1e9;
+  return (int32_t)(corrected < 0 ? corrected - 0.5 : corrected + 0.5);
+}
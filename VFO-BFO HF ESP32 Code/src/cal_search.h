@@ -0,0 +1,57 @@
+#ifndef CAL_SEARCH_H
+#define CAL_SEARCH_H
+
+#include <stdint.h>
+
+// Ricerca di una portante di riferimento con l'S-meter, per la calibrazione
+// automatica. Senza dipendenze Arduino: compila anche su host (src/tools/cal_sim.cpp).
+//
+// Prima una scansione grossa di tutto lo span trova la portante e i due fronti
+// della curva del filtro IF; poi una scansione fine attorno a ciascun fronte ne
+// interpola il punto a metà livello. Il centro è la media dei due fronti: con un
+// filtro a fianchi ripidi e cima piatta è molto più stabile del massimo.
+// Sui fronti fini il punto a metà livello viene da una retta ai minimi quadrati.
+
+#define CAL_SEARCH_MAX_POINTS 64    // Punti massimi per fase
+
+class CalSearch {
+public:
+  // Scansione attorno a center (Hz di sintonia); false se i parametri non stanno
+  // in CAL_SEARCH_MAX_POINTS punti per fase
+  bool begin(uint32_t center, uint32_t span, uint32_t coarseStep, uint32_t fineStep, uint16_t minDelta);
+
+  bool next(uint32_t& freq) const;  // Frequenza da misurare, false a ricerca finita
+  void report(uint16_t level);      // Livello S-meter letto sulla frequenza di next()
+
+  bool finished() const { return phase == PHASE_DONE; }
+  bool found() const { return success; }
+  uint64_t centerMilliHz() const { return (lowerMilliHz + upperMilliHz) / 2; }
+  uint64_t widthMilliHz() const { return upperMilliHz - lowerMilliHz; }
+  uint16_t measurements() const { return total; }
+
+private:
+  enum Phase : uint8_t { PHASE_COARSE, PHASE_LOWER, PHASE_UPPER, PHASE_DONE };
+
+  void startFine(uint64_t edgeMilliHz, Phase next);
+  bool crossing(bool rising, uint64_t& edgeMilliHz) const;
+  bool fitEdge(bool rising, uint64_t& edgeMilliHz) const;
+  void fail();
+
+  Phase phase = PHASE_DONE;
+  bool success = false;
+  uint32_t first = 0, step = 0;     // Fase corrente: first + i * step
+  uint16_t count = 0, index = 0;
+  uint16_t total = 0;
+  uint32_t coarseStep = 0, fineStep = 0;
+  uint16_t minDelta = 0;
+  uint16_t bottom = 0, top = 0;     // Fondo e portante (scansione grossa)
+  uint16_t threshold = 0;           // Metà tra fondo e portante
+  uint64_t lowerMilliHz = 0, upperMilliHz = 0;
+  uint16_t levels[CAL_SEARCH_MAX_POINTS];
+};
+
+// Nuova correzione (ppb, come CAL) dal VFO nominale a cui si è trovata la
+// portante e da quello a cui doveva trovarsi, con la correzione in uso
+int32_t calCorrection(int32_t current, uint64_t targetMilliHz, uint64_t measuredMilliHz);
+
+#endif
@@ -1,145 +1,227 @@
-#ifndef CONFIG_H
-#define CONFIG_H
-
-
-// Configurazione GPIO Encoder
-#define VFO_ENC_CLK 34                  // Pin CLK dell'encoder VFO
-#define VFO_ENC_DT  35                  // Pin DT dell'encoder VFO
-#define BFO_ENC_CLK 12                  // Pin CLK dell'encoder BFO
-#define BFO_ENC_DT  13                  // Pin DT dell'encoder BFO
-
-// Configurazione GPIO Pulsanti
-    #define SW_STEP 32                  // Pulsante cambio Step VFO
-    #define SW_BAND 33                  // Pulsante cambio banda
-    #define SW_MODE 25                  // Pulsante cambio modalità
-    #define SW_AGC  26                  // Pulsante AGC Fast/Slow
-    #define SW_ATT  27                  // Pulsante Attenuatore -20dB
-    #define SW_SCAN 14                  // Pulsante Scan (futuro)
-    #define SW_RTTY_CW  36              // Pulsante RTTY_CW (futuro)
-
-// Configurazione GPIO Ingresso S-Meter 
-    #define S_METER_PIN 15              // Pin analogico per il S-meter
-    #define RTTY_CW_PIN 4               // Pin digitale per RTTY_CW (futuro)
-
-// Configurazione GPIO bus I2C 
-    #define I2C_SCL 21                  // Pin SCL I2C
-    #define I2C_SDA 22                  // Pin SDA I2C
-
-// Indirizzo I2C del PCF8574A
-    #define PCF8574A_ADDRESS 0x20       // indirizzo PCF8574 (A0,A1,A2 collegati a GND)
-
-// Pin PCF8574A per codifica binaria
-    #define PCF_MODE_BIT0  P0           // Pin P0 del PCF8574
-    #define PCF_MODE_BIT1  P1           // Pin P1 del PCF8574
-    #define PCF_MODE_BIT2  P2           // Pin P2 del PCF8574
-    #define PCF_MODE_BIT3  P3           // Pin P3 del PCF8574
-    #define PCF_MODE_BIT4  P4           // Pin P4 del PCF8574
-    #define PCF_MODE_BIT5  P5           // Pin P5 del PCF8574
-    #define PCF_MODE_BIT6  P6           // Pin P6 del PCF8574
-    #define PCF_MODE_BIT7  P7           // Pin P7 del PCF8574 
-
-// Indirizzo I2C della 24LC32
-    #define EXTERNAL_EEPROM_ADDRESS 0x50// Indirizzo EEPROM esterna (A0,A1,A2 collegati a GND)
-
-// Dimensione EEPROM in byte
-    //#define EEPROM_SIZE 4096          // 24LC32 = 2Kbit = 4KB
-    //#define EEPROM_SIZE 16384         // 24LC128 = 128Kbit = 16KB
-    #define EEPROM_SIZE 32768           // 24LC256 = 256Kbit = 32KB
-
-// Timing salvataggio
-    #define EEPROM_SAVE_DELAY 3000      // Salva dopo 3 secondi di inattività
-    #define EEPROM_QUICK_SAVE_DELAY 500 // Salvataggio rapido per cambi importanti
-
-
-// Frequenza IF del ricevitore
-    #define IF_FREQUENCY 455000         // IF=455kHz
-
-// Display VFO
-    #define VFO_DISPLAY_X 15            // Posizione X del display VFO
-    #define VFO_DISPLAY_Y 30            // Posizione Y del display VFO
-    #define VFO_LABEL_SIZE 2
-    #define VFO_LABEL_COLOR TFT_SKYBLUE
-
-// Frequenze BFO base (con offset di 1.5kHz)
-    #define BFO_USB_BASE 453500         // BFO per USB (IF 455kHz - offset 1.5kHz)
-    #define BFO_LSB_BASE 456500         // BFO per LSB (IF 455kHz + offset 1.5kHz)
-    #define BFO_CW_BASE 454300          // BFO per CW (IF 455kHz - offset 700Hz) 
-
-// Limiti Pitch BFO         
-    #define BFO_PITCH_MIN -200          // -200Hz
-    #define BFO_PITCH_MAX 200           // +200Hz  
-    #define BFO_PITCH_STEP 5            // 5Hz per click
-
-// Display BFO
-    #define BFO_DISPLAY_X 80            // Posizione X del display BFO
-    #define BFO_DISPLAY_Y 98            // Posizione Y del display BFO
-    #define BFO_DISPLAY_WIDTH 120       // Larghezza display BFO
-    #define BFO_DISPLAY_HEIGHT 40       // Altezza display BFO
-    #define BFO_GRAPH_WIDTH 100         // Larghezza grafico
-    #define BFO_GRAPH_HEIGHT 12         // Altezza grafico
-    #define BFO_GRAPH_X 73              // Posizione X grafico
-    #define BFO_GRAPH_Y 115             // Posizione Y grafico
-    #define BFO_MARKER_HEIGHT 10        // Altezza linea verticale
-    #define BFO_CENTER_MARKER_HEIGHT 12 // Altezza marcatore centrale
-    #define BFO_LABEL_COLOR TFT_SKYBLUE // Colore etichetta BFO
-
-// Display STEP
-    #define STEP_BOX_X 250
-    #define STEP_BOX_Y 102
-    #define STEP_BOX_WIDTH 70
-    #define STEP_BOX_HEIGHT 40
-    #define STEP_BOX_TEXT_COLOR TFT_RED
-    #define STEP_BOX_TEXT_SIZE 1
-
-// S-Meter - Pin e configurazione 
-    #define S_METER_X 15                // Posizione X
-    #define S_METER_Y 160               // Posizione Y
-    #define S_METER_WIDTH 300           // Larghezza totale
-    #define S_METER_HEIGHT 15           // Altezza
-    #define S_METER_SEGMENTS 25         // Numero di segmenti
-    #define S_METER_SEGMENT_WIDTH 12    // Larghezza di ogni segmento
-
-// Colori S-meter
-    #define S_METER_LOW_COLOR TFT_GREEN
-    #define S_METER_HIGH_COLOR TFT_RED
-    #define S_METER_BG_COLOR TFT_DARKGREY
-
-// Posizione riquadri (banda, modalità, AGC, ATT) 
-    #define POSITION_X 10              // Posizione X
-    #define POSITION_Y 200            // Posizione Y
-    #define BOX_NUM 4                 // Numero di riquadri
-    #define BOX_WIDTH 70              // Larghezza di ogni riquadro
-    #define BOX_HEIGHT 40             // Altezza di ogni riquadro
-    #define BOX_SPACING 10            // Spaziatura tra i riquadri
-    #define BOX_RADIUS 5              // Raggio angoli arrotondati
-    #define TEXT_SIZE 2               // Dimensione testo riquadri
-    #define TEXT_SIZE_TITLE 1         // Dimensione testo etichette
-
-// Colori personalizzati
-    #define FREQUENCY_COLOR TFT_GREEN // Colore frequenza
-    #define STEP_COLOR TFT_RED        // Colore step
-    #define BAND_COLOR TFT_SKYBLUE    // Colore banda
-    #define MODE_COLOR TFT_YELLOW     // Colore modalità
-    #define BACKGROUND_COLOR TFT_BLACK// Colore sfondo
-    #define BORDER_COLOR TFT_WHITE    // Colore bordo
-
-// Debounce per tutti i pulsanti
-    const int buttonDebounce = 200;
-
-// Variabili globali 
-    extern unsigned long vfoFrequency;          // Frequenza VFO + IF
-    extern unsigned long displayedFrequency;    // Frequenza visualizzata (VFO + IF) 
-    extern int currentMode;                     // Modalità corrente
-    extern unsigned long step;                  // Passo VFO
-    extern unsigned long minFreq;               // Frequenza minima di sintonia
-    extern unsigned long maxFreq;               // Frequenza massima di sintonia
-    extern bool bfoEnabled;                     // Stato BFO: true = attivo, false = disattivo
-    extern unsigned long bfoFrequency;          // Frequenza BFO
-    extern int bfoPitchOffset[];                // Offset BFO iniziale per ogni modalità
-    extern int currentBFOOffset;                // Offset BFO corrente
-    extern bool agcFastMode;                    // Stati AGC: true = Fast, false = Slow
-    extern bool attenuatorEnabled;              // Stati ATT: true = -20dB attivo false = disattivato
-    extern long si5351Calibration;              // Fattore di calibrazione SI5351
-
-
+#ifndef CONFIG_H
+#define CONFIG_H
+
+
+// Configurazione GPIO Encoder
+#define VFO_ENC_CLK 34                  // Pin CLK dell'encoder VFO
+#define VFO_ENC_DT  35                  // Pin DT dell'encoder VFO
+#define BFO_ENC_CLK 12                  // Pin CLK dell'encoder BFO
+#define BFO_ENC_DT  13                  // Pin DT dell'encoder BFO
+
+// Encoder sul contatore di impulsi PCNT (0 = lettura software nel loop)
+    #define VFO_ENC_PCNT 1              // Encoder VFO su PCNT_UNIT_0
+    #define BFO_ENC_PCNT 0              // Encoder pitch BFO su PCNT_UNIT_1
+    #define ENC_COUNTS_PER_STEP 2       // Conteggi x4 per scatto (come la lettura software)
+    #define ENC_FILTER_CYCLES 1023      // Filtro PCNT: impulsi < 12.8us (cicli APB) ignorati
+    #define VFO_ENC_STABLE_US 0         // Lettura software: stabilità richiesta prima di un passo
+    #define BFO_ENC_STABLE_US 3000      // Encoder pitch: 3ms come il vecchio filtro
+
+// Accelerazione sintonia VFO: {scatti/s, Hz per scatto}, interpolata; lo step
+// è il minimo. Con 20 scatti/giro, 4 giri/s danno il massimo: 20m in 2-3 giri
+    #define ENC_ACCEL_MAX_STEP 10000    // Passo massimo per scatto in Hz (ultimo punto)
+    #define ENC_ACCEL_CURVE {{10, 10}, {25, 50}, {40, 200}, {60, 2000}, {80, ENC_ACCEL_MAX_STEP}}
+    #define ENC_ACCEL_IDLE_US 150000    // Pausa oltre la quale si riparte dallo step
+
+// Banco di latenza su PC (src/tools/latency_bench.cpp)
+    #define ENC_LATENCY_BUDGET_US 5000  // p99 massimo scatto -> registri Si5351 scritti
+
+// Configurazione GPIO Pulsanti
+    #define SW_STEP 32                  // Pulsante cambio Step VFO
+    #define SW_BAND 33                  // Pulsante cambio banda
+    #define SW_MODE 25                  // Pulsante cambio modalità
+    #define SW_AGC  26                  // Pulsante AGC Fast/Slow
+    #define SW_ATT  27                  // Pulsante Attenuatore -20dB
+    #define SW_SCAN 14                  // Pulsante Scan (futuro)
+    #define SW_RTTY_CW  36              // Pulsante RTTY_CW: OFF -> CW -> RTTY (pull-up esterno)
+
+// Pulsanti: tempi del motore senza attese (button.h)
+    #define BUTTON_DEBOUNCE_US 30000    // Rimbalzi ignorati dopo un cambio accettato
+    #define BUTTON_LONG_US 600000       // Pressione lunga: step/banda all'indietro
+    #define BUTTON_REPEAT_US 350000     // Banda: ripetizione tenendo premuto
+    #define BUTTON_DOUBLE_US 300000     // Modalità: doppio click = modalità precedente
+
+// Eventi di ingresso a interrupt (pulsanti ed encoder senza PCNT)
+    #define INPUT_EVENT_QUEUE 256       // Eventi in coda (potenza di 2): 300ms di fronti rapidi
+
+// Configurazione GPIO Ingresso S-Meter 
+    #define S_METER_PIN 15              // Pin analogico per il S-meter
+    #define RTTY_CW_PIN 4               // Ingresso tasto CW (attivo basso)
+
+// Configurazione GPIO bus I2C 
+    #define I2C_SCL 21                  // Pin SCL I2C
+    #define I2C_SDA 22                  // Pin SDA I2C
+
+// Indirizzo I2C del PCF8574A
+    #define PCF8574A_ADDRESS 0x20       // indirizzo PCF8574 (A0,A1,A2 collegati a GND)
+
+// Pin PCF8574A per codifica binaria
+    #define PCF_MODE_BIT0  P0           // Pin P0 del PCF8574
+    #define PCF_MODE_BIT1  P1           // Pin P1 del PCF8574
+    #define PCF_MODE_BIT2  P2           // Pin P2 del PCF8574
+    #define PCF_MODE_BIT3  P3           // Pin P3 del PCF8574
+    #define PCF_MODE_BIT4  P4           // Pin P4 del PCF8574
+    #define PCF_MODE_BIT5  P5           // Pin P5 del PCF8574
+    #define PCF_MODE_BIT6  P6           // Pin P6 del PCF8574
+    #define PCF_MODE_BIT7  P7           // Pin P7 del PCF8574 
+
+// Indirizzo I2C della 24LC32
+    #define EXTERNAL_EEPROM_ADDRESS 0x50// Indirizzo EEPROM esterna (A0,A1,A2 collegati a GND)
+
+// Dimensione EEPROM in byte
+    //#define EEPROM_SIZE 4096          // 24LC32 = 2Kbit = 4KB
+    //#define EEPROM_SIZE 16384         // 24LC128 = 128Kbit = 16KB
+    #define EEPROM_SIZE 32768           // 24LC256 = 256Kbit = 32KB
+
+// Timing salvataggio
+    #define EEPROM_SAVE_DELAY 3000      // Salva dopo 3 secondi di inattività
+    #define EEPROM_QUICK_SAVE_DELAY 500 // Salvataggio rapido per cambi importanti
+    #define EEPROM_WRITE_CYCLE_MS 10    // Attesa tra due pagine (24LCxx: ciclo max 5ms)
+
+
+// Frequenza IF del ricevitore
+    #define IF_FREQUENCY 455000         // IF=455kHz
+
+// Sintonia VFO
+    #define VFO_GLIDE_TUNING true       // Glide: Multisynth intero fisso, si muove solo il PLLA (niente click)
+    #define SPUR_GUARD_HZ 3000          // Zona attorno alle spurie frazionarie da evitare (uscita)
+    #define SPUR_MAX_DENOM 4            // Rapporti p/q considerati a rischio (q <= 4)
+
+// Task radio (proprietario del Si5351)
+    #define RADIO_TASK_CORE 1           // Stesso core del loop, priorità più alta
+    #define RADIO_TASK_PRIORITY 2       // loop() gira a priorità 1
+    #define RADIO_TASK_STACK 4096       // Stack in byte
+
+// Task UI (display e S-meter sull'altro core). Testi in buffer fissi e sprite
+// fuori dallo stack: lo "Stack libero" del comando UI deve restare sopra 1KB
+    #define UI_TASK_CORE 0              // Core libero: niente WiFi/BT
+    #define UI_TASK_PRIORITY 1          // Come il loop
+    #define UI_TASK_STACK 4096          // Stack in byte, come il task radio
+    #define UI_MAX_FPS 25               // Fotogrammi al secondo al massimo
+    #define UI_FRAME_MS (1000 / UI_MAX_FPS)  // Periodo del task UI (40ms)
+
+// Sprite al display in DMA (task UI, display_dma.cpp)
+    #define DISPLAY_DMA 1               // 0 = invio diretto, CPU ferma sul bus SPI
+    #define DISPLAY_DMA_STRIP_PIXELS 1024  // Pixel RGB565 per striscia (due strisce, 4KB)
+    #define DISPLAY_DMA_QUEUE 16        // Finestre di sprite in coda per fotogramma
+
+// Profilatore a cicli CPU (comando PERF)
+    #define PERF_PROFILER 1             // 0 = misure tolte in compilazione, costo nullo
+
+// Manipolazione RTTY/CW su CLK2
+    #define KEYER_TIMER 1               // Timer hardware dei simboli
+    #define KEYER_TIMER_HZ 10000000     // Clock del timer: APB 80MHz / 8
+    #define RTTY_BAUD_X100 4545         // 45.45 baud
+    #define RTTY_SHIFT 170              // Shift mark/space in Hz (space sotto il mark)
+    #define CW_SAMPLE_US 1000           // Campionamento del tasto CW
+    #define CW_DEBOUNCE_SAMPLES 3       // Campioni uguali per accettare un cambio
+    #define WSPR_AUDIO_OFFSET 1500      // Tono WSPR 0 sopra la frequenza visualizzata (Hz)
+
+// Sweep su CLK2 (analizzatore scalare)
+    #define SWEEP_ADC_PIN S_METER_PIN   // Rivelatore: stesso ingresso dell'S-meter
+    #define SWEEP_MAX_POINTS 500        // Punti massimi per sweep
+    #define SWEEP_SETTLE_US 200         // Attesa dopo il cambio di frequenza
+    #define SWEEP_ADC_SAMPLES 4         // Letture ADC mediate per punto
+    #define SWEEP_SPAN 20000            // Span del comando SWEEP senza argomenti (attorno alla IF)
+    #define SWEEP_TRACE_COLOR TFT_YELLOW
+
+// Calibrazione automatica (CAL_AUTO) su una portante di riferimento
+    #define CAL_AUTO_SPAN 8000          // Span della scansione grossa (Hz): filtro IF + errore quarzo
+    #define CAL_AUTO_COARSE_STEP 200    // Passo della scansione grossa (Hz)
+    #define CAL_AUTO_FINE_STEP 20       // Passo della scansione fine sui fronti (Hz)
+    #define CAL_AUTO_SETTLE_MS 30       // Attesa AGC/S-meter dopo ogni cambio di frequenza
+    #define CAL_AUTO_SAMPLES 5          // Letture ADC mediate per punto (come la media dell'S-meter)
+    #define CAL_AUTO_MIN_DELTA 300      // Escursione ADC minima per riconoscere la portante
+
+// Display VFO
+    #define VFO_DISPLAY_X 15            // Posizione X del display VFO
+    #define VFO_DISPLAY_Y 30            // Posizione Y del display VFO
+    #define FREQ_SPRITE_WIDTH 250       // Sprite della frequenza
+    #define FREQ_SPRITE_HEIGHT 60
+    #define FREQ_TEXT_Y 5               // Riga delle cifre nello sprite
+    #define FREQ_DIGIT_WIDTH 32         // Font 7: cifra 32x48
+    #define FREQ_DOT_WIDTH 12           // Font 7: punto
+    #define FREQ_GLYPH_HEIGHT 48
+    #define VFO_LABEL_SIZE 2
+    #define VFO_LABEL_COLOR TFT_SKYBLUE
+
+// Frequenze BFO base (con offset di 1.5kHz)
+    #define BFO_USB_BASE 453500         // BFO per USB (IF 455kHz - offset 1.5kHz)
+    #define BFO_LSB_BASE 456500         // BFO per LSB (IF 455kHz + offset 1.5kHz)
+    #define BFO_CW_BASE 454300          // BFO per CW (IF 455kHz - offset 700Hz) 
+
+// Limiti Pitch BFO         
+    #define BFO_PITCH_MIN -200          // -200Hz
+    #define BFO_PITCH_MAX 200           // +200Hz  
+    #define BFO_PITCH_STEP 5            // 5Hz per click
+
+// Display BFO
+    #define BFO_DISPLAY_X 80            // Posizione X del display BFO
+    #define BFO_DISPLAY_Y 98            // Posizione Y del display BFO
+    #define BFO_DISPLAY_WIDTH 120       // Larghezza display BFO
+    #define BFO_DISPLAY_HEIGHT 40       // Altezza display BFO
+    #define BFO_GRAPH_WIDTH 100         // Larghezza grafico
+    #define BFO_GRAPH_HEIGHT 12         // Altezza grafico
+    #define BFO_GRAPH_X 73              // Posizione X grafico
+    #define BFO_GRAPH_Y 115             // Posizione Y grafico
+    #define BFO_SPRITE_WIDTH 103        // Sprite del grafico: marcatore fino a 1 pixel fuori
+    #define BFO_MARKER_HEIGHT 10        // Altezza linea verticale
+    #define BFO_CENTER_MARKER_HEIGHT 12 // Altezza marcatore centrale
+    #define BFO_LABEL_COLOR TFT_SKYBLUE // Colore etichetta BFO
+
+// Display STEP
+    #define STEP_BOX_X 250
+    #define STEP_BOX_Y 102
+    #define STEP_BOX_WIDTH 70
+    #define STEP_BOX_HEIGHT 40
+    #define STEP_BOX_TEXT_COLOR TFT_RED
+    #define STEP_BOX_TEXT_SIZE 1
+
+// S-Meter - Pin e configurazione 
+    #define S_METER_X 15                // Posizione X
+    #define S_METER_Y 160               // Posizione Y
+    #define S_METER_WIDTH 300           // Larghezza totale
+    #define S_METER_HEIGHT 15           // Altezza
+    #define S_METER_SEGMENTS 25         // Numero di segmenti
+    #define S_METER_SEGMENT_WIDTH 12    // Larghezza di ogni segmento
+    #define S_METER_SPRITE_HEIGHT 21    // Sprite della barra: tacche di picco sopra e sotto
+
+// Colori S-meter
+    #define S_METER_LOW_COLOR TFT_GREEN
+    #define S_METER_HIGH_COLOR TFT_RED
+    #define S_METER_BG_COLOR TFT_DARKGREY
+
+// Posizione riquadri (banda, modalità, AGC, ATT) 
+    #define POSITION_X 10              // Posizione X
+    #define POSITION_Y 200            // Posizione Y
+    #define BOX_NUM 4                 // Numero di riquadri
+    #define BOX_WIDTH 70              // Larghezza di ogni riquadro
+    #define BOX_HEIGHT 40             // Altezza di ogni riquadro
+    #define BOX_SPACING 10            // Spaziatura tra i riquadri
+    #define BOX_RADIUS 5              // Raggio angoli arrotondati
+    #define TEXT_SIZE 2               // Dimensione testo riquadri
+    #define TEXT_SIZE_TITLE 1         // Dimensione testo etichette
+
+// Colori personalizzati
+    #define FREQUENCY_COLOR TFT_GREEN // Colore frequenza
+    #define STEP_COLOR TFT_RED        // Colore step
+    #define BAND_COLOR TFT_SKYBLUE    // Colore banda
+    #define MODE_COLOR TFT_YELLOW     // Colore modalità
+    #define BACKGROUND_COLOR TFT_BLACK// Colore sfondo
+    #define BORDER_COLOR TFT_WHITE    // Colore bordo
+
+// Variabili globali 
+    extern unsigned long vfoFrequency;          // Frequenza VFO + IF
+    extern unsigned long displayedFrequency;    // Frequenza visualizzata (VFO + IF) 
+    extern int currentMode;                     // Modalità corrente
+    extern unsigned long step;                  // Passo VFO
+    extern unsigned long minFreq;               // Frequenza minima di sintonia
+    extern unsigned long maxFreq;               // Frequenza massima di sintonia
+    extern bool bfoEnabled;                     // Stato BFO: true = attivo, false = disattivo
+    extern unsigned long bfoFrequency;          // Frequenza BFO
+    extern int bfoPitchOffset[];                // Offset BFO iniziale per ogni modalità
+    extern int currentBFOOffset;                // Offset BFO corrente
+    extern bool agcFastMode;                    // Stati AGC: true = Fast, false = Slow
+    extern bool attenuatorEnabled;              // Stati ATT: true = -20dB attivo false = disattivato
+
+
 #endif
\ No newline at end of file
@@ -1,295 +1,350 @@
-#include "display.h"
-#include "config.h"
-#include "bands.h"
-#include "modes.h"
-#include "s_meter.h"
-#include "PLL.h"
-
-
-TFT_eSPI tft; // Definisci l'oggetto TFT_eSPI
-
-//################################ Layout Iniziale #####################################
-
-  // Disegna il layout iniziale del display
-  void drawDisplayLayout() {        
-  // Prima inizializza lo sprite
-  setupFrequencySprite();
-
-  // Riquadri  (banda, modalità, AGC, ATT)
-  const char *LABELS[] = {"BAND", "MODE", "AGC", "ATT"};
-  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
-  tft.setTextFont(1);
-  tft.setTextSize(TEXT_SIZE_TITLE);
-
-  // Disegna i riquadri con etichetta
-  for (int i = 0; i < BOX_NUM; i++) {
-    int x = POSITION_X + i * (BOX_WIDTH + BOX_SPACING);
-    int y = POSITION_Y;
-    tft.fillRoundRect(x, y, BOX_WIDTH, BOX_HEIGHT, BOX_RADIUS, BACKGROUND_COLOR);
-    tft.drawRoundRect(x, y, BOX_WIDTH, BOX_HEIGHT, BOX_RADIUS, BORDER_COLOR);
-    tft.drawRoundRect(x+1, y+1, BOX_WIDTH-2, BOX_HEIGHT-2, BOX_RADIUS, BORDER_COLOR);
-    String TEXT = LABELS[i];
-    int textWidth = TEXT.length() * 5;
-    int textX = x + (BOX_WIDTH - textWidth) / 2;
-    int textY = y + 5;
-    tft.drawString(TEXT, textX, textY);
-  }
-
-  // Disegna riquadro step
-  tft.fillRoundRect(STEP_BOX_X, STEP_BOX_Y, STEP_BOX_WIDTH, STEP_BOX_HEIGHT, BOX_RADIUS, BACKGROUND_COLOR);
-  tft.drawRoundRect(STEP_BOX_X, STEP_BOX_Y, STEP_BOX_WIDTH, STEP_BOX_HEIGHT, BOX_RADIUS, BORDER_COLOR);
-  tft.drawRoundRect(STEP_BOX_X+1, STEP_BOX_Y+1, STEP_BOX_WIDTH-2, STEP_BOX_HEIGHT-2, BOX_RADIUS, BORDER_COLOR);
-
-  // Scrivi l'unità di Step
-  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
-  tft.setTextSize(STEP_BOX_TEXT_SIZE);
-  tft.drawString("STEP", STEP_BOX_X + 25, STEP_BOX_Y + 5);
-
-  // Scrivi l'unità di Frequenza
-  tft.setTextSize(VFO_LABEL_SIZE);
-  tft.setTextColor(VFO_LABEL_COLOR, BACKGROUND_COLOR);
-  tft.drawString("MHz", VFO_DISPLAY_X+260, VFO_DISPLAY_Y+40);
-  
-  // Inizializza l'S-meter
-  setupSMeter();
-  
-  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
-  tft.setTextSize(1);
-  
-  for (int i = 0; i < S_METER_SEGMENTS; i++) {
-    int segmentX = S_METER_X + (i * S_METER_SEGMENT_WIDTH);
-    
-    if (i == 0) tft.drawString("S", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
-    else if (i == 3) tft.drawString("1", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
-    else if (i == 6) tft.drawString("3", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
-    else if (i == 9) tft.drawString("5", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
-    else if (i == 12) tft.drawString("7", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
-    else if (i == 15) tft.drawString("9", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
-    else if (i == 18) {
-      tft.setTextColor(TFT_ORANGE, BACKGROUND_COLOR);
-      tft.drawString("+20", segmentX - 2, S_METER_Y + S_METER_HEIGHT + 5);
-    } else if (i == 21) {
-      tft.setTextColor(TFT_ORANGE, BACKGROUND_COLOR);
-      tft.drawString("+40", segmentX - 2, S_METER_Y + S_METER_HEIGHT + 5);
-    } else if (i == 24) {
-      tft.setTextColor(TFT_ORANGE, BACKGROUND_COLOR);
-      tft.drawString("+60", segmentX - 2, S_METER_Y + S_METER_HEIGHT + 5);
-    }
-  }
-  
-  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
-  
-/*   // Inizializza la visualizzazione della frequenza
-  lastFreqStr = ""; // Forza l'aggiornamento iniziale
-  updateFrequencyDisplay(); */
-}
-
-//################################ Grafica Frequenza #####################################
-// Definisci lo Sprite della frequenza
-TFT_eSprite freqSprite = TFT_eSprite(&tft);  
-
-// Variabili per l'aggiornamento della frequenza
-static String lastFreqStr = "";
-static int lastSpriteWidth = 0;
-static int lastSpriteX = 0;
-
-// Aggiorna la visualizzazione della frequenza VFO
-void updateFrequencyDisplay() {
-  String freqStr = formatFrequency(displayedFrequency); 
-  
-  // Aggiorna solo se la stringa è cambiata
-  if (freqStr != lastFreqStr) {
-
-    // Calcola la posizione in base alla lunghezza
-    int xPos;
-    int textWidth = freqStr.length() * 24;
-    
-    if (textWidth == 216) xPos = 0;       // 9 caratteri
-    else if (textWidth == 192) xPos = 32; // 8 caratteri (spostato a sinistra)
-    else xPos = 32; // Default (spostato a sinistra)
-    
-    // Pulisci lo sprite
-    freqSprite.fillSprite(BACKGROUND_COLOR);
-    
-    // Disegna la frequenza sullo sprite
-    freqSprite.drawString(freqStr, xPos, 5);
-    
-    // Calcola la posizione di destinazione sul display 
-    int destX = VFO_DISPLAY_X; 
-    int destY = VFO_DISPLAY_Y;
-    
-    // Push dello sprite sul display
-    freqSprite.pushSprite(destX, destY);
-    
-    lastFreqStr = freqStr;
-    lastSpriteWidth = textWidth;
-    lastSpriteX = xPos;
-  }
-}
-
-// Disegna lo sprite della frequenza
-void setupFrequencySprite() {
-  // Crea uno sprite di 250x60 pixel (abbastanza grande per la frequenza)
-  freqSprite.setColorDepth(8);
-  freqSprite.createSprite(250, 60);
-  freqSprite.fillSprite(BACKGROUND_COLOR);
-  freqSprite.setTextColor(FREQUENCY_COLOR, BACKGROUND_COLOR);
-  freqSprite.setTextFont(7);
-  freqSprite.setTextSize(0);
-}
-
-// Formatta la frequenza in una stringa leggibile
-String formatFrequency(unsigned long freq) {
-  static char buffer[12];
-  
-  if (freq >= 1000000) {
-    unsigned long mhz = freq / 1000000;
-    unsigned long hz = freq % 1000000;
-    unsigned long khz_part = hz / 1000;
-    unsigned long hz_part = hz % 1000;
-    
-    snprintf(buffer, sizeof(buffer), "%lu.%03lu.%02lu", mhz, khz_part, hz_part / 10);
-  } else {
-    unsigned long khz = freq / 1000;
-    unsigned long hz = freq % 1000;
-    snprintf(buffer, sizeof(buffer), "%lu.%02lu", khz, hz / 10);
-  }
-  
-  return String(buffer);
-}
-
-//############################# Grafica Step #####################################
-// Aggiorna la visualizzazione dello step
-void updateStepDisplay() {
-  static String lastStepStr = "";
-  
-  String stepStr;
-  if (step == 10) stepStr = "10Hz";
-  else if (step == 100) stepStr = "100Hz";
-  else if (step == 1000) stepStr = "1kHz";
-  else if (step == 10000) stepStr = "10kHz";
-  
-  if (stepStr != lastStepStr) {
-    tft.fillRect(STEP_BOX_X+2, STEP_BOX_Y+15, STEP_BOX_WIDTH-4, STEP_BOX_HEIGHT-20, BACKGROUND_COLOR);
-    tft.setTextColor(STEP_COLOR, BACKGROUND_COLOR);
-    tft.setTextSize(2);
-    
-    // Calcola la posizione X centrata
-    int textWidth = stepStr.length() * 12; // Approssimazione: 12 pixel per carattere
-    int centeredX = STEP_BOX_X + (STEP_BOX_WIDTH - textWidth) / 2;
-    
-    // Disegna il testo centrato
-    tft.drawString(stepStr, centeredX, STEP_BOX_Y+15);
-    lastStepStr = stepStr;
-  }
-}
-
-//################################ Grafica BFO #####################################
-// Variabili per il BFO
-static bool bfoDisplayInitialized = false;
-static bool lastBFOEnabled = false;
-static unsigned long lastBFOFreq = 0;
-
-// Disegna gli elementi statici del BFO
-void drawBFOStaticElements() {
-  tft.fillRect(BFO_DISPLAY_X-60, BFO_DISPLAY_Y, BFO_DISPLAY_WIDTH+75, BFO_DISPLAY_HEIGHT, BACKGROUND_COLOR);
-  
-  // Disegna la scritta "BFO: e kHz"
-  tft.setTextColor(BFO_LABEL_COLOR , BACKGROUND_COLOR);
-  tft.setTextSize(2);
-  tft.drawString("BFO:", BFO_DISPLAY_X-60, BFO_DISPLAY_Y+15);
-  tft.drawString("kHz", BFO_DISPLAY_X+BFO_GRAPH_WIDTH+5, BFO_DISPLAY_Y+15);
-  
-  // Disegna il grafico della frequenza BFO
-  tft.drawFastHLine(BFO_GRAPH_X, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT/2, BFO_GRAPH_WIDTH, TFT_WHITE);
-  
-  // Disegna il marcatore centrale (ROSSO) - CORREZIONE
-  int centerX = BFO_GRAPH_X + BFO_GRAPH_WIDTH/2;
-  tft.drawFastVLine(centerX-1, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_RED);
-  tft.drawFastVLine(centerX, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_RED);
-  tft.drawFastVLine(centerX+1, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_RED);
-
-  // Disegna le etichette del grafico
-  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
-  tft.setTextSize(1);
-  tft.setCursor(BFO_GRAPH_X, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT + 2);
-  tft.print("453");
-  tft.setCursor(BFO_GRAPH_X + BFO_GRAPH_WIDTH/2 - 8, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT + 2);
-  tft.print("455");
-  tft.setCursor(BFO_GRAPH_X + BFO_GRAPH_WIDTH - 18, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT + 2);
-  tft.print("457");
-  
-  bfoDisplayInitialized = true;
-}
-
-// Aggiorna solo gli elementi dinamici del BFO
-void updateBFODynamicElements() {
-  if (!bfoEnabled) return;
-  
-  // Pulisci solo l'area della frequenza visualizzata
-  tft.fillRect(BFO_DISPLAY_X, BFO_DISPLAY_Y, BFO_DISPLAY_WIDTH-100, 20, BACKGROUND_COLOR);
-  
-  // Pulisci l'area del grafico (solo la parte del marker verde)
-  // MA mantieni la linea bianca e il marcatore centrale
-  tft.fillRect(BFO_GRAPH_X, BFO_GRAPH_Y, BFO_GRAPH_WIDTH, BFO_GRAPH_HEIGHT, BACKGROUND_COLOR);
-  
-  // Ridisegna la linea orizzontale del grafico
-  tft.drawFastHLine(BFO_GRAPH_X, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT/2, BFO_GRAPH_WIDTH, TFT_WHITE);
-  
-  // Ridisegna il marcatore centrale (ROSSO)
-  int centerX = BFO_GRAPH_X + BFO_GRAPH_WIDTH/2;
-  tft.drawFastVLine(centerX-1, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_RED);
-  tft.drawFastVLine(centerX, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_RED);
-  tft.drawFastVLine(centerX+1, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_RED);
-
-  // Calcola la posizione del marcatore VERDE
-  int markerPos = map(bfoFrequency, 453000, 457000, BFO_GRAPH_X, BFO_GRAPH_X + BFO_GRAPH_WIDTH);
-  markerPos = constrain(markerPos, BFO_GRAPH_X, BFO_GRAPH_X + BFO_GRAPH_WIDTH);
-  
-  // Disegna il marcatore della frequenza BFO (VERDE)
-  tft.drawFastVLine(markerPos-1, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_GREEN);
-  tft.drawFastVLine(markerPos, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_GREEN);
-  tft.drawFastVLine(markerPos+1, BFO_GRAPH_Y, BFO_GRAPH_HEIGHT, TFT_GREEN);
-  
-  // Visualizza frequenza BFO con 3 cifre decimali - CORREZIONE
-  tft.setTextColor(BFO_LABEL_COLOR, BACKGROUND_COLOR);
-  tft.setTextSize(1);
-  //tft.setCursor(BFO_DISPLAY_X+BFO_DISPLAY_WIDTH/2-30, BFO_DISPLAY_Y+5);
-  tft.setCursor(BFO_GRAPH_X+BFO_GRAPH_WIDTH/2-21, BFO_DISPLAY_Y+5);
-
-  // Visualizza frequenza BFO con tutte e 3 le cifre decimali
-  unsigned long khz = bfoFrequency / 1000;
-  unsigned long hz = bfoFrequency % 1000;
-  tft.print(khz);
-  tft.print(".");
-  // Aggiungi zeri iniziali se necessario
-  if (hz < 100) tft.print("0");
-  if (hz < 10) tft.print("0");
-  tft.print(hz);
-}
-
-// Disegna il display BFO
-void drawBFODisplay() {
-  // Se il BFO è stato disabilitato o è la prima volta, ridisegna tutto
-  if (!bfoDisplayInitialized || bfoEnabled != lastBFOEnabled) {
-    if (bfoEnabled) {
-      drawBFOStaticElements();
-      updateBFODynamicElements();
-    } else {
-      // Se il BFO è disabilitato, pulisci l'area
-      tft.fillRect(BFO_DISPLAY_X-60, BFO_DISPLAY_Y, BFO_DISPLAY_WIDTH+80, BFO_DISPLAY_HEIGHT, BACKGROUND_COLOR);
-      bfoDisplayInitialized = false;
-    }
-    lastBFOEnabled = bfoEnabled;
-  }
-  
-  // Aggiorna gli elementi dinamici solo se il BFO è abilitato e la frequenza è cambiata
-  if (bfoEnabled && abs((long)(bfoFrequency - lastBFOFreq)) > 0) { // Aggiorna per ogni variazione
-    updateBFODynamicElements();
-    lastBFOFreq = bfoFrequency;
-  }
-}
-
-
-
-
+#include "display.h"
+#include "config.h"
+#include "bands.h"
+#include "modes.h"
+#include "s_meter.h"
+#include "PLL.h"
+#include "display_dma.h"
+#include "text_format.h"
+
+
+TFT_eSPI tft; // Definisci l'oggetto TFT_eSPI
+
+//################################ Layout Iniziale #####################################
+
+  // Disegna il layout iniziale del display
+  void drawDisplayLayout() {        
+  // Prima inizializza lo sprite
+  setupFrequencySprite();
+
+  // Riquadri  (banda, modalità, AGC, ATT)
+  const char *LABELS[] = {"BAND", "MODE", "AGC", "ATT"};
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextFont(1);
+  tft.setTextSize(TEXT_SIZE_TITLE);
+
+  // Disegna i riquadri con etichetta
+  for (int i = 0; i < BOX_NUM; i++) {
+    int x = POSITION_X + i * (BOX_WIDTH + BOX_SPACING);
+    int y = POSITION_Y;
+    tft.fillRoundRect(x, y, BOX_WIDTH, BOX_HEIGHT, BOX_RADIUS, BACKGROUND_COLOR);
+    tft.drawRoundRect(x, y, BOX_WIDTH, BOX_HEIGHT, BOX_RADIUS, BORDER_COLOR);
+    tft.drawRoundRect(x+1, y+1, BOX_WIDTH-2, BOX_HEIGHT-2, BOX_RADIUS, BORDER_COLOR);
+    int textWidth = strlen(LABELS[i]) * 5;
+    int textX = x + (BOX_WIDTH - textWidth) / 2;
+    int textY = y + 5;
+    tft.drawString(LABELS[i], textX, textY);
+  }
+
+  // Disegna riquadro step
+  tft.fillRoundRect(STEP_BOX_X, STEP_BOX_Y, STEP_BOX_WIDTH, STEP_BOX_HEIGHT, BOX_RADIUS, BACKGROUND_COLOR);
+  tft.drawRoundRect(STEP_BOX_X, STEP_BOX_Y, STEP_BOX_WIDTH, STEP_BOX_HEIGHT, BOX_RADIUS, BORDER_COLOR);
+  tft.drawRoundRect(STEP_BOX_X+1, STEP_BOX_Y+1, STEP_BOX_WIDTH-2, STEP_BOX_HEIGHT-2, BOX_RADIUS, BORDER_COLOR);
+
+  // Scrivi l'unità di Step
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextSize(STEP_BOX_TEXT_SIZE);
+  tft.drawString("STEP", STEP_BOX_X + 25, STEP_BOX_Y + 5);
+
+  // Scrivi l'unità di Frequenza
+  tft.setTextSize(VFO_LABEL_SIZE);
+  tft.setTextColor(VFO_LABEL_COLOR, BACKGROUND_COLOR);
+  tft.drawString("MHz", VFO_DISPLAY_X+260, VFO_DISPLAY_Y+40);
+  
+  // Inizializza l'S-meter
+  setupSMeter();
+  drawSMeterScale();
+  
+/*   // Inizializza la visualizzazione della frequenza
+  lastFreqStr = ""; // Forza l'aggiornamento iniziale
+  updateFrequencyDisplay(); */
+}
+
+// Scala dell'S-meter sotto i segmenti
+void drawSMeterScale() {
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextSize(1);
+  
+  for (int i = 0; i < S_METER_SEGMENTS; i++) {
+    int segmentX = S_METER_X + (i * S_METER_SEGMENT_WIDTH);
+    
+    if (i == 0) tft.drawString("S", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
+    else if (i == 3) tft.drawString("1", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
+    else if (i == 6) tft.drawString("3", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
+    else if (i == 9) tft.drawString("5", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
+    else if (i == 12) tft.drawString("7", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
+    else if (i == 15) tft.drawString("9", segmentX, S_METER_Y + S_METER_HEIGHT + 5);
+    else if (i == 18) {
+      tft.setTextColor(TFT_ORANGE, BACKGROUND_COLOR);
+      tft.drawString("+20", segmentX - 2, S_METER_Y + S_METER_HEIGHT + 5);
+    } else if (i == 21) {
+      tft.setTextColor(TFT_ORANGE, BACKGROUND_COLOR);
+      tft.drawString("+40", segmentX - 2, S_METER_Y + S_METER_HEIGHT + 5);
+    } else if (i == 24) {
+      tft.setTextColor(TFT_ORANGE, BACKGROUND_COLOR);
+      tft.drawString("+60", segmentX - 2, S_METER_Y + S_METER_HEIGHT + 5);
+    }
+  }
+  
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+}
+
+//################################ Grafica Frequenza #####################################
+// Definisci lo Sprite della frequenza
+TFT_eSprite freqSprite = TFT_eSprite(&tft);  
+
+FreqDisplayStats freqDisplayStats = {0, 0, 0};
+
+// Celle fisse della frequenza "MM.kkk.hh", allineate a destra nello sprite:
+// ogni cella ha sempre la stessa x, così si ridisegnano e si inviano solo le
+// celle cambiate (a 10Hz di step di solito le ultime una o due cifre)
+#define FREQ_CELLS 9
+static const bool freqCellDot[FREQ_CELLS] = {false, false, true, false, false, false, true, false, false};
+static int16_t freqCellX[FREQ_CELLS];
+static char freqShown[FREQ_CELLS];      // Celle sul display ('\0' = da disegnare)
+static bool freqSpriteShown = false;
+
+static int16_t freqCellWidth(uint8_t cell) {
+  return freqCellDot[cell] ? FREQ_DOT_WIDTH : FREQ_DIGIT_WIDTH;
+}
+
+// Frequenza nelle celle, solo con interi: "MM.kkk.hh" da 1MHz, "kkk.hh" sotto
+// (come formatFrequency() di text_format.h); zeri iniziali e separatori inutili restano vuoti
+static void frequencyCells(unsigned long freq, char* cells) {
+  unsigned long v = freq / 10;
+  memset(cells, ' ', FREQ_CELLS);
+  cells[8] = '0' + v % 10; v /= 10;
+  cells[7] = '0' + v % 10; v /= 10;
+  cells[6] = '.';
+
+  bool mhz = freq >= 1000000;
+  for (int8_t i = 5; i >= 3; i--) {
+    if (v == 0 && !mhz && i < 5) break;
+    cells[i] = '0' + v % 10; v /= 10;
+  }
+  if (!mhz) return;
+
+  cells[2] = '.';
+  cells[1] = '0' + v % 10; v /= 10;
+  if (v > 0) cells[0] = '0' + v % 10;
+}
+
+static void drawFrequencyCell(uint8_t cell, char c) {
+  freqSprite.fillRect(freqCellX[cell], FREQ_TEXT_Y, freqCellWidth(cell), FREQ_GLYPH_HEIGHT, BACKGROUND_COLOR);
+  if (c != ' ') freqSprite.drawChar(c, freqCellX[cell], FREQ_TEXT_Y);
+}
+
+// Invia al display le celle first..last-1 in un'unica finestra
+static void pushFrequencyCells(uint8_t first, uint8_t last) {
+  int16_t x = freqCellX[first];
+  int16_t w = freqCellX[last - 1] + freqCellWidth(last - 1) - x;
+  pushSpriteDMA(freqSprite, VFO_DISPLAY_X + x, VFO_DISPLAY_Y + FREQ_TEXT_Y, x, FREQ_TEXT_Y, w, FREQ_GLYPH_HEIGHT,
+                FREQUENCY_COLOR, BACKGROUND_COLOR);
+  freqDisplayStats.pixels += (uint32_t)w * FREQ_GLYPH_HEIGHT;
+}
+
+// Aggiorna la visualizzazione della frequenza VFO
+void updateFrequencyDisplay(unsigned long freq) {
+  char cells[FREQ_CELLS];
+  frequencyCells(freq, cells);
+
+  // Celle cambiate a gruppi contigui: un invio per gruppo
+  uint8_t changed = 0;
+  int8_t runStart = -1;
+  for (uint8_t i = 0; i <= FREQ_CELLS; i++) {
+    if (i < FREQ_CELLS && cells[i] != freqShown[i]) {
+      drawFrequencyCell(i, cells[i]);
+      freqShown[i] = cells[i];
+      changed++;
+      if (runStart < 0) runStart = i;
+    } else if (runStart >= 0) {
+      if (freqSpriteShown) pushFrequencyCells(runStart, i);
+      runStart = -1;
+    }
+  }
+  if (changed == 0) return;
+
+  // Primo disegno: tutto lo sprite, anche lo sfondo attorno alle cifre
+  if (!freqSpriteShown) {
+    pushSpriteDMA(freqSprite, VFO_DISPLAY_X, VFO_DISPLAY_Y, 0, 0, FREQ_SPRITE_WIDTH, FREQ_SPRITE_HEIGHT,
+                  FREQUENCY_COLOR, BACKGROUND_COLOR);
+    freqDisplayStats.pixels += (uint32_t)FREQ_SPRITE_WIDTH * FREQ_SPRITE_HEIGHT;
+    freqSpriteShown = true;
+  }
+  freqDisplayStats.updates++;
+  freqDisplayStats.cells += changed;
+}
+
+// Disegna lo sprite della frequenza (creato da setupDisplaySprites)
+void setupFrequencySprite() {
+  freqSprite.fillSprite(BACKGROUND_COLOR);
+  freqSprite.setTextColor(FREQUENCY_COLOR, BACKGROUND_COLOR);
+  freqSprite.setTextFont(7);
+  freqSprite.setTextSize(0);
+
+  // Posizioni delle celle da destra, a 2 pixel dal bordo
+  int16_t x = FREQ_SPRITE_WIDTH - 2;
+  for (int8_t i = FREQ_CELLS - 1; i >= 0; i--) {
+    x -= freqCellWidth(i);
+    freqCellX[i] = x;
+  }
+  memset(freqShown, 0, sizeof(freqShown));
+  freqSpriteShown = false;
+}
+
+// Byte di uno sprite di TFT_eSPI: righe arrotondate al byte
+static uint32_t spriteBytes(int16_t w, int16_t h, uint8_t bpp) {
+  return (uint32_t)((w * bpp + 7) / 8) * h;
+}
+
+//############################# Grafica Step #####################################
+// Aggiorna la visualizzazione dello step
+void updateStepDisplay(unsigned long stepHz) {
+  static TextCache<BOX_TEXT_SIZE> shownStep;
+  
+  const char* stepText = "";
+  if (stepHz == 10) stepText = "10Hz";
+  else if (stepHz == 100) stepText = "100Hz";
+  else if (stepHz == 1000) stepText = "1kHz";
+  else if (stepHz == 10000) stepText = "10kHz";
+  
+  if (shownStep.update(stepText)) {
+    tft.fillRect(STEP_BOX_X+2, STEP_BOX_Y+15, STEP_BOX_WIDTH-4, STEP_BOX_HEIGHT-20, BACKGROUND_COLOR);
+    tft.setTextColor(STEP_COLOR, BACKGROUND_COLOR);
+    tft.setTextSize(2);
+    
+    // Calcola la posizione X centrata
+    int textWidth = strlen(stepText) * 12; // Approssimazione: 12 pixel per carattere
+    int centeredX = STEP_BOX_X + (STEP_BOX_WIDTH - textWidth) / 2;
+    
+    // Disegna il testo centrato
+    tft.drawString(stepText, centeredX, STEP_BOX_Y+15);
+  }
+}
+
+//################################ Grafica BFO #####################################
+// Variabili per il BFO
+static bool bfoDisplayInitialized = false;
+static bool lastBFOEnabled = false;
+static unsigned long lastBFOFreq = 0;
+
+// Grafico in uno sprite a 4 bpp largo quanto le posizioni del marcatore verde
+// (una colonna in più per lato): si ridisegna in RAM e si invia in una volta
+static TFT_eSprite bfoSprite = TFT_eSprite(&tft);
+enum { BFO_INK_BACKGROUND, BFO_INK_LINE, BFO_INK_CENTER, BFO_INK_MARKER };
+static uint16_t bfoPalette[16] = {BACKGROUND_COLOR, TFT_WHITE, TFT_RED, TFT_GREEN};
+
+static uint32_t setupBFOSprite() {
+  bfoSprite.setColorDepth(4);
+  if (!bfoSprite.createSprite(BFO_SPRITE_WIDTH, BFO_GRAPH_HEIGHT)) return 0;
+  bfoSprite.createPalette(bfoPalette);
+  return spriteBytes(BFO_SPRITE_WIDTH, BFO_GRAPH_HEIGHT, 4);
+}
+
+// Linea, marcatore centrale (ROSSO) e marcatore della frequenza (VERDE)
+static void drawBFOGraph(unsigned long freq) {
+  bfoSprite.fillSprite(BFO_INK_BACKGROUND);
+  bfoSprite.drawFastHLine(1, BFO_GRAPH_HEIGHT/2, BFO_GRAPH_WIDTH, BFO_INK_LINE);
+
+  int centerX = 1 + BFO_GRAPH_WIDTH/2;
+  bfoSprite.fillRect(centerX-1, 0, 3, BFO_GRAPH_HEIGHT, BFO_INK_CENTER);
+
+  int markerPos = map(freq, 453000, 457000, 1, 1 + BFO_GRAPH_WIDTH);
+  markerPos = constrain(markerPos, 1, 1 + BFO_GRAPH_WIDTH);
+  bfoSprite.fillRect(markerPos-1, 0, 3, BFO_GRAPH_HEIGHT, BFO_INK_MARKER);
+
+  pushSpriteDMA(bfoSprite, BFO_GRAPH_X - 1, BFO_GRAPH_Y, 0, 0, BFO_SPRITE_WIDTH, BFO_GRAPH_HEIGHT);
+}
+
+// Disegna gli elementi statici del BFO
+void drawBFOStaticElements() {
+  tft.fillRect(BFO_DISPLAY_X-60, BFO_DISPLAY_Y, BFO_DISPLAY_WIDTH+75, BFO_DISPLAY_HEIGHT, BACKGROUND_COLOR);
+  
+  // Disegna la scritta "BFO: e kHz"
+  tft.setTextColor(BFO_LABEL_COLOR , BACKGROUND_COLOR);
+  tft.setTextSize(2);
+  tft.drawString("BFO:", BFO_DISPLAY_X-60, BFO_DISPLAY_Y+15);
+  tft.drawString("kHz", BFO_DISPLAY_X+BFO_GRAPH_WIDTH+5, BFO_DISPLAY_Y+15);
+
+  // Disegna le etichette del grafico
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextSize(1);
+  tft.setCursor(BFO_GRAPH_X, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT + 2);
+  tft.print("453");
+  tft.setCursor(BFO_GRAPH_X + BFO_GRAPH_WIDTH/2 - 8, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT + 2);
+  tft.print("455");
+  tft.setCursor(BFO_GRAPH_X + BFO_GRAPH_WIDTH - 18, BFO_GRAPH_Y + BFO_GRAPH_HEIGHT + 2);
+  tft.print("457");
+  
+  bfoDisplayInitialized = true;
+}
+
+// Aggiorna solo gli elementi dinamici del BFO
+void updateBFODynamicElements(unsigned long freq) {  
+  // Pulisci solo l'area della frequenza visualizzata
+  tft.fillRect(BFO_DISPLAY_X, BFO_DISPLAY_Y, BFO_DISPLAY_WIDTH-100, 20, BACKGROUND_COLOR);
+  
+  // Grafico con linea, centro e marcatore: sprite intero, senza sfarfallio
+  drawBFOGraph(freq);
+  
+  // Visualizza frequenza BFO con 3 cifre decimali - CORREZIONE
+  tft.setTextColor(BFO_LABEL_COLOR, BACKGROUND_COLOR);
+  tft.setTextSize(1);
+  //tft.setCursor(BFO_DISPLAY_X+BFO_DISPLAY_WIDTH/2-30, BFO_DISPLAY_Y+5);
+  tft.setCursor(BFO_GRAPH_X+BFO_GRAPH_WIDTH/2-21, BFO_DISPLAY_Y+5);
+
+  // Visualizza frequenza BFO con tutte e 3 le cifre decimali
+  char bfoText[BFO_TEXT_SIZE];
+  formatBFOFrequency(bfoText, freq);
+  tft.print(bfoText);
+}
+
+// Disegna il display BFO
+void drawBFODisplay(bool enabled, unsigned long freq) {
+  // Se il BFO è stato disabilitato o è la prima volta, ridisegna tutto
+  if (!bfoDisplayInitialized || enabled != lastBFOEnabled) {
+    if (enabled) {
+      drawBFOStaticElements();
+      updateBFODynamicElements(freq);
+      lastBFOFreq = freq;
+    } else {
+      // Se il BFO è disabilitato, pulisci l'area
+      tft.fillRect(BFO_DISPLAY_X-60, BFO_DISPLAY_Y, BFO_DISPLAY_WIDTH+80, BFO_DISPLAY_HEIGHT, BACKGROUND_COLOR);
+      bfoDisplayInitialized = false;
+    }
+    lastBFOEnabled = enabled;
+  }
+  
+  // Aggiorna gli elementi dinamici solo se il BFO è abilitato e la frequenza è cambiata
+  if (enabled && freq != lastBFOFreq) { // Aggiorna per ogni variazione
+    updateBFODynamicElements(freq);
+    lastBFOFreq = freq;
+  }
+}
+
+//################################ Sprite #####################################
+// Sprite a bassa profondità di colore: la frequenza a 1 bpp (cifra o sfondo),
+// grafico BFO e S-meter a 4 bpp con tavolozza. In RAM restano indici, i colori
+// RGB565 si ricavano solo durante l'invio SPI. Da chiamare una volta nel
+// setup, prima del task UI; restituisce i byte allocati
+uint32_t setupDisplaySprites() {
+  uint32_t bytes = 0;
+
+  // Frequenza: 250x60 a 1 bpp, colori di cifra e sfondo applicati all'invio
+  freqSprite.setColorDepth(1);
+  if (freqSprite.createSprite(FREQ_SPRITE_WIDTH, FREQ_SPRITE_HEIGHT)) {
+    bytes += spriteBytes(FREQ_SPRITE_WIDTH, FREQ_SPRITE_HEIGHT, 1);
+  }
+  freqSprite.setBitmapColor(FREQUENCY_COLOR, BACKGROUND_COLOR);
+
+  bytes += setupBFOSprite();
+  bytes += setupSMeterSprite();
+  return bytes;
+}
+
+// Gli stessi sprite a 8 bpp, come era quello della frequenza (per il confronto)
+uint32_t displaySpriteBytes8bpp() {
+  return spriteBytes(FREQ_SPRITE_WIDTH, FREQ_SPRITE_HEIGHT, 8)
+       + spriteBytes(BFO_SPRITE_WIDTH, BFO_GRAPH_HEIGHT, 8)
+       + spriteBytes(S_METER_WIDTH, S_METER_SPRITE_HEIGHT, 8);
+}
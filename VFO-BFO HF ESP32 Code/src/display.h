@@ -1,16 +1,27 @@
-#ifndef DISPLAY_H
-#define DISPLAY_H
-
-#include <TFT_eSPI.h>
-
-extern TFT_eSPI tft;
-extern TFT_eSprite freqSprite;  // Aggiungi Sprite per la frequenza
-
-void drawDisplayLayout();
-void updateFrequencyDisplay();
-void updateStepDisplay();
-void drawBFODisplay();
-String formatFrequency(unsigned long freq);
-void setupFrequencySprite();    // Nuova funzione per inizializzare Sprite
-
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <TFT_eSPI.h>
+
+extern TFT_eSPI tft;
+extern TFT_eSprite freqSprite;  // Aggiungi Sprite per la frequenza
+
+void drawDisplayLayout();
+// Dal task UI: i valori arrivano dall'istantanea, non dalle variabili del loop
+void updateFrequencyDisplay(unsigned long freq);
+void updateStepDisplay(unsigned long stepHz);
+void drawBFODisplay(bool enabled, unsigned long freq);
+void drawSMeterScale();         // Etichette S1..+60 sotto l'S-meter
+void setupFrequencySprite();    // Nuova funzione per inizializzare Sprite
+uint32_t setupDisplaySprites();  // Dal setup: crea gli sprite, restituisce i byte
+uint32_t displaySpriteBytes8bpp();  // Gli stessi sprite a 8 bpp (confronto)
+
+// Ridisegni della frequenza (comando UI, banco di latenza su PC)
+struct FreqDisplayStats {
+  uint32_t updates;             // Frequenze con almeno una cella cambiata
+  uint32_t cells;               // Celle ridisegnate
+  uint32_t pixels;              // Pixel inviati al display
+};
+extern FreqDisplayStats freqDisplayStats;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "display_dma.h"
+#include "config.h"
+#include <esp_attr.h>
+
+extern TFT_eSPI tft;
+
+DisplayDmaStats displayDmaStats = {0, 0, 0, 0};
+
+struct SpriteWindow {
+  TFT_eSprite* sprite;
+  int16_t tx, ty;
+  int16_t sx, sy, sw, sh;
+  uint16_t fg, bg;
+};
+
+static SpriteWindow dmaQueue[DISPLAY_DMA_QUEUE];
+static uint8_t dmaQueued = 0;
+static bool dmaEnabled = false;
+static bool dmaOpen = false;        // Transazione SPI aperta, forse con DMA in volo
+
+// Due strisce RGB565 in DRAM interna (raggiungibile dal DMA), byte già nell'ordine
+// del display: pushImageDMA() non le deve scambiare
+DMA_ATTR static uint16_t dmaStrip[2][DISPLAY_DMA_STRIP_PIXELS];
+static uint8_t dmaNextStrip = 0;
+
+bool setupDisplayDMA() {
+#if DISPLAY_DMA
+  dmaEnabled = tft.initDMA();
+#endif
+  return dmaEnabled;
+}
+
+// Colore RGB565 di un pixel: tavolozza a 4 bpp, fg/bg a 1 bpp
+static inline uint16_t spritePixel(TFT_eSprite& s, uint8_t bpp, int32_t x, int32_t y,
+                                   uint16_t fg, uint16_t bg) {
+  if (bpp == 4) return s.getPaletteColor(s.readPixelValue(x, y));
+  if (bpp == 1) return s.readPixelValue(x, y) ? fg : bg;
+  return s.readPixel(x, y);
+}
+
+// Una finestra a strisce di righe intere, alternando i due buffer
+static void sendWindow(const SpriteWindow& w) {
+  uint8_t bpp = w.sprite->getColorDepth();
+  int16_t rows = DISPLAY_DMA_STRIP_PIXELS / w.sw;
+
+  for (int16_t y = 0; y < w.sh; y += rows) {
+    int16_t h = min(rows, (int16_t)(w.sh - y));
+
+    // Il buffer in volo è l'altro: questo è libero dal trasferimento precedente
+    uint16_t* p = dmaStrip[dmaNextStrip];
+    for (int16_t r = 0; r < h; r++) {
+      for (int16_t x = 0; x < w.sw; x++) {
+        uint16_t c = spritePixel(*w.sprite, bpp, w.sx + x, w.sy + y + r, w.fg, w.bg);
+        *p++ = (c >> 8) | (c << 8);
+      }
+    }
+
+    // Attende la striscia precedente (una sola in coda) e parte subito
+    tft.pushImageDMA(w.tx, w.ty + y, w.sw, h, dmaStrip[dmaNextStrip]);
+    dmaNextStrip ^= 1;
+    displayDmaStats.strips++;
+  }
+  displayDmaStats.windows++;
+  displayDmaStats.pixels += (uint32_t)w.sw * w.sh;
+}
+
+void pushSpriteDMA(TFT_eSprite& sprite, int32_t tx, int32_t ty,
+                   int32_t sx, int32_t sy, int32_t sw, int32_t sh,
+                   uint16_t fg, uint16_t bg) {
+  if (sw <= 0 || sh <= 0) return;
+
+  // Senza DMA, o finestra più larga di una striscia: invio diretto
+  if (!dmaEnabled || sw > DISPLAY_DMA_STRIP_PIXELS) {
+    displayFence();
+    sprite.pushSprite(tx, ty, sx, sy, sw, sh);
+    return;
+  }
+
+  // Coda piena: si svuota subito, senza lasciare niente in volo
+  if (dmaQueued == DISPLAY_DMA_QUEUE) {
+    flushDisplay();
+    displayFence();
+  }
+  dmaQueue[dmaQueued++] = {&sprite, (int16_t)tx, (int16_t)ty, (int16_t)sx, (int16_t)sy,
+                           (int16_t)sw, (int16_t)sh, fg, bg};
+}
+
+void flushDisplay() {
+  if (dmaQueued == 0) return;
+  if (!dmaOpen) {
+    tft.startWrite();
+    dmaOpen = true;
+  }
+  for (uint8_t i = 0; i < dmaQueued; i++) sendWindow(dmaQueue[i]);
+  dmaQueued = 0;
+}
+
+void displayFence() {
+  if (!dmaOpen) return;
+  if (tft.dmaBusy()) displayDmaStats.fenceWaits++;
+  tft.dmaWait();
+  tft.endWrite();
+  dmaOpen = false;
+}
+
+bool displayBusy() {
+  return dmaOpen && tft.dmaBusy();
+}
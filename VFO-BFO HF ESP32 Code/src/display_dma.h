@@ -0,0 +1,33 @@
+#ifndef DISPLAY_DMA_H
+#define DISPLAY_DMA_H
+
+#include <TFT_eSPI.h>
+
+// Invio degli sprite al display in DMA, solo dal task UI. Durante il
+// fotogramma pushSpriteDMA() mette in coda le finestre; flushDisplay(), a fine
+// fotogramma, le espande da 1/4 bpp in RGB565 a strisce su due buffer alterni:
+// mentre il DMA trasmette una striscia la CPU prepara la successiva.
+// L'ultima striscia resta in volo dopo il fotogramma: displayFence() la
+// attende e chiude la transazione SPI, e va chiamata prima di ogni disegno
+// diretto su tft (il task UI lo fa a inizio fotogramma). Uno sprite in coda si
+// può ridisegnare appena flushDisplay() ritorna: i suoi pixel sono già nelle
+// strisce.
+
+struct DisplayDmaStats {
+  uint32_t windows;         // Finestre di sprite inviate
+  uint32_t strips;          // Trasferimenti DMA
+  uint32_t pixels;
+  uint32_t fenceWaits;      // Recinti che hanno trovato il DMA ancora in corso
+};
+extern DisplayDmaStats displayDmaStats;
+
+bool setupDisplayDMA();     // Dal setup, dopo tft.init(): false = invio diretto
+// Finestra sx,sy,sw,sh dello sprite in tx,ty; fg/bg: colori degli sprite a 1 bpp
+void pushSpriteDMA(TFT_eSprite& sprite, int32_t tx, int32_t ty,
+                   int32_t sx, int32_t sy, int32_t sw, int32_t sh,
+                   uint16_t fg = TFT_WHITE, uint16_t bg = TFT_BLACK);
+void flushDisplay();        // Fine fotogramma: la coda parte in DMA
+void displayFence();        // Attende l'ultimo trasferimento
+bool displayBusy();         // DMA ancora in corso
+
+#endif
@@ -2,32 +2,30 @@
 #include "config.h"
 #include "DigiOUT.h"
 #include "display.h"
+#include "text_format.h"
 #include "EEPROM_manager.h"
+#include "radio_state.h"
 #include <TFT_eSPI.h>
 
 extern TFT_eSPI tft;
 
 // Variabili AGC
 bool agcFastMode = true;
-bool AGCButtonPressed = false;
-unsigned long lastAGCButtonPress = 0;
 
 // Variabili ATT
 bool attenuatorEnabled = false;
-bool ATTButtonPressed = false;
-unsigned long lastATTButtonPress = 0;
 
 
-// Funzioni per gestione AGC
+// Funzioni per gestione AGC (PCF8574 e display dal commit dello stato)
 void changeAGC() {
-  agcFastMode = !agcFastMode;
+  radioState.setAGC(!agcFastMode);
 }
 
-void updateAGC() {
-  updateModeOutputs(); // Aggiorna PCF8574
-}
+void updateAGCDisplay(bool fast) {
+  static TextCache<BOX_TEXT_SIZE> shownAGC;
+  const char* agcText = fast ? "FAST" : "SLOW";
+  if (!shownAGC.update(agcText)) return;
 
-void updateAGCDisplay() {
   // Calcola la posizione del riquadro AGC (terzo riquadro)
   int boxX = POSITION_X + 2 * (BOX_WIDTH + BOX_SPACING);
   int boxWidth = BOX_WIDTH;
@@ -35,54 +33,28 @@ void updateAGCDisplay() {
   // Pulisci l'area del testo
   tft.fillRect(boxX + 5, POSITION_Y + 18, boxWidth - 10, 15, BACKGROUND_COLOR);
   
-  tft.setTextColor(agcFastMode ? TFT_GREEN : TFT_YELLOW, BACKGROUND_COLOR);
+  tft.setTextColor(fast ? TFT_GREEN : TFT_YELLOW, BACKGROUND_COLOR);
   tft.setTextSize(2);
   
-  String agcText = agcFastMode ? "FAST" : "SLOW";
-  
   // Calcola la posizione X centrata approssimativa
-  int textWidth = agcText.length() * 12;
+  int textWidth = strlen(agcText) * 12;
   int centeredX = boxX + (boxWidth - textWidth) / 2;
   
   // Disegna il testo centrato
   tft.drawString(agcText, centeredX, POSITION_Y + 18);
 }
 
-void checkAGCButton() {
- static bool lastAGCState = HIGH; // Assume inizialmente non premuto
-  
-  bool currentState = digitalRead(SW_AGC);
-  
-  // Se passa da HIGH a LOW (fronti di discesa)
-  if (currentState == LOW && lastAGCState == HIGH) {
-    if (millis() - lastAGCButtonPress > buttonDebounce) {
-      AGCButtonPressed = true;
-      changeAGC();
-      lastAGCButtonPress = millis();
-      updateAGC();
-      updateAGCDisplay();
-    }
-  }
-  
-  lastAGCState = currentState;
-  
-  // Reset dello stato pressed quando il pulsante viene rilasciato
-  if (currentState == HIGH && AGCButtonPressed) {
-    AGCButtonPressed = false;
-  }
-}
-
 
-// Funzioni per gestione ATT
+// Funzioni per gestione ATT (PCF8574 e display dal commit dello stato)
 void changeATT() {
-  attenuatorEnabled = !attenuatorEnabled;
+  radioState.setATT(!attenuatorEnabled);
 }
 
-void updateATT() {
-  updateModeOutputs(); // Aggiorna PCF8574
-}
+void updateATTDisplay(bool enabled) {
+  static TextCache<BOX_TEXT_SIZE> shownATT;
+  const char* attText = enabled ? "-20dB" : "0dB";
+  if (!shownATT.update(attText)) return;
 
-void updateATTDisplay() {
   // Calcola la posizione del riquadro ATT (quarto riquadro)
   int boxX = POSITION_X + 3 * (BOX_WIDTH + BOX_SPACING);
   int boxWidth = BOX_WIDTH;
@@ -90,40 +62,14 @@ void updateATTDisplay() {
   // Pulisci l'area del testo
   tft.fillRect(boxX + 5, POSITION_Y + 18, boxWidth - 10, 15, BACKGROUND_COLOR);
   
-  tft.setTextColor(attenuatorEnabled ? TFT_RED : TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextColor(enabled ? TFT_RED : TFT_WHITE, BACKGROUND_COLOR);
   tft.setTextSize(2);
   
-  String attText = attenuatorEnabled ? "-20dB" : "0dB";
-  
   // Calcola la posizione X centrata approssimativa
   // Per testo size 2: circa 12 pixel per carattere
-  int textWidth = attText.length() * 12;
+  int textWidth = strlen(attText) * 12;
   int centeredX = boxX + (boxWidth - textWidth) / 2;
   
   // Disegna il testo centrato
   tft.drawString(attText, centeredX, POSITION_Y + 18);
-}
-
-void checkATTButton() {
-  static bool lastATTState = HIGH; // Assume inizialmente non premuto
-  
-  bool currentState = digitalRead(SW_ATT);
-  
-  // Se passa da HIGH a LOW (fronti di discesa)
-  if (currentState == LOW && lastATTState == HIGH) {
-    if (millis() - lastATTButtonPress > buttonDebounce) {
-      ATTButtonPressed = true;
-      changeATT();
-      lastATTButtonPress = millis();
-      updateATT();
-      updateATTDisplay();
-    }
-  }
-  
-  lastATTState = currentState;
-  
-  // Reset dello stato pressed quando il pulsante viene rilasciato
-  if (currentState == HIGH && ATTButtonPressed) {
-    ATTButtonPressed = false;
-  }
 }
\ No newline at end of file
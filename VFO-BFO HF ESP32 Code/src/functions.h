@@ -1,29 +1,16 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H
 
-
 // Stati AGC e ATT
 extern bool agcFastMode;
 extern bool attenuatorEnabled;
 
-// Variabili debounce
-extern bool AGCButtonPressed;
-extern bool ATTButtonPressed;
-extern unsigned long lastAGCButtonPress;
-extern unsigned long lastATTButtonPress;
-
 // Funzioni AGC
 void changeAGC();
-void updateAGC();
-void updateAGCDisplay();
+void updateAGCDisplay(bool fast);        // Dal task UI
 
 // Funzioni ATT
 void changeATT();
-void updateATT();
-void updateATTDisplay();
-
-// Funzioni di gestione (per il main loop)
-void checkAGCButton();
-void checkATTButton();
+void updateATTDisplay(bool enabled);     // Dal task UI
 
 #endif
\ No newline at end of file
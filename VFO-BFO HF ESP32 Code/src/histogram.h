@@ -0,0 +1,54 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Istogramma a bucket logaritmici: il bucket b contiene i valori tra 2^(b-1) e 2^b - 1
+// (bucket 0 = valore 0). Usato per latenze in µs o cicli CPU.
+#define HISTOGRAM_BUCKETS 24
+
+struct LatencyHistogram {
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        count = 0;
+        max = 0;
+    }
+
+    static uint8_t bucketOf(uint32_t value) {
+        uint8_t b = value ? 32 - __builtin_clz(value) : 0;
+        return b < HISTOGRAM_BUCKETS ? b : HISTOGRAM_BUCKETS - 1;
+    }
+
+    // Limite superiore del bucket
+    static uint32_t bucketLimit(uint8_t b) {
+        return b ? (uint32_t)((1ULL << b) - 1) : 0;
+    }
+
+    void add(uint32_t value) {
+        buckets[bucketOf(value)]++;
+        count++;
+        if (value > max) max = value;
+    }
+
+    // Percentile (0-100) approssimato al limite superiore del bucket
+    uint32_t percentile(uint8_t p) const {
+        if (count == 0) return 0;
+        uint32_t target = ((uint64_t)count * p + 99) / 100;
+        uint32_t seen = 0;
+        for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            seen += buckets[b];
+            if (seen >= target) {
+                uint32_t limit = bucketLimit(b);
+                return limit < max ? limit : max;
+            }
+        }
+        return max;
+    }
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "input_events.h"
+#include "config.h"
+#include "spsc_ring.h"
+#include <Arduino.h>
+
+// Un solo produttore: tutti i pin passano dall'unico gestore degli interrupt
+// GPIO, sullo stesso core, e le ISR non si interrompono a vicenda.
+static SpscRing<InputEvent, INPUT_EVENT_QUEUE> inputRing;
+
+// Argomento dell'ISR: (sorgente << 8) | pin, niente tabelle da leggere nell'ISR
+#define INPUT_ARG(source, pin) ((void*)(uintptr_t)(((source) << 8) | (pin)))
+
+static void IRAM_ATTR buttonISR(void* arg) {
+  uint32_t value = (uint32_t)(uintptr_t)arg;
+  InputEvent event;
+  event.us = micros();
+  event.source = value >> 8;
+  event.level = digitalRead(value & 0xFF);
+  inputRing.push(event);
+}
+
+// Encoder: stato di entrambi i pin a ogni fronte di uno dei due
+#if !VFO_ENC_PCNT
+static void IRAM_ATTR vfoEncoderISR() {
+  InputEvent event;
+  event.us = micros();
+  event.source = INPUT_ENC_VFO;
+  event.level = (digitalRead(VFO_ENC_CLK) << 1) | digitalRead(VFO_ENC_DT);
+  inputRing.push(event);
+}
+#endif
+
+#if !BFO_ENC_PCNT
+static void IRAM_ATTR bfoEncoderISR() {
+  InputEvent event;
+  event.us = micros();
+  event.source = INPUT_ENC_BFO;
+  event.level = (digitalRead(BFO_ENC_CLK) << 1) | digitalRead(BFO_ENC_DT);
+  inputRing.push(event);
+}
+#endif
+
+static void attachButton(uint8_t source, uint8_t pin) {
+  attachInterruptArg(digitalPinToInterrupt(pin), buttonISR, INPUT_ARG(source, pin), CHANGE);
+}
+
+// SW_RTTY_CW (GPIO36) resta letto dal loop: su GPIO36/39 l'ADC dell'S-meter
+// genera interrupt spuri (errata ESP32 3.11)
+void setupInputEvents() {
+  attachButton(INPUT_SW_STEP, SW_STEP);
+  attachButton(INPUT_SW_BAND, SW_BAND);
+  attachButton(INPUT_SW_MODE, SW_MODE);
+  attachButton(INPUT_SW_AGC, SW_AGC);
+  attachButton(INPUT_SW_ATT, SW_ATT);
+  attachButton(INPUT_SW_SCAN, SW_SCAN);
+
+#if !VFO_ENC_PCNT
+  attachInterrupt(digitalPinToInterrupt(VFO_ENC_CLK), vfoEncoderISR, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(VFO_ENC_DT), vfoEncoderISR, CHANGE);
+#endif
+#if !BFO_ENC_PCNT
+  attachInterrupt(digitalPinToInterrupt(BFO_ENC_CLK), bfoEncoderISR, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BFO_ENC_DT), bfoEncoderISR, CHANGE);
+#endif
+}
+
+bool takeInputEvent(InputEvent& event) {
+  return inputRing.pop(event);
+}
+
+uint32_t inputEventsDropped() {
+  return inputRing.dropped();
+}
+
+uint32_t inputEventsHighWater() {
+  return inputRing.highWater();
+}
@@ -0,0 +1,33 @@
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <stdint.h>
+
+// Pulsanti ed encoder letti a interrupt: ogni cambio di livello diventa un
+// evento con il tempo in µs, messo in coda dall'ISR e smaltito dal loop.
+// Una pressione durante un ridisegno lungo non si perde più: arriva dopo,
+// con il tempo giusto per il debounce.
+
+enum InputSource : uint8_t {
+  INPUT_SW_STEP,
+  INPUT_SW_BAND,
+  INPUT_SW_MODE,
+  INPUT_SW_AGC,
+  INPUT_SW_ATT,
+  INPUT_SW_SCAN,
+  INPUT_ENC_VFO,              // Solo senza PCNT (VFO_ENC_PCNT 0)
+  INPUT_ENC_BFO               // Solo senza PCNT (BFO_ENC_PCNT 0)
+};
+
+struct InputEvent {
+  uint32_t us;                // micros() nell'ISR
+  uint8_t source;             // InputSource
+  uint8_t level;              // Pulsante: livello del pin; encoder: (CLK << 1) | DT
+};
+
+void setupInputEvents();                // Interrupt sui pin, dopo setupEncoders()
+bool takeInputEvent(InputEvent& event); // Prossimo evento in coda, false se vuota
+uint32_t inputEventsDropped();          // Eventi persi a coda piena
+uint32_t inputEventsHighWater();        // Occupazione massima della coda
+
+#endif
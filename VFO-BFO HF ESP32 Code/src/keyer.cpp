@@ -0,0 +1,98 @@
+#include "keyer.h"
+
+// ITA2 lettere A-Z (bit 0 = primo bit trasmesso)
+static const uint8_t baudotLetters[26] = {
+  0x03, 0x19, 0x0E, 0x09, 0x01, 0x0D, 0x1A, 0x14, 0x06, 0x0B, 0x0F, 0x12, 0x1C,
+  0x0C, 0x18, 0x16, 0x17, 0x0A, 0x05, 0x10, 0x07, 0x1E, 0x13, 0x1D, 0x15, 0x11
+};
+
+// ITA2 cifre e punteggiatura (registro FIGS)
+struct BaudotFigure {
+  char c;
+  uint8_t code;
+};
+
+static const BaudotFigure baudotFigures[] = {
+  {'1', 0x17}, {'2', 0x13}, {'3', 0x01}, {'4', 0x0A}, {'5', 0x10},
+  {'6', 0x15}, {'7', 0x07}, {'8', 0x06}, {'9', 0x18}, {'0', 0x16},
+  {'-', 0x03}, {'?', 0x19}, {':', 0x0E}, {'(', 0x0F}, {')', 0x12},
+  {'.', 0x1C}, {',', 0x0C}, {'/', 0x1D}, {'+', 0x11}, {'=', 0x1E}
+};
+
+#define BAUDOT_SPACE 0x04
+#define BAUDOT_CR    0x08
+#define BAUDOT_LF    0x02
+
+uint8_t baudotEncode(char c, bool& figures, uint8_t codes[3]) {
+  if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+
+  // Spazio, CR e LF valgono in entrambi i registri
+  if (c == ' ') {
+    codes[0] = BAUDOT_SPACE;
+    return 1;
+  }
+  if (c == '\r' || c == '\n') {
+    codes[0] = BAUDOT_CR;
+    codes[1] = BAUDOT_LF;
+    return 2;
+  }
+
+  uint8_t n = 0;
+  if (c >= 'A' && c <= 'Z') {
+    if (figures) {
+      codes[n++] = BAUDOT_LTRS;
+      figures = false;
+    }
+    codes[n++] = baudotLetters[c - 'A'];
+    return n;
+  }
+
+  for (const BaudotFigure& figure : baudotFigures) {
+    if (figure.c != c) continue;
+    if (!figures) {
+      codes[n++] = BAUDOT_FIGS;
+      figures = true;
+    }
+    codes[n++] = figure.code;
+    return n;
+  }
+  return 0;
+}
+
+void RttySequencer::reset() {
+  head.store(0);
+  tail.store(0);
+  halfBit = RTTY_HALF_BITS_PER_CHAR;
+}
+
+bool RttySequencer::push(uint8_t code) {
+  uint8_t h = head.load(std::memory_order_relaxed);
+  uint8_t next = (h + 1) & (KEYER_QUEUE_SIZE - 1);
+  if (next == tail.load(std::memory_order_acquire)) return false;
+
+  queue[h] = code;
+  head.store(next, std::memory_order_release);
+  return true;
+}
+
+uint8_t RttySequencer::pending() const {
+  return (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed)) & (KEYER_QUEUE_SIZE - 1);
+}
+
+uint8_t IRAM_ATTR RttySequencer::levelAt(uint8_t code, uint8_t halfBit) {
+  if (halfBit < 2) return KEY_SPACE;                        // Start
+  if (halfBit < 12) return (code >> ((halfBit - 2) / 2)) & 1; // Dati
+  return KEY_MARK;                                          // Stop 1.5 bit
+}
+
+uint8_t IRAM_ATTR RttySequencer::tick() {
+  if (halfBit >= RTTY_HALF_BITS_PER_CHAR) {
+    uint8_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return KEY_MARK;   // A riposo
+
+    code = queue[t];
+    tail.store((t + 1) & (KEYER_QUEUE_SIZE - 1), std::memory_order_release);
+    halfBit = 0;
+  }
+  return levelAt(code, halfBit++);
+}
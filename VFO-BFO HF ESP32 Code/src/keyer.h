@@ -0,0 +1,70 @@
+#ifndef KEYER_H
+#define KEYER_H
+
+#include <stdint.h>
+#include <atomic>
+#include "config.h"
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#elif !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif
+
+// Manipolazione FSK/CW su CLK2: sequenza dei simboli RTTY (ITA2) a mezzi bit.
+// Il timer hardware chiama tick() a ogni mezzo bit; nel percorso temporizzato
+// non c'è calcolo di sintesi, solo la scelta tra due immagini già pronte.
+// Senza dipendenze Arduino: compila anche su host (src/tools/keyer_sim.cpp).
+
+#define KEY_SPACE 0                 // RTTY space / CW tasto alzato
+#define KEY_MARK  1                 // RTTY mark / CW tasto abbassato
+
+enum KeyerMode : uint8_t {
+  KEYER_OFF = 0,
+  KEYER_CW,
+  KEYER_RTTY,
+  KEYER_WSPR                        // Beacon: solo da comando seriale
+};
+
+#define KEYER_LEVELS 4              // Immagini pronte: 2 per RTTY/CW, 4 toni WSPR
+
+// Codici ITA2 di servizio
+#define BAUDOT_LTRS 0x1F
+#define BAUDOT_FIGS 0x1B
+
+// Carattere RTTY: start 1 bit (space), 5 bit dati LSB per primo, stop 1.5 bit (mark)
+#define RTTY_HALF_BITS_PER_CHAR 15
+#define KEYER_QUEUE_SIZE 64         // Codici in attesa (potenza di 2)
+
+// Mezzo bit in tick del timer hardware, arrotondato
+constexpr uint32_t rttyHalfBitTicks() {
+  return (uint32_t)(((uint64_t)KEYER_TIMER_HZ * 100 + RTTY_BAUD_X100) / (2ULL * RTTY_BAUD_X100));
+}
+
+// Converte un carattere in codici ITA2, inserendo LTRS/FIGS quando serve.
+// Ritorna il numero di codici scritti in codes (0 = carattere non trasmissibile).
+uint8_t baudotEncode(char c, bool& figures, uint8_t codes[3]);
+
+class RttySequencer {
+public:
+  void reset();
+
+  // Lato loop: accoda un codice ITA2, false se la coda è piena
+  bool push(uint8_t code);
+  uint8_t pending() const;
+
+  // Lato ISR: livello del prossimo mezzo bit (mark a riposo)
+  uint8_t IRAM_ATTR tick();
+
+  // Livello dentro un carattere al mezzo bit halfBit (0..14)
+  static uint8_t IRAM_ATTR levelAt(uint8_t code, uint8_t halfBit);
+
+private:
+  uint8_t queue[KEYER_QUEUE_SIZE] = {};
+  std::atomic<uint8_t> head{0};     // Scritto dal loop
+  std::atomic<uint8_t> tail{0};     // Scritto dall'ISR
+  uint8_t code = 0;
+  uint8_t halfBit = RTTY_HALF_BITS_PER_CHAR;  // = a riposo
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Casella "vince l'ultimo" tra un produttore (loop) e un consumatore (task radio).
+// Più richieste arrivate prima del consumo collassano nell'ultima: il consumatore
+// vede sempre il valore più recente, mai uno vecchio.
+// Senza lock e senza dipendenze Arduino: compila anche su host.
+template <typename T>
+class LatestMailbox {
+    static_assert(sizeof(T) <= sizeof(uint32_t), "LatestMailbox: valore oltre 32 bit");
+
+public:
+    // Pubblica un nuovo valore (sovrascrive quello non ancora letto)
+    void post(T value) {
+        slot.store(value, std::memory_order_relaxed);
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    // Legge il valore più recente se ce n'è uno nuovo dall'ultima lettura
+    bool take(T& value) {
+        uint32_t seq = sequence.load(std::memory_order_acquire);
+        if (seq == seen) return false;
+        seen = seq;
+        value = slot.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    // Numero totale di pubblicazioni
+    uint32_t posted() const { return sequence.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<T> slot{};
+    std::atomic<uint32_t> sequence{0};
+    uint32_t seen = 0;      // Solo lato consumatore
+};
+
+#endif
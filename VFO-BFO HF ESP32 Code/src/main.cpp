@@ -1,290 +1,569 @@
-#include <Arduino.h>
-#include "config.h"
-#include "display.h"
-#include "VFO_BFO.h"
-#include "PLL.h"
-#include "bands.h"
-#include "modes.h"
-#include "s_meter.h"
-#include "DigiOUT.h" 
-#include "functions.h"
-#include "EEPROM_manager.h"
-
-void handleSerialCommands();
-void calibrateSI5351(long calibration_factor); // Dichiarazione
-
-// Variabile per calibrazione - AGGIUNGI
-int32_t currentCalibration = 0;
-
-// Variabili globali
-unsigned long vfoFrequency = 7000000 + IF_FREQUENCY;
-unsigned long displayedFrequency = 7000000;
-unsigned long step = 1000;
-unsigned long minFreq = 1000000;
-unsigned long maxFreq = 30000000;
-
-// Variabili per debounce
-unsigned long lastEncoderRead = 0;
-const int encoderReadInterval = 10;
-unsigned long lastButtonPress = 0;
-unsigned long lastBandButtonPress = 0;
-unsigned long lastModeButtonPress = 0;
-
-bool buttonPressed = false;
-bool bandButtonPressed = false;
-bool modeButtonPressed = false;
-
-// Variabili encoder
-int lastEncoded = 0;
-int encoderCount = 0;
-
-// Funzione per gestire comandi seriali
-void handleSerialCommands() {
-    if (Serial.available() > 0) {
-        String command = Serial.readStringUntil('\n');
-        command.trim();
-        
-        if (command.startsWith("CAL ")) {
-            // Comando: CAL <valore>
-            String valueStr = command.substring(4);
-            long calValue = valueStr.toInt();
-            
-            calibrateSI5351(calValue);
-            eepromManager.saveCalibration(calValue);
-            currentCalibration = calValue;
-            
-            Serial.print("Calibrazione applicata e salvata: ");
-            Serial.println(calValue);
-            
-        } else if (command == "CAL_READ") {
-            // Legge calibrazione corrente
-            Serial.print("Calibrazione corrente: ");
-            Serial.println(currentCalibration);
-            
-        } else if (command == "CAL_RESET") {
-            // Resetta calibrazione
-            calibrateSI5351(0);
-            eepromManager.saveCalibration(0);
-            currentCalibration = 0;
-            Serial.println("Calibrazione resettata a 0");
-            
-        } else if (command == "HELP") {
-            // Mostra aiuto
-            Serial.println("Comandi calibrazione SI5351:");
-            Serial.println("CAL <valore>  - Imposta calibrazione (es: CAL 1250)");
-            Serial.println("CAL_READ      - Legge calibrazione corrente");
-            Serial.println("CAL_RESET     - Resetta calibrazione a 0");
-            Serial.println("HELP          - Mostra questo aiuto");
-            Serial.println("INFO          - Informazioni sistema");
-            
-        } else if (command == "INFO") {
-            // Informazioni sistema
-            Serial.println("=== VFO-BFO Receiver ===");
-            Serial.print("Frequenza: ");
-            Serial.print(displayedFrequency);
-            Serial.println(" Hz");
-            Serial.print("Modalità: ");
-            Serial.println(modeNames[currentMode]);
-            Serial.print("Step: ");
-            Serial.println(step);
-            Serial.print("Calibrazione SI5351: ");
-            Serial.println(currentCalibration);
-            Serial.print("BFO: ");
-            Serial.println(bfoEnabled ? "ON" : "OFF");
-            if (bfoEnabled) {
-                Serial.print("Frequenza BFO: ");
-                Serial.println(bfoFrequency);
-            }
-        }
-    }
-}
-
-void setup() {
-  Serial.begin(115200);
-  delay(1000);
-
-/*   //**********************************************************
-  // // === DIAGNOSTICA I2C ===
-  Serial.println("\n=== DIAGNOSTICA I2C ===");
-  Wire.begin(I2C_SDA, I2C_SCL);
-  Wire.setClock(100000); // 100kHz
-  delay(100);
-  
-  // Scansiona tutto il bus I2C
-  byte error, address;
-  int nDevices = 0;
-  
-  Serial.println("Scansione bus I2C...");
-  for(address = 1; address < 127; address++) {
-    Wire.beginTransmission(address);
-    error = Wire.endTransmission();
-    
-    if (error == 0) {
-      Serial.print("Dispositivo trovato all'indirizzo 0x");
-      if (address < 16) Serial.print("0");
-      Serial.print(address, HEX);
-      
-      // Identifica i dispositivi
-      if (address == 0x60) Serial.println(" -> SI5351");
-      else if (address == 0x20) Serial.println(" -> PCF8574A");
-      else if (address == 0x50) Serial.println(" -> EEPROM 24LC32");
-      else Serial.println(" -> Sconosciuto");
-      
-      nDevices++;
-    }
-  }
-  
-  if (nDevices == 0) {
-    Serial.println("Nessun dispositivo I2C trovato!");
-  } else {
-    Serial.print("Totale dispositivi trovati: ");
-    Serial.println(nDevices);
-  }
-  Serial.println("=== FINE DIAGNOSTICA ===\n");
-  //********************************************************** */
-
-  // Configurazione encoder VFO con pull-up interni 
-  pinMode(VFO_ENC_CLK, INPUT_PULLUP);
-  pinMode(VFO_ENC_DT, INPUT_PULLUP);
-  pinMode(SW_STEP, INPUT_PULLUP);
-
-  // Configurazione I2C con pull-up interni 
-  // pinMode(I2C_SDA, INPUT_PULLUP);
-  // pinMode(I2C_SCL, INPUT_PULLUP);
-
-  // Configura encoder pitch BFO con pull-up interni 
-  pinMode(BFO_ENC_CLK, INPUT_PULLUP);
-  pinMode(BFO_ENC_DT, INPUT_PULLUP);
-
-  // Configura pulsanti con pull-up interni 
-  pinMode(SW_AGC, INPUT_PULLUP);
-  pinMode(SW_ATT, INPUT_PULLUP);
-  pinMode(SW_BAND, INPUT_PULLUP);
-  pinMode(SW_MODE, INPUT_PULLUP);
-  pinMode(SW_SCAN, INPUT_PULLUP);
-
-  // Inizializza I2C con clock ridotto PRIMA di tutto
-  Wire.begin(I2C_SDA, I2C_SCL);
-  Wire.setClock(400000); //  400kHz
-
-  // Inizializza display
-  tft.init();
-  tft.setRotation(1);
-  tft.fillScreen(BACKGROUND_COLOR);
-
-  // Inizializza EEPROM e carica configurazione
-  eepromManager.begin();
-  eepromManager.loadRXState();
-
-  long savedCalibration = 0;
-  if (eepromManager.loadCalibration(savedCalibration)) {
-      calibrateSI5351(savedCalibration);
-  }
-  // Calcola vfoFrequency
-  vfoFrequency = displayedFrequency + IF_FREQUENCY;
-
-  // Inizializza encoder
-  setupEncoders();
-  
-  // Inizializza DigiOUT
-  setupDigiOUT();
-
-  // Inizializza SI5351
-  setupSI5351();
-
-  // Disegna layout del display
-  drawDisplayLayout(); 
-
-  // Aggiorna tutti i display
-  updateFrequencyDisplay();
-  updateFrequency();
-  updateStepDisplay();
-  updateModeInfo();
-  updateModeOutputs();
-  updateBandInfo();
-  updateAGCDisplay();
-  updateATTDisplay();
-
-  // Informazioni per calibrazione via seriale
-  Serial.println("VFO-BFO Ready - Invio 'HELP' per comandi calibrazione");
-}
-
-void loop() {
-  readVFOEncoder();
-
-  // Gestione Pitch BFO
-  static int lastBFOOffset = 0;
-  updateBFOFromEncoder();
-  
-  if (currentBFOOffset != lastBFOOffset) {
-    drawBFODisplay();
-    lastBFOOffset = currentBFOOffset;
-  }
-
-  // Gestione comandi seriali
-  handleSerialCommands();
-
-  // Gestione pulsante step
-  if (digitalRead(SW_STEP) == LOW && !buttonPressed) {
-    if (millis() - lastButtonPress > buttonDebounce) {
-      buttonPressed = true;
-      changeStep();
-      lastButtonPress = millis();
-      updateStepDisplay();
-      eepromManager.requestQuickSave();
-      delay(300);
-    }
-  }  
-  if (digitalRead(SW_STEP) == HIGH && buttonPressed) {
-    buttonPressed = false;
-  }
-
-  // Gestione pulsante banda
-  if (digitalRead(SW_BAND) == LOW && !bandButtonPressed) {
-    if (millis() - lastBandButtonPress > buttonDebounce) {
-      bandButtonPressed = true;
-      changeBand();
-      lastBandButtonPress = millis();
-      updateFrequency();
-      updateFrequencyDisplay();
-      updateBandInfo();
-      eepromManager.requestQuickSave();
-      delay(300);
-    }
-  } 
-  if (digitalRead(SW_BAND) == HIGH && bandButtonPressed) {
-    bandButtonPressed = false;
-  }
-
-  // Gestione pulsante modalità
-  if (digitalRead(SW_MODE) == LOW && !modeButtonPressed) {
-    if (millis() - lastModeButtonPress > buttonDebounce) {
-      modeButtonPressed = true;
-      changeMode();
-      lastModeButtonPress = millis();
-      updateModeOutputs();
-      updateModeInfo();
-      eepromManager.requestQuickSave();
-      delay(300);
-    }
-  } 
-  if (digitalRead(SW_MODE) == HIGH && modeButtonPressed) {
-    modeButtonPressed = false;
-  }
-
-  // Gestione pulsante AGC
-  checkAGCButton();
-
-  // Gestione pulsante ATT
-  checkATTButton();
-
-  // Aggiorna S-meter ogni 50ms
-  static unsigned long lastSMeterUpdate = 0;
-  if (millis() - lastSMeterUpdate > 50) {
-    updateSMeter();
-    lastSMeterUpdate = millis();
-  }
-
-  // Gestione salvataggio EEPROM
-  eepromManager.update();
-}
\ No newline at end of file
+#include <Arduino.h>
+#include "config.h"
+#include "display.h"
+#include "display_dma.h"
+#include "VFO_BFO.h"
+#include "PLL.h"
+#include "bands.h"
+#include "modes.h"
+#include "s_meter.h"
+#include "DigiOUT.h" 
+#include "functions.h"
+#include "EEPROM_manager.h"
+#include "radio_task.h"
+#include "rtty_cw.h"
+#include "keyer.h"
+#include "sweep.h"
+#include "cal_auto.h"
+#include "input_events.h"
+#include "button.h"
+#include "scheduler.h"
+#include "ui_task.h"
+#include "profiler.h"
+#include "alloc_counter.h"
+#include "radio_state.h"
+
+void handleSerialCommands();
+void handleInputEvents();
+void setupScheduler();
+void printTaskStats();
+void calibrateSI5351(long calibration_factor); // Dichiarazione
+
+// Variabile per calibrazione - AGGIUNGI
+int32_t currentCalibration = 0;
+
+// Variabili globali
+unsigned long vfoFrequency = 7000000 + IF_FREQUENCY;
+unsigned long displayedFrequency = 7000000;
+unsigned long step = 1000;
+unsigned long minFreq = 1000000;
+unsigned long maxFreq = 30000000;
+
+// Pulsanti a interrupt, indicizzati con InputSource (INPUT_SW_STEP..INPUT_SW_SCAN)
+#define BUTTON_COUNT (INPUT_SW_SCAN + 1)
+static Button buttons[BUTTON_COUNT];
+
+// Scheduler del loop: tabella dei task in fondo al file
+static Scheduler loopScheduler;
+
+// Funzione per gestire comandi seriali
+void handleSerialCommands() {
+    if (Serial.available() > 0) {
+        AllocExempt serialAllocs;   // Righe di comando in String: fuori dal conteggio
+        String command = Serial.readStringUntil('\n');
+        command.trim();
+        
+        if (command.startsWith("CAL ")) {
+            // Comando: CAL <valore>
+            String valueStr = command.substring(4);
+            long calValue = valueStr.toInt();
+            
+            calibrateSI5351(calValue);
+            eepromManager.saveCalibration(calValue);
+            currentCalibration = calValue;
+            
+            Serial.print("Calibrazione applicata e salvata: ");
+            Serial.println(calValue);
+            
+        } else if (command.startsWith("CAL_AUTO")) {
+            // Comando: CAL_AUTO <Hz portante di riferimento>, CAL_AUTO STOP interrompe
+            String arg = command.substring(8);
+            arg.trim();
+            if (arg == "STOP") {
+                stopAutoCalibration();
+            } else if (startAutoCalibration(arg.toInt())) {
+                Serial.print("CAL_AUTO: ricerca della portante a ");
+                Serial.print(arg.toInt());
+                Serial.println(" Hz");
+            } else {
+                Serial.println("CAL_AUTO: frequenza non valida o ricerca in corso (es: CAL_AUTO 10000000)");
+            }
+
+        } else if (command == "CAL_READ") {
+            // Legge calibrazione corrente
+            Serial.print("Calibrazione corrente: ");
+            Serial.println(currentCalibration);
+            
+        } else if (command == "CAL_RESET") {
+            // Resetta calibrazione
+            calibrateSI5351(0);
+            eepromManager.saveCalibration(0);
+            currentCalibration = 0;
+            Serial.println("Calibrazione resettata a 0");
+            
+        } else if (command == "GLIDE") {
+            // Attiva/disattiva la sintonia glide del VFO
+            vfoGlideMode.store(!vfoGlideMode.load());
+            updateFrequency();
+            Serial.print("Sintonia glide: ");
+            Serial.println(vfoGlideMode.load() ? "ON" : "OFF");
+
+        } else if (command == "RADIO") {
+            // Statistiche del task radio
+            printRadioStats();
+
+        } else if (command == "CACHE") {
+            // Successi/fallimenti della cache immagini registri
+            Serial.print("Cache immagini SI5351 - hit: ");
+            Serial.print(synthCache.hits);
+            Serial.print(", miss: ");
+            Serial.print(synthCache.misses);
+            Serial.print(", voci: ");
+            Serial.println(synthCache.size());
+
+        } else if (command == "TASKS") {
+            // Statistiche dei task del loop
+            printTaskStats();
+
+        } else if (command == "TASKS_RESET") {
+            loopScheduler.resetStats();
+            Serial.println("Statistiche task del loop azzerate");
+
+        } else if (command == "STATE") {
+            // Cambi di stato e consumatori eseguiti dal commit
+            radioState.printStats();
+
+        } else if (command == "STATE_RESET") {
+            radioState.resetStats();
+            Serial.println("Statistiche stato radio azzerate");
+
+        } else if (command == "PERF") {
+            // Tempi del loop e delle sezioni (cicli CPU)
+            printPerfStats();
+
+        } else if (command == "PERF_RESET") {
+            resetPerfStats();
+            Serial.println("Statistiche profilatore azzerate");
+
+        } else if (command == "UI") {
+            // Statistiche del task UI
+            printUiStats();
+
+        } else if (command == "UI_RESET") {
+            resetUiStats();
+            Serial.println("Statistiche task UI azzerate");
+
+        } else if (command == "ALLOC") {
+            // Allocazioni di heap per scatto dell'encoder
+            printAllocStats();
+
+        } else if (command == "ALLOC_RESET") {
+            resetAllocStats();
+            Serial.println("Statistiche allocazioni azzerate");
+
+        } else if (command == "RADIO_RESET") {
+            resetRadioStats();
+            Serial.println("Statistiche task radio azzerate");
+
+        } else if (command == "KEYER") {
+            // Manipolazione CLK2: OFF -> CW -> RTTY, come il pulsante
+            setKeyerMode((getKeyerMode() + 1) % 3);
+            Serial.print("Manipolazione CLK2: ");
+            Serial.println(keyerModeName(getKeyerMode()));
+
+        } else if (command.startsWith("RTTY ")) {
+            // Comando: RTTY <testo>
+            if (getKeyerMode() != KEYER_RTTY) setKeyerMode(KEYER_RTTY);
+            String text = command.substring(5);
+            int accepted = sendRTTY(text);
+            Serial.print("RTTY in coda: ");
+            Serial.print(accepted);
+            Serial.print("/");
+            Serial.println(text.length());
+
+        } else if (command.startsWith("WSPR ")) {
+            // Comando: WSPR <nominativo> <locatore> <dBm>
+            String args = command.substring(5);
+            args.trim();
+            int first = args.indexOf(' ');
+            int second = args.indexOf(' ', first + 1);
+            String call = args.substring(0, first);
+            String locator = args.substring(first + 1, second);
+            long dBm = args.substring(second + 1).toInt();
+
+            if (first > 0 && second > first && startWSPR(call.c_str(), locator.c_str(), dBm)) {
+                Serial.print("WSPR in trasmissione su ");
+                Serial.print(displayedFrequency + WSPR_AUDIO_OFFSET);
+                Serial.println(" Hz (162 simboli, circa 110 s)");
+            } else {
+                Serial.println("WSPR: messaggio non valido (es: WSPR IZ0ABC JN61 10)");
+            }
+
+        } else if (command == "SWEEP OFF") {
+            closeSweepPlot();
+
+        } else if (command == "SWEEP" || command.startsWith("SWEEP ")) {
+            // Comando: SWEEP [<inizio> <fine> [punti] [attesa_us]], senza argomenti attorno alla IF
+            uint32_t start = IF_FREQUENCY - SWEEP_SPAN / 2;
+            uint32_t stop = IF_FREQUENCY + SWEEP_SPAN / 2;
+            long points = SWEEP_MAX_POINTS;
+            long settle = SWEEP_SETTLE_US;
+
+            if (command.length() > 6) {
+                String args = command.substring(6);
+                args.trim();
+                int first = args.indexOf(' ');
+                int second = first > 0 ? args.indexOf(' ', first + 1) : -1;
+                int third = second > 0 ? args.indexOf(' ', second + 1) : -1;
+                start = args.substring(0, first).toInt();
+                stop = args.substring(first + 1, second > 0 ? second : args.length()).toInt();
+                if (second > 0) points = args.substring(second + 1, third > 0 ? third : args.length()).toInt();
+                if (third > 0) settle = args.substring(third + 1).toInt();
+                if (first <= 0) stop = 0;
+            }
+
+            if (settle >= 0 && settle <= 65535 && points > 0 && points <= SWEEP_MAX_POINTS &&
+                startSweep(start, stop, points, settle)) {
+                Serial.print("SWEEP CLK2 ");
+                Serial.print(start);
+                Serial.print(" - ");
+                Serial.print(stop);
+                Serial.print(" Hz, ");
+                Serial.print(points);
+                Serial.println(" punti");
+            } else {
+                Serial.println("SWEEP: parametri non validi (es: SWEEP 445000 465000 500 200)");
+            }
+
+        } else if (command == "HELP") {
+            // Mostra aiuto
+            Serial.println("Comandi calibrazione SI5351:");
+            Serial.println("CAL <valore>  - Imposta calibrazione (es: CAL 1250)");
+            Serial.println("CAL_READ      - Legge calibrazione corrente");
+            Serial.println("CAL_RESET     - Resetta calibrazione a 0");
+            Serial.println("CAL_AUTO <Hz> - Calibrazione automatica su una portante nota (CAL_AUTO STOP)");
+            Serial.println("GLIDE         - Attiva/disattiva sintonia glide VFO");
+            Serial.println("RADIO         - Statistiche task radio (RADIO_RESET per azzerare)");
+            Serial.println("TASKS         - Task del loop: sforamenti e ritardi (TASKS_RESET per azzerare)");
+            Serial.println("STATE         - Cambi di stato e scritture eseguite (STATE_RESET per azzerare)");
+            Serial.println("PERF          - Tempi del loop per sezione: p50, p99, max (PERF_RESET per azzerare)");
+            Serial.println("UI            - Task UI: fotogrammi e tempi di disegno (UI_RESET per azzerare)");
+            Serial.println("ALLOC         - Allocazioni di heap per scatto encoder (ALLOC_RESET per azzerare)");
+            Serial.println("CACHE         - Hit/miss cache immagini registri");
+            Serial.println("KEYER         - Manipolazione CLK2: OFF -> CW -> RTTY");
+            Serial.println("RTTY <testo>  - Trasmette testo RTTY 45.45 baud su CLK2");
+            Serial.println("WSPR <nominativo> <locatore> <dBm> - Beacon WSPR su CLK2");
+            Serial.println("SWEEP [inizio fine [punti] [attesa_us]] - Sweep CLK2 con rivelatore ADC");
+            Serial.println("SWEEP OFF     - Chiude il grafico dello sweep");
+            Serial.println("HELP          - Mostra questo aiuto");
+            Serial.println("INFO          - Informazioni sistema");
+            
+        } else if (command == "INFO") {
+            // Informazioni sistema
+            Serial.println("=== VFO-BFO Receiver ===");
+            Serial.print("Frequenza: ");
+            Serial.print(displayedFrequency);
+            Serial.println(" Hz");
+            Serial.print("Modalità: ");
+            Serial.println(modeNames[currentMode]);
+            Serial.print("Step: ");
+            Serial.println(step);
+            Serial.print("Calibrazione SI5351: ");
+            Serial.println(currentCalibration);
+            Serial.print("BFO: ");
+            Serial.println(bfoEnabled ? "ON" : "OFF");
+            if (bfoEnabled) {
+                Serial.print("Frequenza BFO: ");
+                Serial.println(bfoFrequency);
+            }
+            Serial.print("Sintonia glide: ");
+            Serial.println(vfoGlideMode.load() ? "ON" : "OFF");
+            Serial.print("I2C SI5351: ");
+            Serial.print(si5351Shadow.transactions);
+            Serial.print(" transazioni, ");
+            Serial.print(si5351Shadow.bytesSent);
+            Serial.print(" byte (ultimo aggiornamento: ");
+            Serial.print(si5351Shadow.lastTransactions);
+            Serial.print("/");
+            Serial.print(si5351Shadow.lastBytes);
+            Serial.println(")");
+            Serial.print("Eventi ingresso: max in coda ");
+            Serial.print(inputEventsHighWater());
+            Serial.print(", persi ");
+            Serial.println(inputEventsDropped());
+        }
+    }
+}
+
+// Azione di un pulsante: click avanti; all'indietro con la pressione lunga
+// (step, banda con ripetizione) o con il doppio click (modalità).
+// Si5351, uscite, display e salvataggio li esegue il commit a fine giro
+static void handleButtonAction(uint8_t source, ButtonAction action) {
+  if (action == BUTTON_NONE) return;
+  bool reverse = action != BUTTON_CLICK;
+
+  switch (source) {
+    case INPUT_SW_STEP:
+      changeStep(reverse);
+      break;
+    case INPUT_SW_BAND:
+      changeBand(reverse);
+      break;
+    case INPUT_SW_MODE:
+      changeMode(reverse);
+      break;
+    case INPUT_SW_AGC:
+      changeAGC();
+      break;
+    case INPUT_SW_ATT:
+      changeATT();
+      break;
+    default:
+      break;      // Scan non ancora implementato
+  }
+}
+
+static void setupButtons() {
+  const ButtonTiming clickOnly = {BUTTON_DEBOUNCE_US, 0, 0, 0};
+  const ButtonTiming longPress = {BUTTON_DEBOUNCE_US, BUTTON_LONG_US, 0, 0};
+  const ButtonTiming longRepeat = {BUTTON_DEBOUNCE_US, BUTTON_LONG_US, BUTTON_REPEAT_US, 0};
+  const ButtonTiming doubleClick = {BUTTON_DEBOUNCE_US, 0, 0, BUTTON_DOUBLE_US};
+
+  buttons[INPUT_SW_STEP].begin(longPress);
+  buttons[INPUT_SW_BAND].begin(longRepeat);
+  buttons[INPUT_SW_MODE].begin(doubleClick);
+  buttons[INPUT_SW_AGC].begin(clickOnly);
+  buttons[INPUT_SW_ATT].begin(clickOnly);
+  buttons[INPUT_SW_SCAN].begin(clickOnly);
+}
+
+// Smaltisce la coda degli eventi di ingresso, nell'ordine in cui sono arrivati
+void handleInputEvents() {
+  InputEvent event;
+  while (takeInputEvent(event)) {
+    switch (event.source) {
+      case INPUT_ENC_VFO: vfoEncoderEdge(event.level, event.us); break;
+      case INPUT_ENC_BFO: bfoEncoderEdge(event.level, event.us); break;
+      default:
+        if (event.source < BUTTON_COUNT) {
+          handleButtonAction(event.source, buttons[event.source].edge(event.level == LOW, event.us));
+        }
+        break;
+    }
+  }
+
+  // Pressione lunga, ripetizione, fine del doppio click e rilasci rapidi
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) handleButtonAction(i, buttons[i].poll(now));
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+/*   //**********************************************************
+  // // === DIAGNOSTICA I2C ===
+  Serial.println("\n=== DIAGNOSTICA I2C ===");
+  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.setClock(100000); // 100kHz
+  delay(100);
+  
+  // Scansiona tutto il bus I2C
+  byte error, address;
+  int nDevices = 0;
+  
+  Serial.println("Scansione bus I2C...");
+  for(address = 1; address < 127; address++) {
+    Wire.beginTransmission(address);
+    error = Wire.endTransmission();
+    
+    if (error == 0) {
+      Serial.print("Dispositivo trovato all'indirizzo 0x");
+      if (address < 16) Serial.print("0");
+      Serial.print(address, HEX);
+      
+      // Identifica i dispositivi
+      if (address == 0x60) Serial.println(" -> SI5351");
+      else if (address == 0x20) Serial.println(" -> PCF8574A");
+      else if (address == 0x50) Serial.println(" -> EEPROM 24LC32");
+      else Serial.println(" -> Sconosciuto");
+      
+      nDevices++;
+    }
+  }
+  
+  if (nDevices == 0) {
+    Serial.println("Nessun dispositivo I2C trovato!");
+  } else {
+    Serial.print("Totale dispositivi trovati: ");
+    Serial.println(nDevices);
+  }
+  Serial.println("=== FINE DIAGNOSTICA ===\n");
+  //********************************************************** */
+
+  // Configurazione encoder VFO con pull-up interni 
+  pinMode(VFO_ENC_CLK, INPUT_PULLUP);
+  pinMode(VFO_ENC_DT, INPUT_PULLUP);
+  pinMode(SW_STEP, INPUT_PULLUP);
+
+  // Configurazione I2C con pull-up interni 
+  // pinMode(I2C_SDA, INPUT_PULLUP);
+  // pinMode(I2C_SCL, INPUT_PULLUP);
+
+  // Configura encoder pitch BFO con pull-up interni 
+  pinMode(BFO_ENC_CLK, INPUT_PULLUP);
+  pinMode(BFO_ENC_DT, INPUT_PULLUP);
+
+  // Configura pulsanti con pull-up interni 
+  pinMode(SW_AGC, INPUT_PULLUP);
+  pinMode(SW_ATT, INPUT_PULLUP);
+  pinMode(SW_BAND, INPUT_PULLUP);
+  pinMode(SW_MODE, INPUT_PULLUP);
+  pinMode(SW_SCAN, INPUT_PULLUP);
+
+  // Inizializza I2C con clock ridotto PRIMA di tutto
+  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.setClock(400000); //  400kHz
+
+  // Inizializza display (da qui lo disegna solo il task UI)
+  tft.init();
+  tft.setRotation(1);
+  tft.fillScreen(BACKGROUND_COLOR);
+  Serial.println(setupDisplayDMA() ? "Display: sprite in DMA" : "Display: DMA non disponibile, invio diretto");
+
+  // Sprite a 1 e 4 bpp: heap prima e dopo, e quanto costerebbero a 8 bpp
+  uint32_t heapBefore = ESP.getFreeHeap();
+  uint32_t spriteBytes = setupDisplaySprites();
+  Serial.print("Heap libero: ");
+  Serial.print(heapBefore);
+  Serial.print(" -> ");
+  Serial.print(ESP.getFreeHeap());
+  Serial.print(" byte, sprite display: ");
+  Serial.print(spriteBytes);
+  Serial.print(" byte (a 8 bpp: ");
+  Serial.print(displaySpriteBytes8bpp());
+  Serial.println(")");
+  if (spriteBytes == 0) Serial.println("ERRORE: sprite del display non allocati");
+
+  // Inizializza EEPROM e carica configurazione
+  eepromManager.begin();
+  eepromManager.loadRXState();
+
+  long savedCalibration = 0;
+  if (eepromManager.loadCalibration(savedCalibration)) {
+      calibrateSI5351(savedCalibration);
+  }
+  // Calcola vfoFrequency
+  vfoFrequency = displayedFrequency + IF_FREQUENCY;
+
+  // Inizializza encoder e interrupt di pulsanti ed encoder
+  setupEncoders();
+  setupButtons();
+  setupInputEvents();
+  
+  // Inizializza DigiOUT
+  setupDigiOUT();
+
+  // Inizializza SI5351 e avvia il task radio che ne diventa proprietario
+  setupSI5351();
+  setupRadioTask();
+  setupKeyer();
+
+  // Stato caricato dalla EEPROM: tutto da applicare, niente da salvare
+  radioState.mark(DIRTY_ALL & ~(DIRTY_SAVE | DIRTY_QUICK_SAVE));
+  radioState.commit();
+
+  // Layout e primo fotogramma dal task UI, sull'altro core
+  setupUiTask();
+
+  // Da qui il loop è lo scheduler dei task
+  setupScheduler();
+
+  // Informazioni per calibrazione via seriale
+  Serial.println("VFO-BFO Ready - Invio 'HELP' per comandi calibrazione");
+
+  // Avvio finito: da qui le allocazioni di heap si contano (comando ALLOC)
+  resetAllocStats();
+}
+
+// ==================== TASK DEL LOOP ====================
+
+// Pulsanti, encoder VFO ed encoder pitch: il più urgente
+static void inputTask() {
+  PerfScope perf(PERF_INPUT);
+  handleInputEvents();
+  {
+    PerfScope encoder(PERF_VFO_ENCODER);
+    readVFOEncoder();
+  }
+  updateBFOFromEncoder();
+}
+
+// Manipolazione RTTY/CW su CLK2
+static void keyerTask() {
+  PerfScope perf(PERF_KEYER);
+  checkKeyerButton();
+  updateKeyer();
+}
+
+// Sweep (grafico e invio binario a fine misura) e calibrazione automatica
+static void measureTask() {
+  PerfScope perf(PERF_MEASURE);
+  updateSweep();
+  updateAutoCalibration();
+}
+
+// S-meter sospeso durante lo sweep e con il grafico visibile
+static void sMeterTask() {
+  if (sweepActive()) return;
+  PerfScope perf(PERF_SMETER_READ);
+  radioState.setSMeter(readSMeter());
+}
+
+static void serialTask() {
+  PerfScope perf(PERF_SERIAL);
+  handleSerialCommands();
+}
+
+// Salvataggio EEPROM: una pagina per esecuzione
+static void eepromTask() {
+  PerfScope perf(PERF_EEPROM);
+  eepromManager.update();
+}
+
+// {nome, funzione, periodo us, deadline us, priorità}
+static SchedTask loopTasks[] = {
+  {"input", inputTask, 1000, 20000, 0},
+  {"keyer", keyerTask, 5000, 10000, 1},
+  {"misure", measureTask, 5000, 20000, 2},
+  {"s-meter", sMeterTask, 50000, 100000, 3},
+  {"seriale", serialTask, 20000, 100000, 4},
+  {"eeprom", eepromTask, EEPROM_WRITE_CYCLE_MS * 1000, 50000, 5}
+};
+
+static uint32_t schedulerClock() {
+  return micros();
+}
+
+void setupScheduler() {
+  loopScheduler.begin(loopTasks, sizeof(loopTasks) / sizeof(loopTasks[0]), schedulerClock);
+}
+
+void printTaskStats() {
+  Serial.println("=== Task del loop ===");
+  for (uint8_t i = 0; i < loopScheduler.size(); i++) {
+    const SchedTask& t = loopScheduler.task(i);
+    Serial.print(t.name);
+    Serial.print(": esecuzioni ");
+    Serial.print(t.runs);
+    Serial.print(", sforamenti ");
+    Serial.print(t.overruns);
+    Serial.print(", saltati ");
+    Serial.print(t.skipped);
+    Serial.print(", ritardo max ");
+    Serial.print(t.maxLateUs);
+    Serial.print(" us, durata max ");
+    Serial.print(t.maxRunUs);
+    Serial.println(" us");
+  }
+}
+
+void loop() {
+  PerfScope perf(PERF_LOOP);
+  if (loopScheduler.runOnce() == nullptr) {
+    perf.cancel();        // Giro a vuoto
+    return;
+  }
+  // Effetti dei cambi del task appena eseguito: ogni consumatore al più una volta
+  radioState.commit();
+}
@@ -1,93 +1,85 @@
-#include "modes.h"
-#include "config.h"
-#include "PLL.h"
-#include "display.h"
-#include <Arduino.h>
-#include <TFT_eSPI.h>
-
-extern TFT_eSPI tft;
-
-const char* modeNames[] = {"AM", "LSB", "USB", "CW"};
-int currentMode = MODE_AM;
-
-// Cambia alla modalità successiva
-void changeMode() {
-  currentMode = (currentMode + 1) % MODE_COUNT;
-  updateBFOForMode();
-}
-
-// Aggiorna BFO in base alla modalità selezionata
-void updateBFOForMode() {
-  // Salva l'offset corrente per la modalità uscente
-  if (bfoEnabled) {
-    switch(currentMode) {
-      case MODE_LSB:
-        bfoPitchOffset[0] = currentBFOOffset;
-        break;
-      case MODE_USB:
-        bfoPitchOffset[1] = currentBFOOffset;
-        break;
-      case MODE_CW:
-        bfoPitchOffset[2] = currentBFOOffset;
-        break;
-    }
-  }
-  
-  // Applica la nuova modalità
-  switch(currentMode) {
-    case MODE_AM:
-      disableBFO();
-      break;
-    case MODE_LSB:
-      currentBFOOffset = 0;  // ⬅️ RESET A ZERO
-      bfoFrequency = BFO_LSB_BASE + currentBFOOffset;
-      enableBFO();
-      break;
-    case MODE_USB:
-      currentBFOOffset = 0;  // ⬅️ RESET A ZERO
-      bfoFrequency = BFO_USB_BASE + currentBFOOffset;
-      enableBFO();
-      break;
-    case MODE_CW:
-      currentBFOOffset = 0;  // ⬅️ RESET A ZERO
-      bfoFrequency = BFO_CW_BASE + currentBFOOffset;
-      enableBFO();
-      break;
-  }
-  updateBFO();
-  
-}
-
-// Aggiorna visualizzazione della modalità
-void updateModeInfo() {
-  static int lastMode = -1;
-  static bool lastBFOState = false;
-  static int lastBFOOffset = 0;
-  
-  if (currentMode != lastMode || bfoEnabled != lastBFOState || currentBFOOffset != lastBFOOffset) {
-    // Calcola la posizione del riquadro MODE (secondo riquadro)
-    int boxX = POSITION_X + (BOX_WIDTH + BOX_SPACING);
-    int boxWidth = BOX_WIDTH;
-    
-    // Pulisci l'area del testo
-    tft.fillRect(boxX + 5, 218, boxWidth - 10, 15, BACKGROUND_COLOR);
-    
-    tft.setTextColor(MODE_COLOR, BACKGROUND_COLOR);
-    tft.setTextSize(2);
-    
-    String modeText = modeNames[currentMode];
-    
-    // Calcola la posizione X centrata approssimativa
-    int textWidth = modeText.length() * 12;
-    int centeredX = boxX + (boxWidth - textWidth) / 2;
-    
-    // Disegna il testo centrato
-    tft.drawString(modeText, centeredX, 218);
-    
-    lastMode = currentMode;
-    lastBFOState = bfoEnabled;
-    lastBFOOffset = currentBFOOffset;
-  }
-  
-  drawBFODisplay();
+#include "modes.h"
+#include "config.h"
+#include "PLL.h"
+#include "display.h"
+#include "radio_state.h"
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+extern TFT_eSPI tft;
+
+const char* modeNames[] = {"AM", "LSB", "USB", "CW"};
+int currentMode = MODE_AM;
+
+// Cambia alla modalità successiva, o alla precedente con reverse
+void changeMode(bool reverse) {
+  radioState.setMode((currentMode + (reverse ? MODE_COUNT - 1 : 1)) % MODE_COUNT);
+  radioState.requestSave(true);
+  updateBFOForMode();
+}
+
+// Aggiorna BFO in base alla modalità selezionata
+void updateBFOForMode() {
+  // Salva l'offset corrente per la modalità uscente
+  if (bfoEnabled) {
+    switch(currentMode) {
+      case MODE_LSB:
+        bfoPitchOffset[0] = currentBFOOffset;
+        break;
+      case MODE_USB:
+        bfoPitchOffset[1] = currentBFOOffset;
+        break;
+      case MODE_CW:
+        bfoPitchOffset[2] = currentBFOOffset;
+        break;
+    }
+  }
+  
+  // Applica la nuova modalità
+  switch(currentMode) {
+    case MODE_AM:
+      disableBFO();
+      break;
+    case MODE_LSB:
+      currentBFOOffset = 0;  // ⬅️ RESET A ZERO
+      radioState.setBFO(true, BFO_LSB_BASE + currentBFOOffset, true);
+      break;
+    case MODE_USB:
+      currentBFOOffset = 0;  // ⬅️ RESET A ZERO
+      radioState.setBFO(true, BFO_USB_BASE + currentBFOOffset, true);
+      break;
+    case MODE_CW:
+      currentBFOOffset = 0;  // ⬅️ RESET A ZERO
+      radioState.setBFO(true, BFO_CW_BASE + currentBFOOffset, true);
+      break;
+  }
+  // Si5351, PCF8574 e display li aggiorna una volta sola il commit del loop
+}
+
+// Aggiorna visualizzazione della modalità (il BFO lo disegna il task UI a parte)
+void updateModeInfo(int mode) {
+  static int lastMode = -1;
+  
+  if (mode != lastMode) {
+    // Calcola la posizione del riquadro MODE (secondo riquadro)
+    int boxX = POSITION_X + (BOX_WIDTH + BOX_SPACING);
+    int boxWidth = BOX_WIDTH;
+    
+    // Pulisci l'area del testo
+    tft.fillRect(boxX + 5, 218, boxWidth - 10, 15, BACKGROUND_COLOR);
+    
+    tft.setTextColor(MODE_COLOR, BACKGROUND_COLOR);
+    tft.setTextSize(2);
+    
+    const char* modeText = modeNames[mode];
+    
+    // Calcola la posizione X centrata approssimativa
+    int textWidth = strlen(modeText) * 12;
+    int centeredX = boxX + (boxWidth - textWidth) / 2;
+    
+    // Disegna il testo centrato
+    tft.drawString(modeText, centeredX, 218);
+    
+    lastMode = mode;
+  }
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "pcnt_encoder.h"
+
+// Il contatore torna a 0 quando raggiunge un limite: le differenze si
+// calcolano modulo PCNT_LIMIT, basta leggere prima di mezzo giro del contatore
+#define PCNT_LIMIT 30000
+
+bool PcntEncoder::begin(pcnt_unit_t pcntUnit, uint8_t pinA, uint8_t pinB, uint16_t filterCycles) {
+  unit = pcntUnit;
+
+  // Canale 0: fronti di A, B come direzione
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = pinA;
+  config.ctrl_gpio_num = pinB;
+  config.channel = PCNT_CHANNEL_0;
+  config.unit = unit;
+  config.pos_mode = PCNT_COUNT_DEC;
+  config.neg_mode = PCNT_COUNT_INC;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.lctrl_mode = PCNT_MODE_REVERSE;
+  config.counter_h_lim = PCNT_LIMIT;
+  config.counter_l_lim = -PCNT_LIMIT;
+  if (pcnt_unit_config(&config) != ESP_OK) return false;
+
+  // Canale 1: fronti di B, A come direzione (stesso verso di conteggio)
+  config.pulse_gpio_num = pinB;
+  config.ctrl_gpio_num = pinA;
+  config.channel = PCNT_CHANNEL_1;
+  config.pos_mode = PCNT_COUNT_INC;
+  config.neg_mode = PCNT_COUNT_DEC;
+  if (pcnt_unit_config(&config) != ESP_OK) return false;
+
+  // Filtro: impulsi più corti di filterCycles cicli APB (80MHz, max 1023) ignorati
+  pcnt_set_filter_value(unit, filterCycles > 1023 ? 1023 : filterCycles);
+  pcnt_filter_enable(unit);
+
+  pcnt_counter_pause(unit);
+  pcnt_counter_clear(unit);
+  pcnt_counter_resume(unit);
+
+  last = 0;
+  ready = true;
+  return true;
+}
+
+int32_t PcntEncoder::readDelta() {
+  if (!ready) return 0;
+
+  int16_t count;
+  if (pcnt_get_counter_value(unit, &count) != ESP_OK) return 0;
+
+  int32_t delta = (int32_t)count - last;
+  if (delta > PCNT_LIMIT / 2) delta -= PCNT_LIMIT;
+  else if (delta < -PCNT_LIMIT / 2) delta += PCNT_LIMIT;
+  last = count;
+  return delta;
+}
@@ -0,0 +1,25 @@
+#ifndef PCNT_ENCODER_H
+#define PCNT_ENCODER_H
+
+#include <Arduino.h>
+#include <driver/pcnt.h>
+
+// Encoder in quadratura sul contatore di impulsi (PCNT) dell'ESP32.
+// Decodifica x4 in hardware (due canali, ognuno conta i fronti di un pin con
+// l'altro come direzione) e filtro dei disturbi brevi: il loop legge solo la
+// differenza dei conteggi, senza attese e senza perdere fronti se è in ritardo.
+// I rimbalzi dei contatti diventano coppie +1/-1 che si annullano.
+
+class PcntEncoder {
+public:
+  // pinA/pinB come CLK/DT: conteggio positivo nello stesso verso della lettura software
+  bool begin(pcnt_unit_t unit, uint8_t pinA, uint8_t pinB, uint16_t filterCycles);
+  int32_t readDelta();          // Conteggi (4 per ciclo) dall'ultima lettura
+
+private:
+  pcnt_unit_t unit = PCNT_UNIT_0;
+  int16_t last = 0;
+  bool ready = false;
+};
+
+#endif
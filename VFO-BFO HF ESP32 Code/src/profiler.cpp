@@ -0,0 +1,88 @@
+#include "profiler.h"
+
+#if PERF_PROFILER
+
+#include "histogram.h"
+#include <atomic>
+
+static const char* const perfNames[PERF_SECTIONS] = {
+  "loop", "input", "encoder VFO", "keyer", "misure", "stato", "lettura S-meter",
+  "seriale", "eeprom", "UI fotogramma", "UI frequenza", "UI BFO", "UI S-meter"
+};
+
+// Scritti solo dal task che misura la sezione
+static LatencyHistogram perfCycles[PERF_SECTIONS];
+static uint64_t perfTotal[PERF_SECTIONS];
+
+// PERF_RESET arriva dal loop, ma le sezioni UI le scrive l'altro core:
+// l'azzeramento lo fa chi misura, alla misura successiva
+static std::atomic<bool> perfResetPending[PERF_SECTIONS];
+static uint32_t perfSince = 0;      // micros() dell'ultimo azzeramento
+
+void perfAdd(uint8_t section, uint32_t cycles) {
+  if (perfResetPending[section].load(std::memory_order_relaxed)) {
+    perfCycles[section].reset();
+    perfTotal[section] = 0;
+    perfResetPending[section].store(false, std::memory_order_relaxed);
+  }
+  perfCycles[section].add(cycles);
+  perfTotal[section] += cycles;
+}
+
+void resetPerfStats() {
+  for (uint8_t s = 0; s < PERF_SECTIONS; s++) perfResetPending[s].store(true);
+  perfSince = micros();
+}
+
+static void printMicros(uint32_t cycles, uint32_t mhz) {
+  Serial.print((float)cycles / mhz, 1);
+  Serial.print(" us");
+}
+
+void printPerfStats() {
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  uint64_t elapsedCycles = (uint64_t)(micros() - perfSince) * mhz;
+
+  Serial.print("=== Profilatore (cicli CPU a ");
+  Serial.print(mhz);
+  Serial.println(" MHz) ===");
+  for (uint8_t s = 0; s < PERF_SECTIONS; s++) {
+    const LatencyHistogram& h = perfCycles[s];
+    if (perfResetPending[s] || h.count == 0) continue;
+    Serial.print(perfNames[s]);
+    Serial.print(": ");
+    Serial.print(h.count);
+    Serial.print(" volte, p50 ");
+    printMicros(h.percentile(50), mhz);
+    Serial.print(", p99 ");
+    printMicros(h.percentile(99), mhz);
+    Serial.print(", max ");
+    printMicros(h.max, mhz);
+    Serial.print(", ");
+    Serial.print(elapsedCycles ? 100.0f * perfTotal[s] / elapsedCycles : 0.0f, 2);
+    Serial.println("% del core");
+  }
+
+  // Distribuzione completa del giro del loop
+  const LatencyHistogram& loop = perfCycles[PERF_LOOP];
+  if (perfResetPending[PERF_LOOP] || loop.count == 0) return;
+  Serial.println("Giro del loop:");
+  for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+    if (loop.buckets[b] == 0) continue;
+    Serial.print("  <= ");
+    printMicros(LatencyHistogram::bucketLimit(b), mhz);
+    Serial.print(": ");
+    Serial.println(loop.buckets[b]);
+  }
+}
+
+#else
+
+void printPerfStats() {
+  Serial.println("Profilatore non compilato (PERF_PROFILER 0 in config.h)");
+}
+
+void resetPerfStats() {
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Profilatore a cicli CPU: ogni sezione ha un istogramma logaritmico dei cicli
+// (histogram.h), il massimo e il tempo totale. Si misura con un oggetto locale:
+//   PerfScope perf(PERF_EEPROM);    // dalla costruzione alla fine del blocco
+// Il contatore dei cicli è per core: una sezione va misurata sempre dallo
+// stesso task (loop sul core 1, task UI sul core 0). Con PERF_PROFILER 0
+// PerfScope è vuoto e il compilatore non lascia niente.
+
+enum PerfSection : uint8_t {
+  PERF_LOOP,                // Giro del loop che ha eseguito un task
+  PERF_INPUT,               // Task input (eventi, encoder)
+  PERF_VFO_ENCODER,         // readVFOEncoder()
+  PERF_KEYER,
+  PERF_MEASURE,             // Sweep e calibrazione automatica
+  PERF_STATE,               // Commit dello stato (radio_state.cpp)
+  PERF_SMETER_READ,         // readSMeter()
+  PERF_SERIAL,
+  PERF_EEPROM,              // eepromManager.update()
+  PERF_UI_FRAME,            // Fotogramma del task UI (core 0)
+  PERF_UI_FREQUENCY,        // updateFrequencyDisplay()
+  PERF_UI_BFO,              // drawBFODisplay()
+  PERF_UI_SMETER,           // drawSMeter()
+  PERF_SECTIONS
+};
+
+void printPerfStats();      // Comando PERF
+void resetPerfStats();      // Comando PERF_RESET
+
+#if PERF_PROFILER
+
+void perfAdd(uint8_t section, uint32_t cycles);
+
+class PerfScope {
+public:
+  explicit PerfScope(uint8_t s) : section(s), start(ESP.getCycleCount()) {}
+  ~PerfScope() { if (section < PERF_SECTIONS) perfAdd(section, ESP.getCycleCount() - start); }
+  void cancel() { section = PERF_SECTIONS; }      // Giro a vuoto: non si conta
+private:
+  uint8_t section;
+  uint32_t start;
+};
+
+#else
+
+class PerfScope {
+public:
+  explicit PerfScope(uint8_t) {}
+  void cancel() {}
+};
+
+#endif
+
+#endif
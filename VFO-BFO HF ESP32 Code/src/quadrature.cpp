@@ -0,0 +1,50 @@
+#include "quadrature.h"
+
+// Avanti: 11 -> 01 -> 00 -> 10 -> 11 (CLK scende con DT alto)
+const int8_t quadratureTable[16] = {
+   0, -1, +1,  0,     // Da 00
+  +1,  0,  0, -1,     // Da 01
+  -1,  0,  0, +1,     // Da 10
+   0, +1, -1,  0      // Da 11
+};
+
+void QuadratureDecoder::begin(uint8_t state, uint8_t statesPerDetent, uint32_t stableUs) {
+  last = state & 3;
+  pending = last;
+  changeUs = 0;
+  steps = 0;
+  perDetent = statesPerDetent ? statesPerDetent : 1;
+  stable = stableUs;
+  invalid = 0;
+}
+
+int8_t QuadratureDecoder::update(uint8_t state, uint32_t nowUs) {
+  state &= 3;
+
+  // Filtro di stabilità: il cambio conta solo se dura almeno stable us
+  if (stable != 0) {
+    if (state != pending) {
+      pending = state;
+      changeUs = nowUs;
+      return 0;
+    }
+    if (nowUs - changeUs < stable) return 0;
+  }
+
+  if (state == last) return 0;
+  int8_t direction = quadratureTable[(last << 2) | state];
+  last = state;
+
+  if (direction == 0) {
+    invalid++;
+    return 0;
+  }
+  return (int8_t)accumulate(direction);
+}
+
+int32_t QuadratureDecoder::accumulate(int32_t delta) {
+  steps += delta;
+  int32_t detents = steps / perDetent;
+  steps -= detents * perDetent;
+  return detents;
+}
@@ -0,0 +1,38 @@
+#ifndef QUADRATURE_H
+#define QUADRATURE_H
+
+#include <stdint.h>
+
+// Decodifica degli encoder in quadratura letti via software, comune a VFO e BFO.
+// Stato = (CLK << 1) | DT. Una tabella di 16 voci indicizzata da
+// (stato precedente << 2) | stato attuale dà +1 / -1 per ogni passo valido e 0
+// per i salti di due stati: un rimbalzo su un contatto diventa +1 -1 e si annulla.
+// Senza dipendenze Arduino: compila anche su host (src/tools/encoder_bench.cpp).
+
+extern const int8_t quadratureTable[16];
+
+class QuadratureDecoder {
+public:
+  // statesPerDetent: passi di quadratura per scatto (1, 2 o 4)
+  // stableUs: un nuovo stato vale solo dopo essere rimasto fermo tanto (0 = subito)
+  void begin(uint8_t state, uint8_t statesPerDetent, uint32_t stableUs = 0);
+
+  // Nuovo campione dei pin: scatti completati (+ avanti, - indietro)
+  int8_t update(uint8_t state, uint32_t nowUs);
+
+  // Passi già decodificati altrove (contatore PCNT): scatti completati
+  int32_t accumulate(int32_t steps);
+
+  uint32_t skipped() const { return invalid; }  // Salti di stato: campionamento troppo lento
+
+private:
+  uint8_t last = 0;
+  uint8_t pending = 0;
+  uint32_t changeUs = 0;
+  int32_t steps = 0;
+  uint8_t perDetent = 2;
+  uint32_t stable = 0;
+  uint32_t invalid = 0;
+};
+
+#endif
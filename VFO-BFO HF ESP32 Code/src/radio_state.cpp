@@ -0,0 +1,123 @@
+#include "radio_state.h"
+#include "config.h"
+#include "radio_task.h"
+#include "bands.h"
+#include "s_meter.h"
+#include "ui_task.h"
+#include "EEPROM_manager.h"
+#include "profiler.h"
+#include <Arduino.h>
+
+RadioState radioState;
+
+// Campi che compaiono sul display
+#define DIRTY_DISPLAY (DIRTY_VFO | DIRTY_BFO | DIRTY_MODE | DIRTY_STEP | DIRTY_AGC | DIRTY_ATT | \
+                       DIRTY_SMETER | DIRTY_SWEEP)
+// Campi che finiscono sul PCF8574 (filtri di banda, modo, AGC, ATT, BFO)
+#define DIRTY_OUTPUTS (DIRTY_VFO | DIRTY_BFO | DIRTY_MODE | DIRTY_AGC | DIRTY_ATT)
+
+void RadioState::setFrequency(unsigned long displayed, bool recall) {
+  if (displayed == displayedFrequency && !recall) return;
+  displayedFrequency = displayed;
+  vfoFrequency = displayed + IF_FREQUENCY;
+  mark(recall ? DIRTY_VFO | DIRTY_VFO_RECALL : DIRTY_VFO);
+}
+
+void RadioState::setBFO(bool enabled, unsigned long freq, bool recall) {
+  if (enabled == bfoEnabled && freq == bfoFrequency && !recall) return;
+  bfoEnabled = enabled;
+  bfoFrequency = freq;
+  mark(recall ? DIRTY_BFO | DIRTY_BFO_RECALL : DIRTY_BFO);
+}
+
+void RadioState::setMode(int mode) {
+  if (mode == currentMode) return;
+  currentMode = mode;
+  mark(DIRTY_MODE);
+}
+
+void RadioState::setStep(unsigned long stepHz) {
+  if (stepHz == step) return;
+  step = stepHz;
+  mark(DIRTY_STEP);
+}
+
+void RadioState::setAGC(bool fast) {
+  if (fast == agcFastMode) return;
+  agcFastMode = fast;
+  mark(DIRTY_AGC);
+}
+
+void RadioState::setATT(bool enabled) {
+  if (enabled == attenuatorEnabled) return;
+  attenuatorEnabled = enabled;
+  mark(DIRTY_ATT);
+}
+
+void RadioState::setSMeter(int value) {
+  if (value == sMeterValue) return;
+  sMeterValue = value;
+  mark(DIRTY_SMETER);
+}
+
+void RadioState::commit() {
+  uint16_t bits = dirty;
+  if (bits == 0) return;
+  dirty = 0;
+  commits++;
+  PerfScope perf(PERF_STATE);
+
+  // 1. Si5351: prima di tutto, è la latenza della sintonia
+  if (bits & DIRTY_VFO) {
+    radioPostVFO(vfoFrequency, bits & DIRTY_VFO_RECALL);
+    vfoPosts++;
+  }
+  if (bits & DIRTY_BFO) {
+    radioPostBFO(bfoEnabled ? bfoFrequency : 0, bits & DIRTY_BFO_RECALL);
+    bfoPosts++;
+  }
+
+  // 2. PCF8574: una sola scrittura per tutti i bit (e nessuna se non cambiano)
+  if (bits & DIRTY_OUTPUTS) {
+    updateBandOutputs();
+    outputUpdates++;
+  }
+
+  // 3. Display: il task UI ridisegna le zone cambiate al prossimo fotogramma
+  if (bits & DIRTY_DISPLAY) {
+    publishRadioState();
+    publishes++;
+  }
+
+  // 4. EEPROM: il salvataggio rapido assorbe quello ritardato
+  if (bits & DIRTY_QUICK_SAVE) {
+    eepromManager.requestQuickSave();
+    saveRequests++;
+  } else if (bits & DIRTY_SAVE) {
+    eepromManager.requestSave();
+    saveRequests++;
+  }
+}
+
+void RadioState::resetStats() {
+  marks = commits = 0;
+  vfoPosts = bfoPosts = outputUpdates = publishes = saveRequests = 0;
+}
+
+void RadioState::printStats() {
+  Serial.println("=== Stato radio ===");
+  Serial.print("Cambi segnati: ");
+  Serial.print(marks);
+  Serial.print(", commit: ");
+  Serial.println(commits);
+  Serial.print("VFO: ");
+  Serial.print(vfoPosts);
+  Serial.print(", BFO: ");
+  Serial.print(bfoPosts);
+  Serial.print(", PCF8574: ");
+  Serial.print(outputUpdates);
+  Serial.print(", display: ");
+  Serial.print(publishes);
+  Serial.print(", salvataggi: ");
+  Serial.println(saveRequests);
+}
@@ -0,0 +1,68 @@
+#ifndef RADIO_STATE_H
+#define RADIO_STATE_H
+
+#include <stdint.h>
+
+// Stato della radio con un bit "sporco" per campo. Chi cambia qualcosa usa i
+// setter (o segna il bit) e basta: gli effetti li esegue commit(), una volta per
+// giro del loop, ognuno al più una volta e sempre nello stesso ordine:
+//   1. Si5351 (caselle del task radio)   2. PCF8574   3. istantanea del display
+//   4. richiesta di salvataggio EEPROM
+// Così uno scatto dell'encoder insieme a un cambio modo nello stesso giro fanno
+// una sola scrittura per dispositivo invece di una per chiamata.
+// I valori restano nelle variabili globali di sempre (config.h), in sola lettura
+// per gli altri moduli. Solo dal loop: i bit non sono atomici.
+
+enum RadioDirty : uint16_t {
+  DIRTY_VFO        = 1 << 0,  // displayedFrequency / vfoFrequency
+  DIRTY_VFO_RECALL = 1 << 1,  // Richiamo (banda, memoria): immagine dalla cache
+  DIRTY_BFO        = 1 << 2,  // bfoEnabled / bfoFrequency
+  DIRTY_BFO_RECALL = 1 << 3,  // Cambio modo: frequenza base dalla cache
+  DIRTY_MODE       = 1 << 4,
+  DIRTY_STEP       = 1 << 5,
+  DIRTY_AGC        = 1 << 6,
+  DIRTY_ATT        = 1 << 7,
+  DIRTY_SMETER     = 1 << 8,
+  DIRTY_SWEEP      = 1 << 9,  // Grafico dello sweep aperto o chiuso
+  DIRTY_SAVE       = 1 << 10, // Salvataggio ritardato (sintonia)
+  DIRTY_QUICK_SAVE = 1 << 11, // Salvataggio rapido (banda, modo, step)
+  DIRTY_ALL        = 0x0FFF
+};
+
+class RadioState {
+public:
+  // Ogni setter segna il bit solo se il valore cambia davvero
+  void setFrequency(unsigned long displayed, bool recall = false);
+  void setBFO(bool enabled, unsigned long freq, bool recall = false);
+  void setMode(int mode);
+  void setStep(unsigned long stepHz);
+  void setAGC(bool fast);
+  void setATT(bool enabled);
+  void setSMeter(int value);
+  void requestSave(bool quick) { mark(quick ? DIRTY_QUICK_SAVE : DIRTY_SAVE); }
+
+  void mark(uint16_t bits) { dirty |= bits; marks++; }
+  uint16_t pending() const { return dirty; }
+
+  // Esegue gli effetti dei campi cambiati e azzera i bit
+  void commit();
+
+  void printStats();          // Comando STATE
+  void resetStats();
+
+private:
+  uint16_t dirty = 0;
+
+  // Statistiche: quante volte ogni consumatore è partito
+  uint32_t marks = 0;         // Cambi segnati dai setter
+  uint32_t commits = 0;       // Commit con qualcosa da fare
+  uint32_t vfoPosts = 0;
+  uint32_t bfoPosts = 0;
+  uint32_t outputUpdates = 0;
+  uint32_t publishes = 0;
+  uint32_t saveRequests = 0;
+};
+
+extern RadioState radioState;
+
+#endif
@@ -0,0 +1,177 @@
+#include "radio_task.h"
+#include "config.h"
+#include "PLL.h"
+#include "mailbox.h"
+#include "histogram.h"
+#include "keyer.h"
+#include "sweep.h"
+#include <Arduino.h>
+
+static TaskHandle_t radioTaskHandle = nullptr;
+
+// Bit di notifica del task
+#define RADIO_NOTIFY_FREQ 0x01      // Nuove frequenze o impostazioni nelle caselle
+#define RADIO_NOTIFY_KEY  0x02      // Fronte di simbolo dal timer di manipolazione
+#define RADIO_NOTIFY_SWEEP 0x04     // Sweep su CLK2 richiesto dal loop
+
+// Caselle frequenza: il task applica solo l'ultimo valore pubblicato
+static LatestMailbox<uint32_t> vfoMailbox;
+static LatestMailbox<uint32_t> bfoMailbox;
+
+// Fattore di calibrazione: solo il task radio lo applica e scrive il chip
+static LatestMailbox<int32_t> calMailbox;
+
+// Richiamo in corso: resta valido anche se la richiesta viene sovrascritta
+static std::atomic<bool> vfoRecall{false};
+static std::atomic<bool> bfoRecall{false};
+
+// Manipolazione CLK2: impostazione (modo + frequenza) e livello chiesto dall'ISR
+static LatestMailbox<uint32_t> keyMailbox;
+static std::atomic<uint8_t> keySetupMode{KEYER_OFF};
+static std::atomic<uint8_t> keySetupIdle{KEY_MARK};
+static std::atomic<uint8_t> keyLevel{KEY_MARK};
+static volatile uint32_t keyEdgeTime = 0;   // micros() del fronte
+static volatile uint32_t keyOverruns = 0;   // Fronti arrivati prima di scrivere il precedente
+static std::atomic<bool> keyPending{false};
+static uint32_t keyEdges = 0;
+static LatencyHistogram keyLatency;         // Fronte del timer -> registri scritti (µs)
+
+// Statistiche
+static volatile uint32_t vfoPostTime = 0;   // micros() dell'ultima pubblicazione VFO
+static uint32_t vfoApplied = 0;             // Scritture VFO effettive
+static uint32_t vfoPostedAtReset = 0;
+static LatencyHistogram vfoLatency;         // Pubblicazione -> registri scritti (µs)
+
+static void radioTask(void*) {
+  for (;;) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+    // Prima la manipolazione: i fronti sono quelli con la scadenza più stretta
+    uint32_t freq;
+    if (keyMailbox.take(freq)) {
+      si5351PrepareKey(keySetupMode.load(), freq, keySetupIdle.load());
+    }
+    if (keyPending.exchange(false)) {
+      si5351ApplyKey(keyLevel.load());
+      keyLatency.add(micros() - keyEdgeTime);
+      keyEdges++;
+    }
+
+    // Poi la calibrazione, che riscrive VFO e BFO correnti con il nuovo riferimento
+    int32_t correction;
+    if (calMailbox.take(correction)) {
+      si5351ApplyCalibration(correction);
+    }
+
+    if (vfoMailbox.take(freq)) {
+      si5351ApplyVFO(freq, vfoRecall.exchange(false));
+      vfoLatency.add(micros() - vfoPostTime);
+      vfoApplied++;
+    }
+    if (bfoMailbox.take(freq)) {
+      si5351ApplyBFO(freq, bfoRecall.exchange(false));
+    }
+
+    // Sweep per ultimo: occupa il task (e il core 1) per tutta la durata,
+    // le caselle si svuotano al giro successivo
+    if (bits & RADIO_NOTIFY_SWEEP) runSweep();
+  }
+}
+
+void setupRadioTask() {
+  vfoLatency.reset();
+  keyLatency.reset();
+  xTaskCreatePinnedToCore(radioTask, "radio", RADIO_TASK_STACK, nullptr,
+                          RADIO_TASK_PRIORITY, &radioTaskHandle, RADIO_TASK_CORE);
+
+  // Applica subito quanto pubblicato prima dell'avvio del task
+  xTaskNotify(radioTaskHandle, RADIO_NOTIFY_FREQ, eSetBits);
+}
+
+void radioPostVFO(uint32_t freq, bool recall) {
+  if (recall) vfoRecall.store(true);
+  vfoPostTime = micros();
+  vfoMailbox.post(freq);
+  if (radioTaskHandle != nullptr) xTaskNotify(radioTaskHandle, RADIO_NOTIFY_FREQ, eSetBits);
+}
+
+void radioPostBFO(uint32_t freq, bool recall) {
+  if (recall) bfoRecall.store(true);
+  bfoMailbox.post(freq);
+  if (radioTaskHandle != nullptr) xTaskNotify(radioTaskHandle, RADIO_NOTIFY_FREQ, eSetBits);
+}
+
+void radioPostCalibration(int32_t correction) {
+  calMailbox.post(correction);
+  if (radioTaskHandle != nullptr) xTaskNotify(radioTaskHandle, RADIO_NOTIFY_FREQ, eSetBits);
+}
+
+void radioPostKeySetup(uint8_t mode, uint32_t freq, uint8_t idle) {
+  keySetupMode.store(mode);
+  keySetupIdle.store(idle);
+  keyMailbox.post(mode == KEYER_OFF ? 0 : freq);
+  if (radioTaskHandle != nullptr) xTaskNotify(radioTaskHandle, RADIO_NOTIFY_FREQ, eSetBits);
+}
+
+void radioPostSweep() {
+  if (radioTaskHandle != nullptr) xTaskNotify(radioTaskHandle, RADIO_NOTIFY_SWEEP, eSetBits);
+}
+
+void IRAM_ATTR radioKeyFromISR(uint8_t level) {
+  if (radioTaskHandle == nullptr) return;
+  if (keyPending.exchange(true)) keyOverruns = keyOverruns + 1;
+
+  keyLevel.store(level);
+  keyEdgeTime = micros();
+
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(radioTaskHandle, RADIO_NOTIFY_KEY, eSetBits, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void resetRadioStats() {
+  vfoLatency.reset();
+  vfoApplied = 0;
+  vfoPostedAtReset = vfoMailbox.posted();
+  keyLatency.reset();
+  keyEdges = 0;
+  keyOverruns = 0;
+}
+
+void printRadioStats() {
+  uint32_t posted = vfoMailbox.posted() - vfoPostedAtReset;
+
+  Serial.println("=== Task radio ===");
+  Serial.print("VFO richieste: ");
+  Serial.print(posted);
+  Serial.print(", scritture: ");
+  Serial.println(vfoApplied);
+
+  Serial.print("Latenza (us) p50: ");
+  Serial.print(vfoLatency.percentile(50));
+  Serial.print(" p99: ");
+  Serial.print(vfoLatency.percentile(99));
+  Serial.print(" max: ");
+  Serial.println(vfoLatency.max);
+
+  for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+    if (vfoLatency.buckets[b] == 0) continue;
+    Serial.print("  <= ");
+    Serial.print(LatencyHistogram::bucketLimit(b));
+    Serial.print(" us: ");
+    Serial.println(vfoLatency.buckets[b]);
+  }
+
+  if (keyEdges == 0) return;
+  Serial.print("Manipolazione fronti: ");
+  Serial.print(keyEdges);
+  Serial.print(", persi: ");
+  Serial.println(keyOverruns);
+  Serial.print("Ritardo fronte (us) p50: ");
+  Serial.print(keyLatency.percentile(50));
+  Serial.print(" p99: ");
+  Serial.print(keyLatency.percentile(99));
+  Serial.print(" max: ");
+  Serial.println(keyLatency.max);
+}
@@ -0,0 +1,27 @@
+#ifndef RADIO_TASK_H
+#define RADIO_TASK_H
+
+#include <stdint.h>
+
+// Task FreeRTOS proprietario del Si5351: riceve le frequenze tramite caselle
+// "vince l'ultimo", così una raffica di scatti dell'encoder diventa una sola scrittura.
+
+void setupRadioTask();
+// recall = richiamo (banda, modo, memoria): l'immagine registri viene dalla cache
+void radioPostVFO(uint32_t freq, bool recall = false);  // Nuova frequenza VFO
+void radioPostBFO(uint32_t freq, bool recall = false);  // Nuova frequenza BFO, 0 = BFO spento
+void radioPostCalibration(int32_t correction);          // Nuovo fattore: ripianifica VFO e BFO
+// Manipolazione CLK2: prepara le immagini e parte dal livello idle
+// (mode = KEYER_OFF spegne il CLK2)
+void radioPostKeySetup(uint8_t mode, uint32_t freq, uint8_t idle);
+void radioKeyFromISR(uint8_t level);  // Dal timer: nuovo livello (KEY_MARK / KEY_SPACE o tono)
+// Esegue lo sweep preparato da startSweep(). runSweep() gira nel task radio
+// in attesa attiva, senza cedere il core: per tutta la durata (circa 1 ms a
+// punto) le richieste VFO, BFO e di manipolazione restano nelle caselle e
+// collassano nell'ultima, scritta a sweep finito. Anche il loop, sullo stesso
+// core con priorità più bassa, resta fermo; il task UI sul core 0 continua.
+void radioPostSweep();
+void printRadioStats();             // Statistiche su seriale (comando RADIO)
+void resetRadioStats();
+
+#endif
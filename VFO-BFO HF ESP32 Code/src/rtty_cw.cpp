@@ -0,0 +1,180 @@
+#include "rtty_cw.h"
+#include "config.h"
+#include "keyer.h"
+#include "radio_task.h"
+#include "PLL.h"
+#include "wspr.h"
+#include "button.h"
+#include <string.h>
+
+static const char* keyerModeNames[] = {"OFF", "CW", "RTTY", "WSPR"};
+
+static hw_timer_t* keyerTimer = nullptr;
+static RttySequencer rtty;
+static volatile uint8_t keyerMode = KEYER_OFF;
+
+// Stato dell'ISR
+static uint8_t lastLevel = KEY_MARK;
+static uint8_t cwHistory = 0;
+
+// Beacon WSPR: simboli codificati una volta alla partenza
+static uint8_t beaconSymbols[WSPR_SYMBOL_COUNT];
+static volatile uint8_t beaconIndex = 0;
+static volatile bool beaconDone = false;
+
+// Pulsante: letto dal loop (GPIO36 non regge gli interrupt, vedi input_events.cpp)
+static Button keyerButton;
+
+// Un tick per mezzo bit RTTY, per simbolo WSPR o per campione del tasto CW
+static void IRAM_ATTR keyerTimerISR() {
+  uint8_t level;
+
+  if (keyerMode == KEYER_RTTY) {
+    level = rtty.tick();
+  } else if (keyerMode == KEYER_WSPR) {
+    // Fine dell'ultimo simbolo: lo spegnimento lo fa il loop
+    if (beaconIndex >= WSPR_SYMBOL_COUNT) {
+      beaconDone = true;
+      return;
+    }
+    level = beaconSymbols[beaconIndex];
+    beaconIndex = beaconIndex + 1;
+  } else {
+    // CW: il tasto deve restare stabile per CW_DEBOUNCE_SAMPLES campioni
+    const uint8_t mask = (1 << CW_DEBOUNCE_SAMPLES) - 1;
+    cwHistory = (cwHistory << 1) | (digitalRead(RTTY_CW_PIN) == LOW);
+    if ((cwHistory & mask) == mask) level = KEY_MARK;
+    else if ((cwHistory & mask) == 0) level = KEY_SPACE;
+    else return;
+  }
+
+  if (level == lastLevel) return;
+  lastLevel = level;
+  radioKeyFromISR(level);
+}
+
+void setupKeyer() {
+  pinMode(RTTY_CW_PIN, INPUT_PULLUP);
+  pinMode(SW_RTTY_CW, INPUT);         // GPIO36: solo ingresso, pull-up esterno
+  keyerButton.begin({BUTTON_DEBOUNCE_US, 0, 0, 0});
+
+  keyerTimer = timerBegin(KEYER_TIMER, 80000000 / KEYER_TIMER_HZ, true);
+  timerAttachInterrupt(keyerTimer, keyerTimerISR, false);   // Livello: il fronte non è supportato
+}
+
+void setKeyerMode(uint8_t mode) {
+  if (keyerTimer == nullptr) return;
+
+  timerAlarmDisable(keyerTimer);
+  rtty.reset();
+  cwHistory = 0;
+  beaconDone = false;
+  keyerMode = mode;
+
+  // Livello di partenza e periodo del timer
+  uint32_t freq = displayedFrequency;
+  uint64_t period = (uint64_t)CW_SAMPLE_US * (KEYER_TIMER_HZ / 1000000);
+  lastLevel = KEY_SPACE;
+
+  if (mode == KEYER_RTTY) {
+    lastLevel = KEY_MARK;
+    period = rttyHalfBitTicks();
+  } else if (mode == KEYER_WSPR) {
+    // Il primo simbolo parte subito, il timer scandisce i successivi
+    freq += WSPR_AUDIO_OFFSET;
+    lastLevel = beaconSymbols[0];
+    beaconIndex = 1;
+    period = ((uint64_t)KEYER_TIMER_HZ * WSPR_SYMBOL_NUM + WSPR_SYMBOL_DEN / 2) / WSPR_SYMBOL_DEN;
+  }
+
+  // Il task radio prepara le immagini prima di ricevere i fronti
+  radioPostKeySetup(mode, freq, lastLevel);
+  if (mode == KEYER_OFF) return;
+
+  timerWrite(keyerTimer, 0);
+  timerAlarmWrite(keyerTimer, period, true);
+  timerAlarmEnable(keyerTimer);
+}
+
+bool startWSPR(const char* call, const char* locator, int8_t dBm) {
+  // Codifica prima di fermare un'eventuale trasmissione in corso
+  uint8_t symbols[WSPR_SYMBOL_COUNT];
+  if (!wsprEncode(call, locator, dBm, symbols)) return false;
+
+  setKeyerMode(KEYER_OFF);
+  memcpy(beaconSymbols, symbols, sizeof(beaconSymbols));
+  setKeyerMode(KEYER_WSPR);
+  return true;
+}
+
+uint8_t getKeyerMode() {
+  return keyerMode;
+}
+
+const char* keyerModeName(uint8_t mode) {
+  return mode <= KEYER_WSPR ? keyerModeNames[mode] : "?";
+}
+
+int sendRTTY(const String& text) {
+  static bool figures = false;
+  if (keyerMode != KEYER_RTTY) return 0;
+
+  // Dopo una pausa si riparte dal registro lettere
+  if (rtty.pending() == 0) {
+    rtty.push(BAUDOT_LTRS);
+    figures = false;
+  }
+
+  int accepted = 0;
+  for (unsigned int i = 0; i < text.length(); i++) {
+    uint8_t codes[3];
+    bool nextFigures = figures;
+    uint8_t n = baudotEncode(text[i], nextFigures, codes);
+    if (n == 0) continue;
+    if (KEYER_QUEUE_SIZE - 1 - rtty.pending() < n) break;   // Coda piena
+
+    for (uint8_t j = 0; j < n; j++) rtty.push(codes[j]);
+    figures = nextFigures;
+    accepted++;
+  }
+  return accepted;
+}
+
+void checkKeyerButton() {
+  uint32_t now = micros();
+  ButtonAction action = keyerButton.edge(digitalRead(SW_RTTY_CW) == LOW, now);
+  if (action == BUTTON_NONE) action = keyerButton.poll(now);
+
+  if (action == BUTTON_CLICK) {
+    setKeyerMode((keyerMode + 1) % 3);
+    Serial.print("Manipolazione CLK2: ");
+    Serial.println(keyerModeName(keyerMode));
+  }
+}
+
+void updateKeyer() {
+  static unsigned long lastFrequency = 0;
+  static int32_t lastCalibration = 0;
+
+  if (keyerMode == KEYER_OFF) {
+    lastFrequency = 0;
+    return;
+  }
+
+  // Beacon: la frequenza resta quella di partenza fino all'ultimo simbolo
+  if (keyerMode == KEYER_WSPR) {
+    if (beaconDone) {
+      setKeyerMode(KEYER_OFF);
+      Serial.println("WSPR: trasmissione completata");
+    }
+    return;
+  }
+
+  // Nuove immagini quando cambia la frequenza o la calibrazione
+  int32_t calibration = si5351Calibration.load();
+  if (displayedFrequency != lastFrequency || calibration != lastCalibration) {
+    if (lastFrequency != 0) radioPostKeySetup(keyerMode, displayedFrequency, lastLevel);
+    lastFrequency = displayedFrequency;
+    lastCalibration = calibration;
+  }
+}
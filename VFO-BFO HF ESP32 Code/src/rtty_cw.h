@@ -0,0 +1,22 @@
+#ifndef RTTY_CW_H
+#define RTTY_CW_H
+
+#include <Arduino.h>
+
+// Manipolazione RTTY/CW su CLK2 del Si5351.
+// Un timer hardware scandisce i mezzi bit RTTY (45.45 baud), i simboli WSPR
+// (1.4648 baud) o campiona il tasto CW;
+// a ogni cambio di livello il task radio scrive l'immagine già pronta.
+
+void setupKeyer();
+void setKeyerMode(uint8_t mode);    // KEYER_OFF / KEYER_CW / KEYER_RTTY / KEYER_WSPR
+uint8_t getKeyerMode();
+const char* keyerModeName(uint8_t mode);
+int sendRTTY(const String& text);   // Accoda testo, ritorna i caratteri accettati
+// Beacon WSPR su CLK2 (dial + WSPR_AUDIO_OFFSET): va lanciato al secondo 1
+// di un minuto UTC pari, la trasmissione dura 162 simboli (circa 110 s)
+bool startWSPR(const char* call, const char* locator, int8_t dBm);
+void checkKeyerButton();            // Pulsante SW_RTTY_CW: OFF -> CW -> RTTY
+void updateKeyer();                 // Segue frequenza e calibrazione (dal loop)
+
+#endif
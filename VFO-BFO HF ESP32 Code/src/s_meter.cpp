@@ -1,131 +1,166 @@
-#include "s_meter.h"
-#include "config.h"
-#include "display.h"
-#include <TFT_eSPI.h>
-
-extern TFT_eSPI tft;
-
-int sMeterValue = 0;
-int sMeterPeak = 0;
-int previousSValue = -1;
-unsigned long lastPeakUpdate = 0;
-
-// Filtro a media mobile per stabilizzare il segnale
-const int SMOOTHING_WINDOW = 5;
-int rawValues[SMOOTHING_WINDOW];
-int valueIndex = 0;
-int valueTotal = 0;
-
-void setupSMeter() {
-  
-  // Inizializza il filtro a media mobile
-  for (int i = 0; i < SMOOTHING_WINDOW; i++) {
-    rawValues[i] = 0;
-  }
-  
-  // Disegna l'S-meter completo una volta all'inizio
-  tft.fillRect(S_METER_X, S_METER_Y - 15, S_METER_WIDTH, S_METER_HEIGHT + 35, BACKGROUND_COLOR); 
-  
-  // Disegna tutti i segmenti spenti
-  for (int i = 0; i < S_METER_SEGMENTS; i++) {
-    drawSMeterSegment(i, false);
-  }
-  
-  // Disegna le etichette
-  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
-  tft.setTextSize(1);
-  tft.drawString("S-METER", S_METER_X, S_METER_Y - 13);
-}
-
-void drawSMeterSegment(int segment, bool state) {
-  if (segment < 0 || segment >= S_METER_SEGMENTS) return;
-  
-  int segmentX = S_METER_X + (segment * S_METER_SEGMENT_WIDTH);
-  
-  // Assicurati che il segmento non vada fuori dall'area
-  if (segmentX < S_METER_X) return;
-  if (segmentX + S_METER_SEGMENT_WIDTH > S_METER_X + S_METER_WIDTH) return;
-  // Determina il colore in base al segmento
-  uint16_t segmentColor;
-  if (segment < 16) {
-    segmentColor = S_METER_LOW_COLOR;      // S1 a S9+30: Verde
-  } else {
-    segmentColor = S_METER_HIGH_COLOR;     // S9+40 a +60: Rosso
-  }
-  
-  // Disegna il segmento
-  if (state) {
-    tft.fillRect(segmentX, S_METER_Y, S_METER_SEGMENT_WIDTH - 1, S_METER_HEIGHT, segmentColor);
-  } else {
-    tft.fillRect(segmentX, S_METER_Y, S_METER_SEGMENT_WIDTH - 1, S_METER_HEIGHT, S_METER_BG_COLOR);
-  }
-}
-
-void updateSMeter() {
-  // Leggi il valore analogico
-  int rawValue = analogRead(S_METER_PIN);
-  
-  // Applica filtro a media mobile
-  valueTotal = valueTotal - rawValues[valueIndex];
-  rawValues[valueIndex] = rawValue;
-  valueTotal = valueTotal + rawValues[valueIndex];
-  valueIndex = (valueIndex + 1) % SMOOTHING_WINDOW;
-  
-  int averageValue = valueTotal / SMOOTHING_WINDOW;
-  
-  // Converti in valore per 25 segmenti con alta risoluzione
-  int newValue = map(constrain(averageValue, 0, 3000), 0, 3000, 0, S_METER_SEGMENTS);
-  
-  // Aggiorna solo se c'è un cambiamento reale
-  if (newValue != sMeterValue) {
-    sMeterValue = newValue;
-    
-    // Aggiorna solo i segmenti che sono cambiati
-    if (sMeterValue != previousSValue) {
-      // Spegni i segmenti in eccesso
-      if (sMeterValue < previousSValue) {
-        for (int i = previousSValue; i > sMeterValue-1; i--) {
-          drawSMeterSegment(i, false);
-        }
-      } 
-      // Accendi i nuovi segmenti
-      else if (sMeterValue > previousSValue) {
-        for (int i = previousSValue; i < sMeterValue; i++) {
-          drawSMeterSegment(i, true);
-        }
-      }
-      
-      previousSValue = sMeterValue;
-    }
-  }
-  
-  // Aggiorna il picco
-  if (sMeterValue > sMeterPeak) {
-    sMeterPeak = sMeterValue;
-    lastPeakUpdate = millis();
-    
-  // Aggiorna immediatamente l'indicatore di picco
-    static int previousPeak = -1;
-    if (previousPeak > 0 && previousPeak <= S_METER_SEGMENTS) {
-      int oldPeakX = S_METER_X + (previousPeak * S_METER_SEGMENT_WIDTH) - (S_METER_SEGMENT_WIDTH );
-      tft.fillRect(oldPeakX, S_METER_Y + S_METER_SEGMENT_WIDTH+3, S_METER_SEGMENT_WIDTH-1, 3, BACKGROUND_COLOR); // Cancella il vecchio picco
-      tft.fillRect(oldPeakX, S_METER_Y -3, S_METER_SEGMENT_WIDTH-1, 3, BACKGROUND_COLOR); // Cancella il vecchio picco
-    }
-    
-    if (sMeterPeak > 0 && sMeterPeak <= S_METER_SEGMENTS) {
-      int peakX = S_METER_X + (sMeterPeak * S_METER_SEGMENT_WIDTH) - (S_METER_SEGMENT_WIDTH );
-      tft.fillRect(peakX, S_METER_Y + S_METER_SEGMENT_WIDTH+3, S_METER_SEGMENT_WIDTH-1, 3, TFT_WHITE); // Disegna il nuovo picco
-      tft.fillRect(peakX, S_METER_Y -3, S_METER_SEGMENT_WIDTH-1, 3, TFT_WHITE); // Disegna il nuovo picco
-    }
-    
-    previousPeak = sMeterPeak;
-  }
-
-  // Reset del picco dopo 150 millisecondi
-  if (millis() - lastPeakUpdate > 150) {
-    sMeterPeak = max(0, sMeterPeak - 1);
-    lastPeakUpdate = millis();
-  }
-  
- 
+#include "s_meter.h"
+#include "config.h"
+#include "display.h"
+#include "display_dma.h"
+#include <TFT_eSPI.h>
+
+extern TFT_eSPI tft;
+
+int sMeterValue = 0;                // Letto dal loop
+int sMeterPeak = 0;                 // Da qui in giù solo task UI
+int previousSValue = -1;
+static int previousPeak = -1;
+unsigned long lastPeakUpdate = 0;
+
+// Filtro a media mobile per stabilizzare il segnale
+const int SMOOTHING_WINDOW = 5;
+int rawValues[SMOOTHING_WINDOW];
+int valueIndex = 0;
+int valueTotal = 0;
+
+// Barra e tacche di picco in uno sprite a 4 bpp: si disegnano indici di
+// tavolozza, i colori RGB565 si ricavano solo durante l'invio. Ogni fotogramma
+// invia la sola finestra di colonne toccate
+static TFT_eSprite sMeterSprite = TFT_eSprite(&tft);
+enum { SM_INK_BACKGROUND, SM_INK_OFF, SM_INK_LOW, SM_INK_HIGH, SM_INK_PEAK };
+static uint16_t sMeterPalette[16] = {BACKGROUND_COLOR, S_METER_BG_COLOR, S_METER_LOW_COLOR, S_METER_HIGH_COLOR, TFT_WHITE};
+
+#define S_METER_SPRITE_Y (S_METER_Y - 3)                    // Tacca di picco superiore
+#define S_METER_BAR_ROW 3                                   // Barra nello sprite
+#define S_METER_PEAK_LOW_ROW (S_METER_BAR_ROW + S_METER_SEGMENT_WIDTH + 3)
+
+static int16_t sMeterDirtyLeft = S_METER_WIDTH;   // Colonne da inviare
+static int16_t sMeterDirtyRight = -1;
+
+uint32_t setupSMeterSprite() {
+  sMeterSprite.setColorDepth(4);
+  if (!sMeterSprite.createSprite(S_METER_WIDTH, S_METER_SPRITE_HEIGHT)) return 0;
+  sMeterSprite.createPalette(sMeterPalette);
+  return (uint32_t)(S_METER_WIDTH / 2) * S_METER_SPRITE_HEIGHT;
+}
+
+static void markSMeterDirty(int16_t x, int16_t w) {
+  sMeterDirtyLeft = min(sMeterDirtyLeft, x);
+  sMeterDirtyRight = max(sMeterDirtyRight, (int16_t)(x + w - 1));
+}
+
+static void pushSMeterSprite() {
+  if (sMeterDirtyRight < sMeterDirtyLeft) return;
+  int16_t w = sMeterDirtyRight - sMeterDirtyLeft + 1;
+  pushSpriteDMA(sMeterSprite, S_METER_X + sMeterDirtyLeft, S_METER_SPRITE_Y,
+                sMeterDirtyLeft, 0, w, S_METER_SPRITE_HEIGHT);
+  sMeterDirtyLeft = S_METER_WIDTH;
+  sMeterDirtyRight = -1;
+}
+
+// Tacche sopra e sotto il segmento del picco (1..S_METER_SEGMENTS)
+static void drawSMeterPeak(int peak, uint8_t ink) {
+  if (peak <= 0 || peak > S_METER_SEGMENTS) return;
+  int peakX = (peak - 1) * S_METER_SEGMENT_WIDTH;
+  sMeterSprite.fillRect(peakX, S_METER_PEAK_LOW_ROW, S_METER_SEGMENT_WIDTH-1, 3, ink);
+  sMeterSprite.fillRect(peakX, 0, S_METER_SEGMENT_WIDTH-1, 3, ink);
+  markSMeterDirty(peakX, S_METER_SEGMENT_WIDTH - 1);
+}
+
+void setupSMeter() {
+  // Disegna l'S-meter completo una volta all'inizio
+  tft.fillRect(S_METER_X, S_METER_Y - 15, S_METER_WIDTH, S_METER_HEIGHT + 35, BACKGROUND_COLOR); 
+  
+  // Disegna tutti i segmenti spenti
+  sMeterSprite.fillSprite(SM_INK_BACKGROUND);
+  for (int i = 0; i < S_METER_SEGMENTS; i++) {
+    drawSMeterSegment(i, false);
+  }
+  markSMeterDirty(0, S_METER_WIDTH);
+  pushSMeterSprite();
+  
+  // Disegna le etichette
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextSize(1);
+  tft.drawString("S-METER", S_METER_X, S_METER_Y - 13);
+
+  // Tutto spento: i prossimi disegni partono da zero
+  previousSValue = 0;
+  sMeterPeak = 0;
+  previousPeak = -1;
+}
+
+void drawSMeterSegment(int segment, bool state) {
+  if (segment < 0 || segment >= S_METER_SEGMENTS) return;
+  
+  int segmentX = segment * S_METER_SEGMENT_WIDTH;   // Colonna nello sprite
+  
+  // Assicurati che il segmento non vada fuori dall'area
+  if (segmentX + S_METER_SEGMENT_WIDTH > S_METER_WIDTH) return;
+  // Determina il colore in base al segmento
+  uint8_t segmentInk;
+  if (segment < 16) {
+    segmentInk = SM_INK_LOW;      // S1 a S9+30: Verde
+  } else {
+    segmentInk = SM_INK_HIGH;     // S9+40 a +60: Rosso
+  }
+  
+  // Disegna il segmento nello sprite (inviato da drawSMeter)
+  sMeterSprite.fillRect(segmentX, S_METER_BAR_ROW, S_METER_SEGMENT_WIDTH - 1, S_METER_HEIGHT,
+                        state ? segmentInk : (uint8_t)SM_INK_OFF);
+  markSMeterDirty(segmentX, S_METER_SEGMENT_WIDTH - 1);
+}
+
+// Dal loop: lettura e media, nessun disegno
+int readSMeter() {
+  // Leggi il valore analogico
+  int rawValue = analogRead(S_METER_PIN);
+  
+  // Applica filtro a media mobile
+  valueTotal = valueTotal - rawValues[valueIndex];
+  rawValues[valueIndex] = rawValue;
+  valueTotal = valueTotal + rawValues[valueIndex];
+  valueIndex = (valueIndex + 1) % SMOOTHING_WINDOW;
+  
+  int averageValue = valueTotal / SMOOTHING_WINDOW;
+  
+  // Converti in valore per 25 segmenti con alta risoluzione
+  return map(constrain(averageValue, 0, 3000), 0, 3000, 0, S_METER_SEGMENTS);
+}
+
+// Dal task UI: segmenti e picco per il valore dell'istantanea
+void drawSMeter(int value) {
+  // Aggiorna solo i segmenti che sono cambiati
+  if (value != previousSValue) {
+    // Spegni i segmenti in eccesso
+    if (value < previousSValue) {
+      for (int i = previousSValue; i > value-1; i--) {
+        drawSMeterSegment(i, false);
+      }
+    } 
+    // Accendi i nuovi segmenti
+    else {
+      for (int i = previousSValue; i < value; i++) {
+        drawSMeterSegment(i, true);
+      }
+    }
+    
+    previousSValue = value;
+  }
+  
+  // Aggiorna il picco
+  if (value > sMeterPeak) {
+    sMeterPeak = value;
+    lastPeakUpdate = millis();
+    
+  // Aggiorna immediatamente l'indicatore di picco
+    drawSMeterPeak(previousPeak, SM_INK_BACKGROUND);   // Cancella il vecchio picco
+    drawSMeterPeak(sMeterPeak, SM_INK_PEAK);           // Disegna il nuovo picco
+    
+    previousPeak = sMeterPeak;
+  }
+
+  // Reset del picco dopo 150 millisecondi
+  if (millis() - lastPeakUpdate > 150) {
+    sMeterPeak = max(0, sMeterPeak - 1);
+    lastPeakUpdate = millis();
+  }
+
+  // Segmenti e picco cambiati: una sola finestra verso il display
+  pushSMeterSprite();
 }
\ No newline at end of file
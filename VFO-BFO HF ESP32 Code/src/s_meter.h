@@ -1,15 +1,17 @@
-#ifndef S_METER_H
-#define S_METER_H
-
-#include "config.h"
-
-extern int sMeterValue;
-extern int sMeterPeak;
-extern int previousSValue;  // Aggiungi questa variabile
-
-void setupSMeter();
-void updateSMeter();
-void drawSMeter();
-void drawSMeterSegment(int segment, bool state);  // Nuova funzione
-
+#ifndef S_METER_H
+#define S_METER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+extern int sMeterValue;
+extern int sMeterPeak;
+extern int previousSValue;  // Aggiungi questa variabile
+
+uint32_t setupSMeterSprite();    // Dal setup: sprite a 4 bpp della barra
+void setupSMeter();
+int readSMeter();               // Loop: ADC e media, segmenti da accendere
+void drawSMeter(int value);     // Task UI: segmenti e picco
+void drawSMeterSegment(int segment, bool state);  // Nuova funzione
+
 #endif
\ No newline at end of file
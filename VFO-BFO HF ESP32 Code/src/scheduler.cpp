@@ -0,0 +1,72 @@
+#include "scheduler.h"
+
+void Scheduler::begin(SchedTask* table, uint8_t n, Clock source) {
+  tasks = table;
+  count = n;
+  clock = source;
+
+  uint32_t now = clock();
+  for (uint8_t i = 0; i < count; i++) tasks[i].releaseUs = now;
+  resetStats();
+}
+
+void Scheduler::resetStats() {
+  for (uint8_t i = 0; i < count; i++) {
+    SchedTask& t = tasks[i];
+    t.runs = t.overruns = t.skipped = 0;
+    t.maxLateUs = t.maxRunUs = 0;
+  }
+}
+
+SchedTask* Scheduler::runOnce() {
+  uint32_t now = clock();
+
+  // Pronto = rilascio passato; il più urgente per priorità, poi per ritardo
+  SchedTask* next = nullptr;
+  uint32_t nextLate = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    SchedTask& t = tasks[i];
+    int32_t late = (int32_t)(now - t.releaseUs);
+    if (late < 0) continue;
+    if (next == nullptr || t.priority < next->priority ||
+        (t.priority == next->priority && (uint32_t)late > nextLate)) {
+      next = &t;
+      nextLate = late;
+    }
+  }
+  if (next == nullptr) return nullptr;
+
+  SchedTask& t = *next;
+  uint32_t start = clock();
+  t.run();
+  uint32_t end = clock();
+
+  uint32_t late = start - t.releaseUs;
+  uint32_t duration = end - start;
+  if (late > t.maxLateUs) t.maxLateUs = late;
+  if (duration > t.maxRunUs) t.maxRunUs = duration;
+  if (end - t.releaseUs > t.deadlineUs) t.overruns++;
+  t.runs++;
+
+  // Prossimo rilascio sulla griglia del periodo. Indietro di più periodi: si
+  // salta all'ultimo rilascio passato, una sola esecuzione di recupero.
+  t.releaseUs += t.periodUs;
+  int32_t behind = (int32_t)(end - t.releaseUs);
+  if (behind >= (int32_t)t.periodUs) {
+    uint32_t missed = (uint32_t)behind / t.periodUs;
+    t.releaseUs += missed * t.periodUs;
+    t.skipped += missed;
+  }
+  return next;
+}
+
+uint32_t Scheduler::untilNextUs() const {
+  uint32_t now = clock();
+  uint32_t soonest = UINT32_MAX;
+  for (uint8_t i = 0; i < count; i++) {
+    int32_t wait = (int32_t)(tasks[i].releaseUs - now);
+    if (wait <= 0) return 0;
+    if ((uint32_t)wait < soonest) soonest = wait;
+  }
+  return soonest;
+}
@@ -0,0 +1,58 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// Scheduler cooperativo a tabella statica, senza heap. Ogni task ha periodo,
+// priorità e deadline: a ogni giro si esegue il task pronto più urgente
+// (priorità più bassa, a parità il rilascio più vecchio), fino in fondo.
+// Senza prelazione un task lungo ritarda gli altri, ma l'encoder passa sempre
+// prima del resto: il suo ritardo massimo è la durata del task più lungo.
+//
+// Deadline mancata (fine oltre rilascio + deadline) = sforamento. Se un task
+// resta indietro di più periodi i rilasci persi si saltano e si contano,
+// senza raffiche per recuperare. Tempi con differenze a 32 bit: il giro di
+// micros() dopo 71 minuti non disturba.
+// Orologio passato da fuori: compila anche su host (src/tools/sched_sim.cpp).
+
+struct SchedTask {
+  const char* name;
+  void (*run)();
+  uint32_t periodUs;
+  uint32_t deadlineUs;        // Dal rilascio alla fine dell'esecuzione
+  uint8_t priority;           // 0 = la più urgente
+
+  // Stato e statistiche (azzerati da begin): le tabelle danno solo i campi sopra
+  uint32_t releaseUs = 0;     // Prossimo rilascio
+  uint32_t runs = 0;
+  uint32_t overruns = 0;      // Deadline mancate
+  uint32_t skipped = 0;       // Rilasci saltati: in ritardo di oltre un periodo
+  uint32_t maxLateUs = 0;     // Ritardo massimo di partenza dal rilascio
+  uint32_t maxRunUs = 0;      // Durata massima
+};
+
+class Scheduler {
+public:
+  typedef uint32_t (*Clock)();
+
+  // Tutti i task pronti subito; tabella del chiamante (statica)
+  void begin(SchedTask* tasks, uint8_t count, Clock clock);
+
+  // Esegue il task pronto più urgente, nullptr se nessuno è pronto
+  SchedTask* runOnce();
+
+  // µs al prossimo rilascio (0 = c'è un task pronto)
+  uint32_t untilNextUs() const;
+
+  void resetStats();
+
+  uint8_t size() const { return count; }
+  const SchedTask& task(uint8_t i) const { return tasks[i]; }
+
+private:
+  SchedTask* tasks = nullptr;
+  uint8_t count = 0;
+  Clock clock = nullptr;
+};
+
+#endif
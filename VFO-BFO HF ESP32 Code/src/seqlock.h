@@ -0,0 +1,68 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Istantanea protetta da un numero di sequenza (seqlock), uno scrittore e un
+// lettore anche su core diversi. Lo scrittore non aspetta mai: rende dispari la
+// sequenza, copia, la rende pari. Il lettore copia e riprova se la sequenza era
+// dispari o è cambiata nel frattempo: non vede mai una copia a metà.
+// Con la copia locale del lettore è un doppio buffer: si disegna dalla propria
+// copia, lo scrittore intanto pubblica la successiva.
+// Dati copiati a parole di 32 bit atomiche: niente corse anche per i
+// controlli sui thread. Senza dipendenze Arduino: compila anche su host.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock: tipo non copiabile byte per byte");
+
+public:
+    // Pubblica un nuovo stato (solo dallo scrittore)
+    void write(const T& value) {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t i = 0; i < WORDS; i++) data[i].store(words[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Una sola prova: false se lo scrittore era a metà
+    bool tryRead(T& value, uint32_t& version) const {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+
+        uint32_t words[WORDS];
+        for (uint32_t i = 0; i < WORDS; i++) words[i] = data[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) return false;
+
+        memcpy(&value, words, sizeof(T));
+        version = before;
+        return true;
+    }
+
+    // Copia coerente, riprovando; restituisce la versione letta (pari)
+    uint32_t read(T& value) {
+        uint32_t version;
+        while (!tryRead(value, version)) retries++;
+        return version;
+    }
+
+    // Cresce di 2 a ogni pubblicazione (0 = mai pubblicato)
+    uint32_t version() const { return sequence.load(std::memory_order_acquire); }
+
+    uint32_t retries = 0;   // Letture ripetute (solo lato lettore)
+
+private:
+    static constexpr uint32_t WORDS = (sizeof(T) + 3) / 4;
+
+    std::atomic<uint32_t> data[WORDS] = {};
+    std::atomic<uint32_t> sequence{0};
+};
+
+#endif
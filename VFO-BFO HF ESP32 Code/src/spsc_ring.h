@@ -0,0 +1,55 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Coda circolare senza lock tra un solo produttore (ISR) e un solo consumatore (loop).
+// Indici a 32 bit che girano liberi: pieno = head - tail == N, vuoto = head == tail.
+// A coda piena il nuovo elemento si scarta e si conta: l'ISR non aspetta mai.
+// Senza dipendenze Arduino: compila anche su host (src/tools/ring_stress.cpp).
+template <typename T, uint32_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N deve essere potenza di 2");
+
+public:
+    // Solo produttore. Sempre inline: chiamata da ISR in IRAM
+    __attribute__((always_inline)) inline bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) {
+            drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Solo consumatore
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+
+        uint32_t used = head.load(std::memory_order_relaxed) - t;
+        if (used > peak) peak = used;
+        return true;
+    }
+
+    uint32_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    static constexpr uint32_t capacity() { return N; }
+    uint32_t dropped() const { return drops.load(std::memory_order_relaxed); }  // Scartati a coda piena
+    uint32_t highWater() const { return peak; }   // Occupazione massima vista dal consumatore
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head{0};      // Scritto solo dal produttore
+    std::atomic<uint32_t> tail{0};      // Scritto solo dal consumatore
+    std::atomic<uint32_t> drops{0};     // Scritto solo dal produttore
+    uint32_t peak = 0;                  // Solo lato consumatore
+};
+
+#endif
@@ -0,0 +1,211 @@
+#include "sweep.h"
+#include "config.h"
+#include "PLL.h"
+#include "PLL_plan.h"
+#include "radio_task.h"
+#include "rtty_cw.h"
+#include "keyer.h"
+#include "display.h"
+#include "text_format.h"
+#include "radio_state.h"
+#include <atomic>
+#include <string.h>
+
+// Stato: il loop prepara, il task radio esegue, il loop invia, il task UI disegna
+enum SweepState : uint8_t {
+  SWEEP_IDLE,
+  SWEEP_PENDING,              // Immagini pronte, in attesa del task radio
+  SWEEP_RUNNING,
+  SWEEP_DONE,                 // Risultati da inviare
+  SWEEP_FAILED,
+  SWEEP_PLOT                  // Grafico al posto dell'S-meter
+};
+
+static std::atomic<uint8_t> sweepState{SWEEP_IDLE};
+
+static uint32_t sweepStart = 0;
+static uint32_t sweepStep = 0;
+static uint16_t sweepPoints = 0;
+static uint16_t sweepSettle = SWEEP_SETTLE_US;
+static uint32_t sweepDuration = 0;
+
+// Primo punto completo (PLLB + Multisynth 2), poi solo i Multisynth:
+// con il PLLB fisso a 800MHz il blocco PLL è uguale per tutti i punti
+static SynthImage sweepFirst;
+static uint8_t sweepImages[SWEEP_MAX_POINTS][8];
+static uint16_t sweepResults[SWEEP_MAX_POINTS];
+
+// Area del grafico: la stessa dell'S-meter, ultime righe per le etichette
+#define SWEEP_PLOT_X S_METER_X
+#define SWEEP_PLOT_Y (S_METER_Y - 15)
+#define SWEEP_PLOT_W S_METER_WIDTH
+#define SWEEP_PLOT_H (S_METER_HEIGHT + 25)
+
+bool startSweep(uint32_t start, uint32_t stop, uint16_t points, uint16_t settleUs) {
+  uint8_t state = sweepState.load();
+  if (state == SWEEP_PENDING || state == SWEEP_RUNNING) return false;
+  if (points < 2 || points > SWEEP_MAX_POINTS || stop <= start) return false;
+
+  uint32_t step = (stop - start) / (points - 1);
+  if (step == 0) return false;
+
+  // Tutte le immagini prima di partire: nel ciclo restano solo bus e ADC
+  uint32_t ref = correctedRef(si5351Calibration.load());
+  for (uint16_t i = 0; i < points; i++) {
+    SynthPlan plan;
+    SynthImage image;
+    if (!planFixedPLL(start + (uint32_t)i * step, PLL_FIXED_FREQ, ref, plan)) return false;
+    encodeSynthImage(plan, image);
+    if (i == 0) sweepFirst = image;
+    memcpy(sweepImages[i], image.ms, 8);
+  }
+
+  sweepStart = start;
+  sweepStep = step;
+  sweepPoints = points;
+  sweepSettle = settleUs;
+
+  // CLK2 è condiviso con la manipolazione: il task radio la spegne prima dello sweep
+  if (getKeyerMode() != KEYER_OFF) setKeyerMode(KEYER_OFF);
+  sweepState.store(SWEEP_PENDING);
+  radioState.mark(DIRTY_SWEEP);
+  radioPostSweep();
+  return true;
+}
+
+// Per ogni punto: scrittura -> attesa -> letture ADC. Il punto i+1 viene
+// preparato nella copia dei registri durante l'attesa del punto i, così la
+// scrittura parte subito dopo l'ultima lettura senza calcoli in mezzo.
+// Tempi con il bus a 100kHz (EEPROMManager::begin() abbassa i 400kHz di
+// setup(), il PCF8574 non va oltre): 6-7 byte del Multisynth 2 più indirizzi
+// sono circa 0,8 ms di I2C, più SWEEP_SETTLE_US e le letture ADC, circa 1 ms
+// a punto: 0,5 s per 500 punti.
+// Attesa attiva: il task radio tiene il core 1 per tutto lo sweep (vedi
+// radioPostSweep() in radio_task.h).
+void runSweep() {
+  uint8_t expected = SWEEP_PENDING;
+  if (!sweepState.compare_exchange_strong(expected, SWEEP_RUNNING)) return;
+
+  if (!si5351BeginSweep(sweepFirst)) {
+    sweepState.store(SWEEP_FAILED);
+    return;
+  }
+
+  uint32_t begin = micros();
+  for (uint16_t i = 0; i < sweepPoints; i++) {
+    uint32_t written = micros();
+    if (i + 1 < sweepPoints) si5351StageSweep(sweepImages[i + 1]);
+    while (micros() - written < sweepSettle) {
+    }
+
+    // Rivelatore letto come l'S-meter, media di pochi campioni
+    uint32_t sum = 0;
+    for (uint8_t s = 0; s < SWEEP_ADC_SAMPLES; s++) sum += analogRead(SWEEP_ADC_PIN);
+    sweepResults[i] = sum / SWEEP_ADC_SAMPLES;
+
+    si5351Shadow.flush();
+  }
+  sweepDuration = micros() - begin;
+
+  si5351EndSweep();
+  sweepState.store(SWEEP_DONE);
+}
+
+void drawSweepPlot() {
+  uint16_t top = 1;
+  for (uint16_t i = 0; i < sweepPoints; i++) {
+    if (sweepResults[i] > top) top = sweepResults[i];
+  }
+
+  tft.fillRect(SWEEP_PLOT_X, SWEEP_PLOT_Y, SWEEP_PLOT_W, SWEEP_PLOT_H + 10, BACKGROUND_COLOR);
+  tft.drawRect(SWEEP_PLOT_X, SWEEP_PLOT_Y, SWEEP_PLOT_W, SWEEP_PLOT_H, S_METER_BG_COLOR);
+  tft.drawFastVLine(SWEEP_PLOT_X + SWEEP_PLOT_W / 2, SWEEP_PLOT_Y + 1, SWEEP_PLOT_H - 2, S_METER_BG_COLOR);
+
+  // Una colonna per pixel: con più punti che pixel si traccia min..max della colonna
+  const int16_t height = SWEEP_PLOT_H - 2;
+  for (int16_t x = 0; x < SWEEP_PLOT_W - 2; x++) {
+    uint16_t first = (uint32_t)x * sweepPoints / (SWEEP_PLOT_W - 2);
+    uint16_t last = (uint32_t)(x + 1) * sweepPoints / (SWEEP_PLOT_W - 2);
+    if (last > first) last--;
+
+    uint16_t low = UINT16_MAX, high = 0;
+    for (uint16_t i = first; i <= last; i++) {
+      if (sweepResults[i] < low) low = sweepResults[i];
+      if (sweepResults[i] > high) high = sweepResults[i];
+    }
+
+    int16_t yHigh = SWEEP_PLOT_Y + 1 + height - 1 - (int32_t)high * (height - 1) / top;
+    int16_t yLow = SWEEP_PLOT_Y + 1 + height - 1 - (int32_t)low * (height - 1) / top;
+    tft.drawFastVLine(SWEEP_PLOT_X + 1 + x, yHigh, yLow - yHigh + 1, SWEEP_TRACE_COLOR);
+  }
+
+  // Estremi e centro
+  uint32_t stop = sweepStart + (uint32_t)(sweepPoints - 1) * sweepStep;
+  tft.setTextColor(TFT_WHITE, BACKGROUND_COLOR);
+  tft.setTextSize(1);
+  char text[FREQ_TEXT_SIZE];
+  formatFrequency(text, sweepStart);
+  tft.drawString(text, SWEEP_PLOT_X, SWEEP_PLOT_Y + SWEEP_PLOT_H + 2);
+  uint8_t len = formatFrequency(text, sweepStart + (stop - sweepStart) / 2);
+  tft.drawString(text, SWEEP_PLOT_X + (SWEEP_PLOT_W - len * 6) / 2, SWEEP_PLOT_Y + SWEEP_PLOT_H + 2);
+  len = formatFrequency(text, stop);
+  tft.drawString(text, SWEEP_PLOT_X + SWEEP_PLOT_W - len * 6, SWEEP_PLOT_Y + SWEEP_PLOT_H + 2);
+}
+
+// Campo little endian, sommato nel checksum
+static void sendField(uint32_t value, uint8_t bytes, uint16_t& sum) {
+  for (uint8_t i = 0; i < bytes; i++) {
+    uint8_t b = value >> (8 * i);
+    sum += b;
+    Serial.write(b);
+  }
+}
+
+static void sendSweep() {
+  uint16_t sum = 0;
+  Serial.write((const uint8_t*)"SWP1", 4);
+  sendField(sweepStart, 4, sum);
+  sendField(sweepStep, 4, sum);
+  sendField(sweepPoints, 2, sum);
+  sendField(sweepSettle, 2, sum);
+  sendField(sweepDuration, 4, sum);
+  for (uint16_t i = 0; i < sweepPoints; i++) sendField(sweepResults[i], 2, sum);
+  sendField(sum, 2, sum);
+}
+
+void updateSweep() {
+  uint8_t state = sweepState.load();
+
+  if (state == SWEEP_FAILED) {
+    Serial.println("SWEEP: CLK2 non disponibile");
+    sweepState.store(SWEEP_IDLE);
+    radioState.mark(DIRTY_SWEEP);
+    return;
+  }
+  if (state != SWEEP_DONE) return;
+
+  Serial.print("SWEEP: ");
+  Serial.print(sweepPoints);
+  Serial.print(" punti in ");
+  Serial.print(sweepDuration);
+  Serial.println(" us");
+  sendSweep();
+  Serial.println();
+
+  sweepState.store(SWEEP_PLOT);
+  radioState.mark(DIRTY_SWEEP);
+}
+
+bool sweepActive() {
+  return sweepState.load() != SWEEP_IDLE;
+}
+
+bool sweepPlotReady() {
+  return sweepState.load() == SWEEP_PLOT;
+}
+
+void closeSweepPlot() {
+  // Il task UI vede lo stato tornare a riposo e ridisegna l'S-meter
+  uint8_t expected = SWEEP_PLOT;
+  if (sweepState.compare_exchange_strong(expected, SWEEP_IDLE)) radioState.mark(DIRTY_SWEEP);
+}
@@ -0,0 +1,25 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <Arduino.h>
+
+// Sweep su CLK2 (generatore + analizzatore scalare): CLK2 percorre i punti da
+// start a stop, a ogni punto si attende SWEEP_SETTLE_US e si legge il rivelatore
+// su SWEEP_ADC_PIN. Le immagini Multisynth sono calcolate prima di partire e la
+// scrittura del punto successivo è già preparata mentre si legge l'ADC.
+// A sweep finito il loop invia la curva in binario sulla seriale e il task UI
+// la disegna al posto dell'S-meter, dai risultati che restano fermi fino allo
+// sweep successivo:
+//   "SWP1", start (u32), step (u32), punti (u16), attesa us (u16), durata us (u32),
+//   punti x u16 (media ADC), somma a 16 bit dei byte dopo "SWP1" (u16)
+// Tutti i campi little endian.
+
+bool startSweep(uint32_t start, uint32_t stop, uint16_t points, uint16_t settleUs);
+void runSweep();            // Solo dal task radio
+void updateSweep();         // Dal loop: invio a sweep finito
+bool sweepActive();         // Sweep in corso o grafico visibile (S-meter sospeso)
+bool sweepPlotReady();      // Risultati pronti per il grafico
+void drawSweepPlot();       // Solo dal task UI
+void closeSweepPlot();      // Torna all'S-meter
+
+#endif
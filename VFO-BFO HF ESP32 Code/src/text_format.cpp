@@ -0,0 +1,37 @@
+#include "text_format.h"
+
+char* formatDigits(char* out, unsigned long value, uint8_t width) {
+  char digits[10];                  // 2^32 - 1: 10 cifre
+  uint8_t n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  while (n < width && n < sizeof(digits)) digits[n++] = '0';
+
+  while (n > 0) *out++ = digits[--n];
+  return out;
+}
+
+uint8_t formatFrequency(char (&out)[FREQ_TEXT_SIZE], unsigned long freq) {
+  char* p = out;
+  if (freq >= 1000000) {
+    p = formatDigits(p, freq / 1000000 % 100);
+    *p++ = '.';
+    p = formatDigits(p, freq / 1000 % 1000, 3);
+  } else {
+    p = formatDigits(p, freq / 1000);
+  }
+  *p++ = '.';
+  p = formatDigits(p, freq % 1000 / 10, 2);
+  *p = '\0';
+  return p - out;
+}
+
+uint8_t formatBFOFrequency(char (&out)[BFO_TEXT_SIZE], unsigned long freq) {
+  char* p = formatDigits(out, freq / 1000 % 1000);
+  *p++ = '.';
+  p = formatDigits(p, freq % 1000, 3);
+  *p = '\0';
+  return p - out;
+}
@@ -0,0 +1,41 @@
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Testo del display in buffer di dimensione fissa, senza heap: cifre generate
+// solo con interi (niente String, niente printf) e confronto con l'ultimo
+// testo disegnato tenuto in un array di char.
+
+#define FREQ_TEXT_SIZE 11           // "MM.kkk.hh" e terminatore
+#define BFO_TEXT_SIZE 8             // "kkk.hhh" e terminatore
+#define BOX_TEXT_SIZE 6             // Riquadri: "10kHz", "-20dB", "SLOW", "160m"
+
+// value in base 10 con almeno width cifre (zeri a sinistra); restituisce la
+// posizione dopo l'ultima cifra, senza terminatore
+char* formatDigits(char* out, unsigned long value, uint8_t width = 1);
+
+// Frequenza come sul display: "MM.kkk.hh" da 1MHz, "kkk.hh" sotto
+uint8_t formatFrequency(char (&out)[FREQ_TEXT_SIZE], unsigned long freq);
+
+// Frequenza del BFO in kHz con tutte e tre le cifre degli Hz: "455.000"
+uint8_t formatBFOFrequency(char (&out)[BFO_TEXT_SIZE], unsigned long freq);
+
+// Ultimo testo disegnato: update() lo sostituisce solo se diverso
+template <uint8_t N>
+struct TextCache {
+  char text[N];
+  bool valid;
+
+  bool update(const char* s) {
+    if (valid && strncmp(text, s, N) == 0) return false;
+    strncpy(text, s, N - 1);
+    text[N - 1] = '\0';
+    valid = true;
+    return true;
+  }
+  void invalidate() { valid = false; }
+};
+
+#endif
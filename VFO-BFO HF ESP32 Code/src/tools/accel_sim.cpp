@@ -0,0 +1,167 @@
+// Simulazione su PC dell'accelerazione della sintonia (tuning_accel.cpp) con
+// la curva di config.h. Un encoder da ENC_DETENTS_PER_TURN scatti/giro gira a
+// velocità costante (o partendo da fermo) e il loop legge gli scatti ogni
+// POLL_US, come readVFOEncoder(): si contano i giri per attraversare la banda
+// dei 20m da un capo all'altro con ogni step.
+//
+// Verifiche:
+//   giro veloce           20m in al più 3 giri con step 10 Hz, 100 Hz e 1 kHz
+//   giro lento            passo uguale allo step, scatto per scatto
+//   pausa e inversione    si riparte dallo step
+//   passo massimo         mai oltre ENC_ACCEL_MAX_STEP e sempre multiplo di step
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e accel_sim
+//   .pio/build/accel_sim/program [-v]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../config.h"
+#include "../bands.h"
+#include "../tuning_accel.h"
+
+#define ENC_DETENTS_PER_TURN 20         // Encoder meccanico tipico
+#define POLL_US 1000                    // Periodo di lettura del loop
+#define FAST_MAX_TURNS 3.0              // Giri massimi per la banda a giro veloce
+
+static const AccelPoint curve[] = ENC_ACCEL_CURVE;
+static const uint8_t curvePoints = sizeof(curve) / sizeof(curve[0]);
+static bool verbose = false;
+static bool allOk = true;
+
+static void check(const char* scenario, bool pass, const char* detail) {
+  printf("%-6s %-26s %s\n", pass ? "OK" : "ERRORE", scenario, detail);
+  allOk &= pass;
+}
+
+struct Spin {
+  uint32_t detents = 0;         // Scatti girati
+  uint32_t maxStepHz = 0;       // Passo per scatto più grande
+  bool multiples = true;        // Passi sempre multipli di step
+  uint32_t nowUs = 0;
+};
+
+// Gira in avanti a turnsPerSec (da fermo a quella velocità in rampUs) finché
+// la frequenza non supera span, con letture ogni POLL_US
+static Spin spinAcross(TuningAccel& accel, uint32_t span, uint32_t stepHz, double turnsPerSec,
+                       uint32_t rampUs, uint32_t startUs) {
+  Spin s;
+  uint64_t tuned = 0;
+  double detentAt = startUs + 1000;     // Tempo del prossimo scatto
+  const double periodUs = 1e6 / (turnsPerSec * ENC_DETENTS_PER_TURN);
+  uint32_t now = startUs;
+
+  while (tuned < span) {
+    now += POLL_US;
+    int32_t detents = 0;
+    while (detentAt <= now) {
+      detents++;
+      // In rampa il periodo parte da 4 volte quello finale
+      double elapsed = detentAt - startUs;
+      double slow = rampUs && elapsed < rampUs ? 4.0 - 3.0 * elapsed / rampUs : 1.0;
+      detentAt += periodUs * slow;
+    }
+    if (detents == 0) continue;
+
+    int32_t steps = accel.apply(detents, now, stepHz);
+    uint32_t perDetent = steps / detents * stepHz;
+    if (perDetent % stepHz) s.multiples = false;
+    if (perDetent > s.maxStepHz) s.maxStepHz = perDetent;
+    tuned += (uint64_t)steps * stepHz;
+    s.detents += detents;
+    if (verbose) {
+      printf("    %7u us  scatti %d  velocità %3u/s  passo %5u Hz  %7llu Hz\n", now, detents,
+             accel.rate(), perDetent, (unsigned long long)tuned);
+    }
+  }
+  s.nowUs = now;
+  return s;
+}
+
+static void fastSpin(const char* name, uint32_t span, uint32_t stepHz, double turnsPerSec, uint32_t rampUs) {
+  TuningAccel accel;
+  accel.begin(curve, curvePoints, ENC_ACCEL_IDLE_US);
+  Spin s = spinAcross(accel, span, stepHz, turnsPerSec, rampUs, 0);
+
+  double turns = (double)s.detents / ENC_DETENTS_PER_TURN;
+  bool pass = turns <= FAST_MAX_TURNS && s.multiples && s.maxStepHz <= ENC_ACCEL_MAX_STEP;
+  char detail[160];
+  snprintf(detail, sizeof(detail), "step %5u Hz, %.0f giri/s%s: %u scatti = %.1f giri (limite %.0f), passo max %u Hz",
+           stepHz, turnsPerSec, rampUs ? " da fermo" : "", s.detents, turns, FAST_MAX_TURNS, s.maxStepHz);
+  check(name, pass, detail);
+}
+
+// Mezzo giro al secondo: ogni scatto vale uno step
+static void slowSpin(uint32_t stepHz) {
+  TuningAccel accel;
+  accel.begin(curve, curvePoints, ENC_ACCEL_IDLE_US);
+  Spin s = spinAcross(accel, 40 * stepHz, stepHz, 0.5, 0, 0);
+
+  char detail[120];
+  snprintf(detail, sizeof(detail), "step %5u Hz, 0.5 giri/s: %u scatti per 40 step, passo max %u Hz",
+           stepHz, s.detents, s.maxStepHz);
+  check("giro lento", s.detents == 40 && s.maxStepHz == stepHz, detail);
+}
+
+// Dopo un giro veloce: il primo scatto dopo una pausa e dopo un'inversione vale uno step
+static void pauseAndReverse() {
+  TuningAccel accel;
+  accel.begin(curve, curvePoints, ENC_ACCEL_IDLE_US);
+  Spin s = spinAcross(accel, 200000, 10, 4.0, 0, 0);
+  uint32_t fast = accel.multiplier();
+
+  uint32_t now = s.nowUs + ENC_ACCEL_IDLE_US + POLL_US;
+  int32_t afterPause = accel.apply(1, now, 10);
+  s = spinAcross(accel, 200000, 10, 4.0, 0, now);
+  int32_t afterReverse = accel.apply(-1, s.nowUs + POLL_US, 10);
+
+  char detail[120];
+  snprintf(detail, sizeof(detail), "x%u a giro veloce, x%d dopo la pausa, x%d dopo l'inversione",
+           fast, afterPause, -afterReverse);
+  check("pausa e inversione", fast > 1 && afterPause == 1 && afterReverse == -1, detail);
+}
+
+// Step pari al passo massimo: nessuna accelerazione
+static void maxStep() {
+  TuningAccel accel;
+  accel.begin(curve, curvePoints, ENC_ACCEL_IDLE_US);
+  Spin s = spinAcross(accel, 1000000, ENC_ACCEL_MAX_STEP, 8.0, 0, 0);
+
+  char detail[120];
+  snprintf(detail, sizeof(detail), "step %u Hz, 8 giri/s: %u scatti per 100 step, passo max %u Hz",
+           ENC_ACCEL_MAX_STEP, s.detents, s.maxStepHz);
+  check("passo massimo", s.detents == 100 && s.maxStepHz == ENC_ACCEL_MAX_STEP, detail);
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  uint32_t span = 0;
+  for (int b = 0; b < totalBands; b++) {
+    if (strcmp(bands[b].name, "20m") == 0) span = bands[b].endFreq - bands[b].startFreq;
+  }
+  if (span == 0) {
+    fprintf(stderr, "Banda 20m non trovata\n");
+    return 2;
+  }
+  printf("Banda 20m: %u Hz, encoder %u scatti/giro, lettura ogni %u us\n", span, ENC_DETENTS_PER_TURN, POLL_US);
+
+  fastSpin("20m giro veloce", span, 10, 4.0, 0);
+  fastSpin("20m giro veloce", span, 10, 8.0, 0);
+  fastSpin("20m giro veloce", span, 10, 4.0, 250000);
+  fastSpin("20m giro veloce", span, 100, 4.0, 0);
+  fastSpin("20m giro veloce", span, 1000, 4.0, 0);
+  slowSpin(10);
+  slowSpin(1000);
+  pauseAndReverse();
+  maxStep();
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// Simulazione su PC del motore dei pulsanti (button.cpp) con orologio virtuale.
+// I fronti arrivano a edge() come dalla coda degli interrupt, poll() gira a
+// ogni giro del loop: le azioni prodotte e il loro istante si confrontano con
+// quelle attese. Rimbalzi, click, pressione lunga, ripetizione, doppio click,
+// rilascio dentro la finestra di debounce, loop bloccato e giro dei 32 bit di
+// micros().
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e button_sim
+//   .pio/build/button_sim/program [-v]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../config.h"
+#include "../button.h"
+
+static bool verbose = false;
+static bool allOk = true;
+
+static const char* const actionNames[] = {"-", "CLICK", "DOPPIO", "LUNGO", "RIPETI"};
+
+struct Edge {
+  uint32_t ms;                  // Istante dall'inizio della prova
+  uint32_t extraUs;             // Rimbalzi: microsecondi in più
+  bool pressed;
+};
+
+struct Event {
+  ButtonAction action;
+  uint32_t ms;
+};
+
+// Configurazioni dei pulsanti come in main.cpp
+static const ButtonTiming clickOnly = {BUTTON_DEBOUNCE_US, 0, 0, 0};
+static const ButtonTiming stepTiming = {BUTTON_DEBOUNCE_US, BUTTON_LONG_US, 0, 0};
+static const ButtonTiming bandTiming = {BUTTON_DEBOUNCE_US, BUTTON_LONG_US, BUTTON_REPEAT_US, 0};
+static const ButtonTiming modeTiming = {BUTTON_DEBOUNCE_US, 0, 0, BUTTON_DOUBLE_US};
+
+// Rigioca i fronti con un giro del loop ogni millisecondo fino a endMs, fermo
+// tra stallFromMs e stallToMs. startUs è micros() all'inizio della prova: di
+// norma un secondo dopo l'avvio, vicino a 2^32 per il giro dei 32 bit
+static std::vector<Event> run(const ButtonTiming& timing, const std::vector<Edge>& edges, uint32_t endMs,
+                              uint32_t startUs = 1000000, uint32_t stallFromMs = 0, uint32_t stallToMs = 0) {
+  Button button;
+  button.begin(timing);
+  std::vector<Event> events;
+  size_t next = 0;
+
+  for (uint32_t ms = 0; ms <= endMs; ms++) {
+    if (ms > stallFromMs && ms < stallToMs) continue;
+    uint32_t nowUs = startUs + ms * 1000;
+    while (next < edges.size() && edges[next].ms * 1000 + edges[next].extraUs <= ms * 1000) {
+      const Edge& e = edges[next++];
+      uint32_t edgeUs = startUs + e.ms * 1000 + e.extraUs;
+      ButtonAction a = button.edge(e.pressed, edgeUs);
+      if (a != BUTTON_NONE) events.push_back({a, (edgeUs - startUs) / 1000});
+    }
+    ButtonAction a = button.poll(nowUs);
+    if (a != BUTTON_NONE) events.push_back({a, ms});
+  }
+  return events;
+}
+
+static void expect(const char* name, const std::vector<Event>& got, const std::vector<Event>& want) {
+  bool pass = got.size() == want.size();
+  for (size_t i = 0; pass && i < got.size(); i++) {
+    pass = got[i].action == want[i].action && got[i].ms == want[i].ms;
+  }
+
+  char detail[200];
+  int len = 0;
+  for (const Event& e : got) {
+    len += snprintf(detail + len, sizeof(detail) - len, " %s@%u", actionNames[e.action], e.ms);
+    if (len >= (int)sizeof(detail)) break;
+  }
+  if (got.empty()) snprintf(detail, sizeof(detail), " nessuna azione");
+  printf("%-6s %-26s%s\n", pass ? "OK" : "ERRORE", name, detail);
+  if (!pass || verbose) {
+    printf("       attese:");
+    for (const Event& e : want) printf(" %s@%u", actionNames[e.action], e.ms);
+    printf("\n");
+  }
+  allOk &= pass;
+}
+
+// Pressione con rimbalzi: il pin oscilla per qualche centinaio di us
+static std::vector<Edge> bouncyPress(uint32_t pressMs, uint32_t releaseMs) {
+  return {
+    {pressMs, 0, true}, {pressMs, 200, false}, {pressMs, 500, true}, {pressMs, 1000, false}, {pressMs, 1300, true},
+    {releaseMs, 0, false}, {releaseMs, 300, true}, {releaseMs, 600, false}
+  };
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  const uint32_t longMs = BUTTON_LONG_US / 1000;
+  const uint32_t repeatMs = BUTTON_REPEAT_US / 1000;
+  const uint32_t doubleMs = BUTTON_DOUBLE_US / 1000;
+  const uint32_t debounceMs = BUTTON_DEBOUNCE_US / 1000;
+
+  // AGC/ATT: click alla pressione, rimbalzi ignorati in pressione e rilascio
+  std::vector<Edge> twoPresses = bouncyPress(0, 120);
+  std::vector<Edge> second = bouncyPress(300, 400);
+  twoPresses.insert(twoPresses.end(), second.begin(), second.end());
+  expect("click con rimbalzi", run(clickOnly, twoPresses, 600),
+         {{BUTTON_CLICK, 0}, {BUTTON_CLICK, 300}});
+
+  // STEP: con la pressione lunga il click arriva al rilascio
+  expect("breve con lungo", run(stepTiming, bouncyPress(0, 150), 1000), {{BUTTON_CLICK, 150}});
+  expect("lungo", run(stepTiming, bouncyPress(0, longMs + 300), 1500), {{BUTTON_LONG, longMs}});
+
+  // BAND: tenuto premuto, una ripetizione ogni repeatMs dopo il lungo
+  expect("lungo e ripetizioni", run(bandTiming, {{0, 0, true}, {longMs + 2 * repeatMs + 100, 0, false}}, 2000),
+         {{BUTTON_LONG, longMs}, {BUTTON_REPEAT, longMs + repeatMs}, {BUTTON_REPEAT, longMs + 2 * repeatMs}});
+
+  // MODE: seconda pressione dentro la finestra = doppio; da sola = click a fine finestra
+  std::vector<Edge> doubleClick = bouncyPress(0, 80);
+  std::vector<Edge> again = bouncyPress(200, 260);
+  doubleClick.insert(doubleClick.end(), again.begin(), again.end());
+  expect("doppio click", run(modeTiming, doubleClick, 1000), {{BUTTON_DOUBLE, 200}});
+  expect("click con doppio", run(modeTiming, bouncyPress(0, 80), 1000), {{BUTTON_CLICK, 80 + doubleMs}});
+  expect("seconda fuori finestra", run(modeTiming, [&] {
+           std::vector<Edge> e = bouncyPress(0, 80);
+           std::vector<Edge> late = bouncyPress(80 + doubleMs + 50, 80 + doubleMs + 120);
+           e.insert(e.end(), late.begin(), late.end());
+           return e;
+         }(), 1500),
+         {{BUTTON_CLICK, 80 + doubleMs}, {BUTTON_CLICK, 80 + 2 * doubleMs + 120}});
+
+  // Rilascio dentro la finestra di debounce: lo accetta poll() a fine finestra,
+  // e una nuova pressione subito dopo arriva a fine della finestra successiva
+  expect("rilascio nel debounce", run(stepTiming, {{0, 0, true}, {10, 0, false}}, 500),
+         {{BUTTON_CLICK, debounceMs}});
+  expect("tocco nel debounce", run(clickOnly, {{0, 0, true}, {10, 0, false}, {debounceMs + 20, 0, true}}, 500),
+         {{BUTTON_CLICK, 0}, {BUTTON_CLICK, 2 * debounceMs}});
+
+  // Loop bloccato per più periodi di ripetizione: una ripetizione, non una raffica
+  const uint32_t stallEnd = longMs + 4 * repeatMs + 50;
+  expect("loop bloccato", run(bandTiming, {{0, 0, true}}, stallEnd + repeatMs, 1000000, longMs, stallEnd),
+         {{BUTTON_LONG, longMs}, {BUTTON_REPEAT, stallEnd}, {BUTTON_REPEAT, stallEnd + repeatMs}});
+
+  // Giro di micros() durante la pressione lunga
+  const uint32_t nearWrap = UINT32_MAX - 300000;
+  expect("giro dei 32 bit", run(bandTiming, {{0, 0, true}, {longMs + repeatMs + 100, 0, false}}, 1500, nearWrap),
+         {{BUTTON_LONG, longMs}, {BUTTON_REPEAT, longMs + repeatMs}});
+
+  return allOk ? 0 : 1;
+}
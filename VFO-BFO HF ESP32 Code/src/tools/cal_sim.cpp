@@ -0,0 +1,154 @@
+// Simulazione su PC della calibrazione automatica (CAL_AUTO).
+// Usa la stessa ricerca del firmware (cal_search) su un ricevitore simulato:
+// quarzo del Si5351 fuori di un errore noto, portante di riferimento, curva
+// del filtro IF letta dall'ADC dell'S-meter con rumore. Per ogni caso controlla
+// che la correzione calcolata riporti il VFO entro la tolleranza: l'errore dei
+// fronti è in Hz, quindi in ppb pesa di più con riferimenti bassi.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e cal_sim
+//   .pio/build/cal_sim/program [opzioni]
+//
+// Opzioni:
+//   --ref HZ          Frequenza della portante di riferimento (default 10000000)
+//   --noise N         Rumore ADC massimo in conteggi (default 40)
+//   --max-hz HZ       Errore residuo accettato sul VFO in Hz (default 1.5)
+//   -v                Stampa ogni misura
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../config.h"
+#include "../cal_search.h"
+#include "../PLL_plan.h"
+
+// Forme del filtro IF: piatto al centro, fianchi a coseno rialzato
+struct IfFilter {
+  const char* name;
+  double width;               // Banda a -6dB (Hz)
+  double skirt;               // Larghezza di ciascun fianco (Hz)
+};
+
+static const IfFilter filters[] = {
+  {"CW 500", 500, 150},
+  {"SSB 2.4k", 2400, 400},
+  {"AM 6k", 6000, 800}
+};
+
+// Errori del quarzo (ppb) e correzioni già in uso
+static const int32_t crystalErrors[] = {-25000, -8000, -1200, 0, 3500, 15000, 30000};
+static const int32_t startCorrections[] = {0, 5000};
+
+static uint32_t noiseState = 12345;
+static int noiseAmplitude = 40;
+static bool verbose = false;
+
+static int noise() {
+  noiseState = noiseState * 1103515245 + 12345;
+  return (int)((noiseState >> 16) % (2 * noiseAmplitude + 1)) - noiseAmplitude;
+}
+
+// Risposta 0..1 del filtro a uno scostamento dal centro IF
+static double filterResponse(const IfFilter& filter, double offset) {
+  double edge = fabs(offset) - (filter.width - filter.skirt) / 2;
+  if (edge <= 0) return 1;
+  if (edge >= filter.skirt) return 0;
+  return 0.5 * (1 + cos(M_PI * edge / filter.skirt));
+}
+
+// ADC dell'S-meter: fondo + portante, media di CAL_AUTO_SAMPLES letture rumorose
+static uint16_t readSMeter(const IfFilter& filter, double offset) {
+  int sum = 0;
+  for (int i = 0; i < CAL_AUTO_SAMPLES; i++) {
+    int level = 250 + (int)(2400 * filterResponse(filter, offset)) + noise();
+    sum += level < 0 ? 0 : (level > 4095 ? 4095 : level);
+  }
+  return sum / CAL_AUTO_SAMPLES;
+}
+
+// Una calibrazione completa: errore residuo della correzione in ppb
+static bool runCase(const IfFilter& filter, uint32_t ref, int32_t crystalError, int32_t current, double& residual, uint16_t& points) {
+  // Riferimento vero del Si5351 e quello supposto con la correzione in uso
+  double trueRef = PLL_XTAL_FREQ * (1 + crystalError / 1e9);
+  double assumedRef = correctedRef(current);
+
+  CalSearch search;
+  if (!search.begin(ref, CAL_AUTO_SPAN, CAL_AUTO_COARSE_STEP, CAL_AUTO_FINE_STEP, CAL_AUTO_MIN_DELTA)) return false;
+
+  uint32_t freq;
+  while (search.next(freq)) {
+    // VFO reale = nominale * riferimento vero / supposto; la portante cade in IF
+    double vfo = (double)(freq + IF_FREQUENCY) * trueRef / assumedRef;
+    double offset = vfo - ((double)ref + IF_FREQUENCY);
+    uint16_t level = readSMeter(filter, offset);
+    if (verbose) printf("  %u Hz  scostamento %+8.1f Hz  ADC %4u\n", freq, offset, level);
+    search.report(level);
+  }
+  points = search.measurements();
+  if (!search.found()) return false;
+
+  uint64_t target = ((uint64_t)ref + IF_FREQUENCY) * 1000;
+  uint64_t measured = search.centerMilliHz() + (uint64_t)IF_FREQUENCY * 1000;
+  int32_t correction = calCorrection(current, target, measured);
+
+  // La correzione giusta è l'errore del quarzo: riferimento supposto = vero
+  residual = correction - crystalError;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  uint32_t ref = 10000000;
+  double maxHz = 1.5;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (value == nullptr) {
+      fprintf(stderr, "Opzione senza valore: %s\n", argv[i]);
+      return 2;
+    } else if (strcmp(argv[i], "--ref") == 0) {
+      ref = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--noise") == 0) {
+      noiseAmplitude = atoi(value); i++;
+    } else if (strcmp(argv[i], "--max-hz") == 0) {
+      maxHz = atof(value); i++;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  printf("Portante %u Hz, span %u Hz, passi %u/%u Hz, attesa %u ms per punto\n",
+         ref, (unsigned)CAL_AUTO_SPAN, (unsigned)CAL_AUTO_COARSE_STEP, (unsigned)CAL_AUTO_FINE_STEP,
+         (unsigned)CAL_AUTO_SETTLE_MS);
+
+  bool ok = true;
+  double worst = 0;
+  const double vfoMHz = (ref + IF_FREQUENCY) / 1e6;
+  uint16_t maxPoints = 0;
+  for (const IfFilter& filter : filters) {
+    for (int32_t current : startCorrections) {
+      for (int32_t error : crystalErrors) {
+        double residual = 0;
+        uint16_t points = 0;
+        bool found = runCase(filter, ref, error, current, residual, points);
+        bool pass = found && fabs(residual) * vfoMHz / 1000 <= maxHz;
+        printf("%-6s %-9s quarzo %+6d ppb, CAL %5d: %3u punti, ", pass ? "OK" : "ERRORE",
+               filter.name, error, current, points);
+        if (found) printf("residuo %+7.1f ppb (%+5.2f Hz)\n", residual, residual * vfoMHz / 1000);
+        else printf("portante non trovata\n");
+
+        ok &= pass;
+        if (found && fabs(residual) > worst) worst = fabs(residual);
+        if (points > maxPoints) maxPoints = points;
+      }
+    }
+  }
+
+  printf("Residuo peggiore %.1f ppb (%.2f Hz, max %.2f), %u punti = %.1f s\n",
+         worst, worst * vfoMHz / 1000, maxHz, maxPoints, maxPoints * CAL_AUTO_SETTLE_MS / 1000.0);
+  return ok ? 0 : 1;
+}
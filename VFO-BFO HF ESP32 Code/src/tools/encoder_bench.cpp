@@ -0,0 +1,249 @@
+// Banco di prova su PC del decodificatore degli encoder (quadrature.cpp).
+// Rigioca tracce di fronti CLK/DT campionandole come fa il loop, con il periodo
+// di lettura scelto, e confronta gli scatti decodificati con quelli attesi:
+// scatti persi, scatti doppi e tempo di decodifica per campione.
+//
+// Tracce sintetiche: rotazioni a velocità diverse con rimbalzi casuali dei
+// contatti a ogni fronte, inversioni di verso, loop lento (fronti saltati).
+// Tracce registrate: CSV di un analizzatore logico (tempo in s, CLK, DT).
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e encoder_bench
+//   .pio/build/encoder_bench/program [opzioni]
+//
+// Opzioni:
+//   --trace FILE      Traccia registrata: righe "tempo_s,CLK,DT" (intestazioni ignorate)
+//   --expect N        Scatti netti attesi nella traccia registrata
+//   --sample-us US    Periodo di lettura per la traccia registrata (default 200)
+//   --stable-us US    Filtro di stabilità del decodificatore (default 0)
+//   --per-detent N    Passi di quadratura per scatto (default ENC_COUNTS_PER_STEP)
+//   --seed N          Seme delle tracce sintetiche
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../config.h"
+#include "../quadrature.h"
+
+struct Edge {
+  uint64_t us;
+  uint8_t state;              // (CLK << 1) | DT dopo il fronte
+};
+
+struct Scenario {
+  const char* name;
+  uint32_t detents;
+  uint32_t detentUs;          // Tempo per scatto (velocità)
+  uint32_t bounceUs;          // Finestra dei rimbalzi dopo ogni fronte
+  uint8_t maxBounces;         // Rimbalzi massimi per fronte
+  uint32_t reverseEvery;      // Inversione di verso ogni N scatti (0 = mai)
+  uint32_t sampleUs;          // Periodo di lettura del loop
+  uint32_t stableUs;          // Filtro del decodificatore
+  bool lossless;              // false: perdite attese (solo dimostrazione)
+};
+
+static const Scenario scenarios[] = {
+  {"VFO lento, pulito",        200, 50000,    0, 0,  0,  200,    0, true},
+  {"VFO lento, rimbalzi",      200, 50000,  800, 6,  0,  200,    0, true},
+  {"VFO veloce, rimbalzi",     500,  5000,  300, 4,  0,  100,    0, true},
+  {"VFO inversioni, rimbalzi", 400, 10000,  500, 5,  7,  100,    0, true},
+  {"BFO pitch, filtro 3ms",    100, 40000, 1500, 8,  9,  500, 3000, true},
+  {"VFO loop bloccato 3ms",    300,  4000,  200, 3,  0, 3000,    0, false}
+};
+
+// Sequenza in avanti: 11 -> 01 -> 00 -> 10 -> 11
+static const uint8_t forward[4] = {0b11, 0b01, 0b00, 0b10};
+
+static uint8_t phaseOf(uint8_t state) {
+  for (uint8_t i = 0; i < 4; i++) {
+    if (forward[i] == state) return i;
+  }
+  return 0;
+}
+
+// Traccia sintetica: passi di quadratura equidistanti, ogni fronte seguito da
+// rimbalzi del solo pin che ha cambiato. Ritorna gli scatti attesi per verso.
+static std::vector<Edge> synthesize(const Scenario& sc, uint8_t perDetent, std::mt19937& rng,
+                                    uint32_t& expectedUp, uint32_t& expectedDown) {
+  std::vector<Edge> edges;
+  uint8_t state = 0b11;
+  uint64_t t = 1000;
+  int direction = 1;
+  expectedUp = expectedDown = 0;
+
+  const uint32_t stepUs = sc.detentUs / perDetent;
+  for (uint32_t d = 0; d < sc.detents; d++) {
+    if (sc.reverseEvery && d > 0 && d % sc.reverseEvery == 0) direction = -direction;
+    (direction > 0 ? expectedUp : expectedDown)++;
+
+    for (uint8_t s = 0; s < perDetent; s++) {
+      uint8_t next = forward[(phaseOf(state) + (direction > 0 ? 1 : 3)) % 4];
+      uint8_t changed = state ^ next;
+
+      // Rimbalzi: il pin oscilla tra vecchio e nuovo valore e poi si ferma
+      uint8_t bounces = sc.maxBounces ? rng() % (sc.maxBounces + 1) : 0;
+      uint64_t when = t;
+      uint8_t level = next;
+      for (uint8_t b = 0; b < 2 * bounces; b++) {
+        edges.push_back({when, level});
+        when += 1 + rng() % (sc.bounceUs / (2 * bounces) + 1);
+        level ^= changed;
+      }
+      edges.push_back({when, next});
+
+      state = next;
+      t += stepUs;
+    }
+  }
+  edges.push_back({t + sc.detentUs, state});
+  return edges;
+}
+
+// Letture del loop: stato dei pin a intervalli di sampleUs (+-10% di variazione)
+static void sample(const std::vector<Edge>& edges, uint32_t sampleUs, std::mt19937& rng,
+                   std::vector<uint8_t>& states, std::vector<uint32_t>& times) {
+  states.clear();
+  times.clear();
+  uint8_t state = 0b11;
+  size_t next = 0;
+  uint64_t end = edges.empty() ? 0 : edges.back().us;
+  for (uint64_t t = 0; t <= end; t += sampleUs * 9 / 10 + rng() % (sampleUs / 5 + 1)) {
+    while (next < edges.size() && edges[next].us <= t) state = edges[next++].state;
+    states.push_back(state);
+    times.push_back((uint32_t)t);
+  }
+}
+
+struct Result {
+  uint32_t up = 0, down = 0;
+  uint32_t skipped = 0;
+  double nsPerSample = 0;
+};
+
+static Result decode(const std::vector<uint8_t>& states, const std::vector<uint32_t>& times,
+                     uint8_t perDetent, uint32_t stableUs) {
+  Result result;
+  QuadratureDecoder decoder;
+  decoder.begin(states.empty() ? 0b11 : states[0], perDetent, stableUs);
+  for (size_t i = 0; i < states.size(); i++) {
+    int8_t detents = decoder.update(states[i], times[i]);
+    if (detents > 0) result.up += detents;
+    if (detents < 0) result.down -= detents;
+  }
+  result.skipped = decoder.skipped();
+
+  // Tempo: stessa sequenza ripetuta fino a qualche milione di campioni
+  const size_t repeat = 4000000 / (states.size() + 1) + 1;
+  volatile int32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < repeat; r++) {
+    decoder.begin(states[0], perDetent, stableUs);
+    for (size_t i = 0; i < states.size(); i++) sink += decoder.update(states[i], times[i]);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  result.nsPerSample = std::chrono::duration<double, std::nano>(elapsed).count() / (repeat * states.size());
+  (void)sink;
+  return result;
+}
+
+// Persi/doppi per verso: scatti attesi non decodificati e decodificati in più
+static void report(const char* name, uint32_t expectedUp, uint32_t expectedDown, const Result& r,
+                   size_t samples, bool lossless, bool& ok) {
+  uint32_t lost = (expectedUp > r.up ? expectedUp - r.up : 0) + (expectedDown > r.down ? expectedDown - r.down : 0);
+  uint32_t doubled = (r.up > expectedUp ? r.up - expectedUp : 0) + (r.down > expectedDown ? r.down - expectedDown : 0);
+  bool pass = !lossless || (lost == 0 && doubled == 0);
+  ok &= pass;
+
+  printf("%-6s %-26s attesi +%u/-%u, letti +%u/-%u, persi %u, doppi %u, salti %u, %zu campioni, %.1f ns/campione%s\n",
+         pass ? "OK" : "ERRORE", name, expectedUp, expectedDown, r.up, r.down, lost, doubled,
+         r.skipped, samples, r.nsPerSample, lossless ? "" : " (perdite attese)");
+}
+
+// Traccia registrata: "tempo_s,CLK,DT" oppure "tempo_s CLK DT"
+static bool loadTrace(const char* path, std::vector<Edge>& edges) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    perror(path);
+    return false;
+  }
+  char line[256];
+  double t0 = -1;
+  while (fgets(line, sizeof(line), file)) {
+    double seconds;
+    int clk, dt;
+    for (char* c = line; *c; c++) {
+      if (*c == ',' || *c == ';' || *c == '\t') *c = ' ';
+    }
+    if (sscanf(line, "%lf %d %d", &seconds, &clk, &dt) != 3) continue;   // Intestazioni
+    if (t0 < 0) t0 = seconds;
+    edges.push_back({(uint64_t)((seconds - t0) * 1e6) + 1000, (uint8_t)(((clk & 1) << 1) | (dt & 1))});
+  }
+  fclose(file);
+  return !edges.empty();
+}
+
+int main(int argc, char** argv) {
+  const char* tracePath = nullptr;
+  long expected = 0;
+  bool haveExpected = false;
+  uint32_t sampleUs = 200;
+  uint32_t stableUs = 0;
+  uint8_t perDetent = ENC_COUNTS_PER_STEP;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      fprintf(stderr, "Opzione senza valore: %s\n", argv[i]);
+      return 2;
+    } else if (strcmp(argv[i], "--trace") == 0) {
+      tracePath = value; i++;
+    } else if (strcmp(argv[i], "--expect") == 0) {
+      expected = atol(value); haveExpected = true; i++;
+    } else if (strcmp(argv[i], "--sample-us") == 0) {
+      sampleUs = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--stable-us") == 0) {
+      stableUs = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--per-detent") == 0) {
+      perDetent = atoi(value); i++;
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(value, nullptr, 10); i++;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  bool ok = true;
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> states;
+  std::vector<uint32_t> times;
+
+  if (tracePath != nullptr) {
+    std::vector<Edge> edges;
+    if (!loadTrace(tracePath, edges)) return 2;
+    sample(edges, sampleUs, rng, states, times);
+    Result r = decode(states, times, perDetent, stableUs);
+    long net = (long)r.up - (long)r.down;
+    printf("%s: %zu fronti, letti +%u/-%u (netto %ld), salti %u, %.1f ns/campione\n",
+           tracePath, edges.size(), r.up, r.down, net, r.skipped, r.nsPerSample);
+    if (haveExpected) {
+      ok = net == expected;
+      printf("%-6s netto atteso %ld\n", ok ? "OK" : "ERRORE", expected);
+    }
+    return ok ? 0 : 1;
+  }
+
+  for (const Scenario& sc : scenarios) {
+    uint32_t up, down;
+    std::vector<Edge> edges = synthesize(sc, perDetent, rng, up, down);
+    sample(edges, sc.sampleUs, rng, states, times);
+    Result r = decode(states, times, perDetent, sc.stableUs);
+    report(sc.name, up, down, r, states.size(), sc.lossless, ok);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Arduino-ESP32 ridotto per i banchi di prova su PC (host_sim.h): solo quanto
+// usano i moduli compilati sul PC, con tempi e pin simulati.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+int analogRead(uint8_t pin);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+class String {
+public:
+  String() {}
+  String(const char* s) : text(s ? s : "") {}
+  String(char c) : text(1, c) {}
+  String(int v) : text(std::to_string(v)) {}
+  String(unsigned int v) : text(std::to_string(v)) {}
+  String(long v) : text(std::to_string(v)) {}
+  String(unsigned long v) : text(std::to_string(v)) {}
+
+  unsigned int length() const { return text.size(); }
+  const char* c_str() const { return text.c_str(); }
+  char operator[](unsigned int i) const { return text[i]; }
+
+  bool operator==(const String& o) const { return text == o.text; }
+  bool operator!=(const String& o) const { return text != o.text; }
+  String operator+(const String& o) const { return String((text + o.text).c_str()); }
+  String& operator+=(const String& o) { text += o.text; return *this; }
+
+private:
+  std::string text;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const char* s, size_t len);
+
+  size_t print(const char* s) { return write(s, strlen(s)); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(char c) { return write(&c, 1); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+
+  size_t println() { return print("\n"); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+  template <typename T> size_t println(T v, int f) { return print(v, f) + println(); }
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  int available() { return 0; }
+  int read() { return -1; }
+  size_t write(const char* s, size_t len) override;
+};
+
+extern HardwareSerial Serial;
+
+// Cicli CPU a 240MHz dall'orologio virtuale
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+};
+
+extern EspClass ESP;
+
+#endif
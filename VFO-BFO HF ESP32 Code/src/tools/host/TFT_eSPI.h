@@ -0,0 +1,92 @@
+#ifndef TFT_ESPI_H
+#define TFT_ESPI_H
+
+// TFT_eSPI ridotto per i banchi di prova su PC (host_sim.h): non disegna
+// niente, addebita al core corrente il tempo di bus SPI di ogni primitiva
+// (16 bit per pixel della zona scritta). Gli sprite sono in RAM: costa solo
+// pushSprite(), a 16 bit per pixel qualunque sia la profondità di colore
+// (i colori si espandono in RGB565 durante l'invio). I caratteri contano come
+// il loro riquadro pieno.
+
+#include <Arduino.h>
+
+#define TFT_BLACK     0x0000
+#define TFT_WHITE     0xFFFF
+#define TFT_RED       0xF800
+#define TFT_GREEN     0x07E0
+#define TFT_YELLOW    0xFFE0
+#define TFT_ORANGE    0xFDA0
+#define TFT_SKYBLUE   0x867D
+#define TFT_DARKGREY  0x7BEF
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t w = 240, int16_t h = 320) : width(w), height(h) {}
+
+  void init() {}
+  void setRotation(uint8_t r) { if (r & 1) std::swap(width, height); }
+  void fillScreen(uint32_t color) { pixels(width, height); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) { pixels(w, h); }
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) { pixels(w, h); }
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) { outline(w, h); }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) { outline(w, h); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { pixels(w, 1); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { pixels(1, h); }
+  void drawPixel(int32_t x, int32_t y, uint32_t color) { pixels(1, 1); }
+
+  // DMA: una striscia alla volta, il bus lavora mentre il core va avanti
+  bool initDMA(bool ctrlCS = false) { return true; }
+  void startWrite() {}
+  void endWrite() {}
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* image, uint16_t* buffer = nullptr);
+  bool dmaBusy();
+  void dmaWait();
+
+  void setTextColor(uint16_t fg) {}
+  void setTextColor(uint16_t fg, uint16_t bg, bool fill = false) {}
+  void setTextFont(uint8_t f) { font = f; }
+  void setTextSize(uint8_t s) { size = s ? s : 1; }
+  void setCursor(int16_t x, int16_t y) {}
+
+  int16_t drawString(const char* s, int32_t x, int32_t y);
+  int16_t drawString(const String& s, int32_t x, int32_t y) { return drawString(s.c_str(), x, y); }
+  int16_t drawChar(uint16_t c, int32_t x, int32_t y) { pixels(glyphWidth(), glyphHeight()); return glyphWidth(); }
+  int16_t textWidth(const char* s) { return strlen(s) * glyphWidth(); }
+  size_t write(const char* s, size_t len) override;
+
+protected:
+  void pixels(int32_t w, int32_t h);
+  void outline(int32_t w, int32_t h) { pixels(w, 1); pixels(w, 1); pixels(1, h); pixels(1, h); }
+  int16_t glyphWidth() const;
+  int16_t glyphHeight() const;
+
+  int16_t width, height;
+  uint8_t font = 1;
+  uint8_t size = 1;
+  bool sprite = false;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI* tft) { sprite = true; }
+
+  void* setColorDepth(int8_t bits) { bpp = bits; return nullptr; }
+  int8_t getColorDepth() { return bpp; }
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite() {}
+  void fillSprite(uint32_t color) {}
+  void setBitmapColor(uint16_t fg, uint16_t bg) {}
+  void createPalette(uint16_t* palette = nullptr, uint8_t colors = 16) {}
+  void pushSprite(int32_t x, int32_t y);
+  bool pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+
+  // Lettura dei pixel (espansione verso il DMA): costa CPU, restituisce sfondo
+  uint16_t readPixelValue(int32_t x, int32_t y);
+  uint16_t readPixel(int32_t x, int32_t y) { return readPixelValue(x, y); }
+  uint16_t getPaletteColor(uint8_t index) { return 0; }
+
+private:
+  int8_t bpp = 16;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <Arduino.h>
+
+// Bus I2C simulato (host_sim.h): ogni transazione occupa il core per il
+// tempo di bus al clock impostato. Le scritture al Si5351 aggiornano la sua
+// copia dei registri; le letture restituiscono 0xFF.
+
+class TwoWire {
+public:
+  bool begin(int sda, int scl) { return true; }
+  void setClock(uint32_t hz);
+  void setTimeout(uint16_t ms) {}
+
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t* data, size_t len);
+  uint8_t endTransmission(bool stop = true);
+
+  uint8_t requestFrom(int address, int len);
+  int available();
+  int read();
+
+private:
+  uint8_t address = 0;
+  uint8_t buffer[64];
+  size_t length = 0;
+  int pendingRead = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,498 @@
+// Back-end simulati dei banchi di prova su PC: vedi host_sim.h
+
+#include "host_sim.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <TFT_eSPI.h>
+#include <si5351.h>
+#include <driver/pcnt.h>
+#include <deque>
+
+SimCosts simCosts;
+uint8_t simCore = 1;
+bool simSerialEcho = false;
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+// ==================== OROLOGIO ====================
+
+static uint64_t clockNs[2] = {0, 0};
+
+uint64_t simNowNs() {
+  return clockNs[simCore];
+}
+
+void simSetNowNs(uint64_t ns) {
+  if (ns > clockNs[simCore]) clockNs[simCore] = ns;
+}
+
+void simCharge(uint64_t ns) {
+  clockNs[simCore] += ns;
+}
+
+unsigned long millis() {
+  return simNowNs() / 1000000;
+}
+
+unsigned long micros() {
+  return simNowNs() / 1000;
+}
+
+void delay(unsigned long ms) {
+  simCharge((uint64_t)ms * 1000000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  simCharge((uint64_t)us * 1000);
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(simNowNs() * 240 / 1000);
+}
+
+// ==================== PIN E PCNT ====================
+
+#define SIM_PINS 40
+
+struct PinEvent {
+  uint64_t ns;
+  uint8_t pin;
+  uint8_t level;
+  bool glitch;                // Impulso più corto del filtro PCNT: non conta
+};
+
+static std::deque<PinEvent> pinEvents;
+static uint8_t pinLevels[SIM_PINS];
+static bool pinLevelsReady = false;
+static int analogValues[SIM_PINS];
+static void (*pinHook)(uint8_t, uint8_t, uint64_t) = nullptr;
+
+struct SimPcntUnit {
+  pcnt_config_t channels[PCNT_CHANNEL_MAX];
+  bool configured[PCNT_CHANNEL_MAX];
+  uint32_t filterNs;
+  bool running;
+  int16_t count;
+};
+
+static SimPcntUnit pcntUnits[PCNT_UNIT_MAX];
+
+// Pull-up: a riposo i pin stanno alti
+static void initPins() {
+  if (pinLevelsReady) return;
+  memset(pinLevels, HIGH, sizeof(pinLevels));
+  pinLevelsReady = true;
+}
+
+static uint32_t pcntFilterNs(uint8_t pin) {
+  for (const SimPcntUnit& u : pcntUnits) {
+    for (uint8_t ch = 0; ch < PCNT_CHANNEL_MAX; ch++) {
+      if (u.configured[ch] && (u.channels[ch].pulse_gpio_num == pin || u.channels[ch].ctrl_gpio_num == pin)) {
+        return u.filterNs;
+      }
+    }
+  }
+  return 0;
+}
+
+static void pcntEdge(uint8_t pin, uint8_t level) {
+  for (SimPcntUnit& u : pcntUnits) {
+    if (!u.running) continue;
+    for (uint8_t ch = 0; ch < PCNT_CHANNEL_MAX; ch++) {
+      const pcnt_config_t& c = u.channels[ch];
+      if (!u.configured[ch] || c.pulse_gpio_num != pin) continue;
+
+      pcnt_count_mode_t mode = level ? c.pos_mode : c.neg_mode;
+      pcnt_ctrl_mode_t ctrl = pinLevels[c.ctrl_gpio_num] ? c.hctrl_mode : c.lctrl_mode;
+      if (mode == PCNT_COUNT_DIS || ctrl == PCNT_MODE_DISABLE) continue;
+      int8_t delta = mode == PCNT_COUNT_INC ? 1 : -1;
+      if (ctrl == PCNT_MODE_REVERSE) delta = -delta;
+
+      // Raggiunto un limite il contatore torna a 0
+      u.count += delta;
+      if (u.count >= c.counter_h_lim || u.count <= c.counter_l_lim) u.count = 0;
+    }
+  }
+}
+
+// Applica i cambi dei pin fino all'istante corrente
+static void applyPins() {
+  initPins();
+  uint64_t now = simNowNs();
+  while (!pinEvents.empty() && pinEvents.front().ns <= now) {
+    PinEvent e = pinEvents.front();
+    pinEvents.pop_front();
+    if (pinLevels[e.pin] == e.level) continue;
+
+    // Filtro PCNT: un impulso più corto del filtro sparisce con entrambi i fronti
+    uint32_t filter = pcntFilterNs(e.pin);
+    if (filter && !e.glitch) {
+      for (PinEvent& next : pinEvents) {
+        if (next.ns - e.ns >= filter) break;
+        if (next.pin == e.pin) {
+          e.glitch = next.glitch = true;
+          break;
+        }
+      }
+    }
+
+    pinLevels[e.pin] = e.level;
+    if (!e.glitch) pcntEdge(e.pin, e.level);
+    if (pinHook != nullptr) pinHook(e.pin, e.level, e.ns);
+  }
+}
+
+void simSchedulePin(uint64_t ns, uint8_t pin, uint8_t level) {
+  pinEvents.push_back({ns, pin, level, false});
+}
+
+void simSetPinHook(void (*hook)(uint8_t pin, uint8_t level, uint64_t ns)) {
+  pinHook = hook;
+}
+
+void simSetAnalog(uint8_t pin, int value) {
+  analogValues[pin] = value;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t level) {}
+
+int digitalRead(uint8_t pin) {
+  applyPins();
+  return pinLevels[pin];
+}
+
+int analogRead(uint8_t pin) {
+  simCharge(simCosts.analogReadNs);
+  return analogValues[pin];
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+esp_err_t pcnt_unit_config(const pcnt_config_t* config) {
+  if (config->unit >= PCNT_UNIT_MAX || config->channel >= PCNT_CHANNEL_MAX) return ESP_FAIL;
+  SimPcntUnit& u = pcntUnits[config->unit];
+  u.channels[config->channel] = *config;
+  u.configured[config->channel] = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t cycles) {
+  pcntUnits[unit].filterNs = cycles * 25 / 2;     // Cicli APB a 80MHz
+  return ESP_OK;
+}
+
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit) { return ESP_OK; }
+
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit) {
+  pcntUnits[unit].running = false;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit) {
+  pcntUnits[unit].count = 0;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit) {
+  initPins();
+  pcntUnits[unit].running = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count) {
+  applyPins();
+  *count = pcntUnits[unit].count;
+  return ESP_OK;
+}
+
+// ==================== I2C ====================
+
+static uint32_t i2cHz = 100000;     // Default di Arduino-ESP32
+static uint32_t i2cTransactions[128];
+static uint8_t si5351Regs[256];
+static uint8_t si5351ReadReg = 0;
+
+static void chargeI2C(size_t bytes) {
+  // 9 bit per byte (8 + ACK), indirizzo compreso
+  simCharge(simCosts.i2cTransactionNs + (uint64_t)(bytes + 1) * 9 * 1000000000ULL / i2cHz);
+}
+
+void TwoWire::setClock(uint32_t hz) {
+  i2cHz = hz;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  address = addr;
+  length = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (length >= sizeof(buffer)) return 0;
+  buffer[length++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+  size_t n = 0;
+  while (n < len && write(data[n])) n++;
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+  chargeI2C(length);
+  i2cTransactions[address & 0x7F]++;
+
+  // Si5351: primo byte = registro, poi auto-incremento
+  if (address == SI5351_BUS_BASE_ADDR && length > 0) {
+    uint8_t reg = buffer[0];
+    si5351ReadReg = reg;
+    for (size_t i = 1; i < length; i++) si5351Regs[(uint8_t)(reg + i - 1)] = buffer[i];
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(int addr, int len) {
+  chargeI2C(len);
+  i2cTransactions[addr & 0x7F]++;
+  address = addr;
+  pendingRead = len;
+  return len;
+}
+
+int TwoWire::available() {
+  return pendingRead;
+}
+
+int TwoWire::read() {
+  if (pendingRead == 0) return -1;
+  pendingRead--;
+  if (address == SI5351_BUS_BASE_ADDR) return si5351Regs[si5351ReadReg++];
+  return 0xFF;
+}
+
+uint32_t simI2CHz() {
+  return i2cHz;
+}
+
+uint32_t simI2CTransactions(uint8_t address) {
+  return i2cTransactions[address & 0x7F];
+}
+
+const uint8_t* simSi5351Registers() {
+  return si5351Regs;
+}
+
+// ==================== SI5351 ====================
+
+uint8_t Si5351::si5351_write(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(SI5351_BUS_BASE_ADDR);
+  Wire.write(reg);
+  Wire.write(value);
+  return Wire.endTransmission();
+}
+
+uint8_t Si5351::si5351_read(uint8_t reg) {
+  Wire.beginTransmission(SI5351_BUS_BASE_ADDR);
+  Wire.write(reg);
+  Wire.endTransmission(false);
+  Wire.requestFrom(SI5351_BUS_BASE_ADDR, 1);
+  return Wire.read();
+}
+
+// Come dopo l'accensione: uscite spente, clock in power down
+bool Si5351::init(uint8_t xtalLoad, uint32_t xtalFreq, int32_t correction) {
+  si5351_write(SI5351_OUTPUT_ENABLE_CTRL, 0xFF);
+  for (uint8_t reg = SI5351_CLK0_CTRL; reg <= SI5351_CLK2_CTRL; reg++) si5351_write(reg, SI5351_CLK_POWERDOWN);
+  si5351_write(SI5351_CRYSTAL_LOAD, xtalLoad);
+  return true;
+}
+
+void Si5351::drive_strength(enum si5351_clock clk, enum si5351_drive drive) {
+  uint8_t reg = SI5351_CLK0_CTRL + clk;
+  si5351_write(reg, (si5351_read(reg) & ~0x03) | drive);
+}
+
+void Si5351::output_enable(enum si5351_clock clk, uint8_t enable) {
+  uint8_t value = si5351_read(SI5351_OUTPUT_ENABLE_CTRL);
+  value = enable ? value & ~(1 << clk) : value | (1 << clk);
+  si5351_write(SI5351_OUTPUT_ENABLE_CTRL, value);
+}
+
+void Si5351::set_clock_pwr(enum si5351_clock clk, uint8_t power) {
+  uint8_t reg = SI5351_CLK0_CTRL + clk;
+  uint8_t value = si5351_read(reg);
+  si5351_write(reg, power ? value & ~SI5351_CLK_POWERDOWN : value | SI5351_CLK_POWERDOWN);
+}
+
+void Si5351::set_ms_source(enum si5351_clock clk, enum si5351_pll pll) {
+  uint8_t reg = SI5351_CLK0_CTRL + clk;
+  uint8_t value = si5351_read(reg);
+  si5351_write(reg, pll == SI5351_PLLB ? value | SI5351_CLK_PLL_SELECT : value & ~SI5351_CLK_PLL_SELECT);
+}
+
+// Rapporto del PLL a + b / c (c = 2^20 - 1) nel blocco di 8 registri (AN619)
+void Si5351::set_pll(uint64_t freq, enum si5351_pll pll) {
+  pllFreq[pll] = freq;
+  double ref = 25000000.0 * (1.0 + refCorrection / 1e9);
+  double ratio = freq / 100.0 / ref;
+  uint32_t c = 1048575;
+  uint32_t a = (uint32_t)ratio;
+  uint32_t b = (uint32_t)((ratio - a) * c);
+  uint32_t p1 = 128 * a + (128 * (uint64_t)b / c) - 512;
+  uint32_t p2 = 128 * (uint64_t)b - c * (uint32_t)(128 * (uint64_t)b / c);
+  uint8_t regs[8] = {
+    (uint8_t)(c >> 8), (uint8_t)c, (uint8_t)((p1 >> 16) & 0x03), (uint8_t)(p1 >> 8), (uint8_t)p1,
+    (uint8_t)(((c >> 12) & 0xF0) | ((p2 >> 16) & 0x0F)), (uint8_t)(p2 >> 8), (uint8_t)p2
+  };
+
+  Wire.beginTransmission(SI5351_BUS_BASE_ADDR);
+  Wire.write(pll == SI5351_PLLA ? SI5351_PLLA_PARAMETERS : SI5351_PLLB_PARAMETERS);
+  Wire.write(regs, sizeof(regs));
+  Wire.endTransmission();
+}
+
+void Si5351::set_correction(int32_t correction, enum si5351_pll_input input) {
+  refCorrection = correction;
+  set_pll(pllFreq[SI5351_PLLA], SI5351_PLLA);
+  set_pll(pllFreq[SI5351_PLLB], SI5351_PLLB);
+}
+
+void Si5351::pll_reset(enum si5351_pll pll) {
+  si5351_write(SI5351_PLL_RESET, pll == SI5351_PLLA ? SI5351_PLL_RESET_A : SI5351_PLL_RESET_B);
+}
+
+// ==================== DISPLAY ====================
+
+static uint64_t spiBusyNs = 0;
+
+static void chargeSpi(uint64_t pixelCount) {
+  uint64_t ns = simCosts.spiTransactionNs + pixelCount * 16 * 1000000000ULL / simCosts.spiHz;
+  simCharge(ns);
+  spiBusyNs += ns;
+}
+
+uint64_t simSpiBusyNs() {
+  return spiBusyNs;
+}
+
+void TFT_eSPI::pixels(int32_t w, int32_t h) {
+  if (sprite || w <= 0 || h <= 0) return;
+  chargeSpi((uint64_t)w * h);
+}
+
+// Riquadro dei caratteri dei font di TFT_eSPI (1 = GLCD, 7 = 7 segmenti)
+int16_t TFT_eSPI::glyphWidth() const {
+  static const uint8_t widths[9] = {6, 6, 9, 6, 14, 6, 24, 32, 55};
+  return widths[font < 9 ? font : 1] * size;
+}
+
+int16_t TFT_eSPI::glyphHeight() const {
+  static const uint8_t heights[9] = {8, 8, 16, 8, 26, 8, 48, 48, 75};
+  return heights[font < 9 ? font : 1] * size;
+}
+
+int16_t TFT_eSPI::drawString(const char* s, int32_t x, int32_t y) {
+  for (size_t i = strlen(s); i > 0; i--) pixels(glyphWidth(), glyphHeight());
+  return textWidth(s);
+}
+
+size_t TFT_eSPI::write(const char* s, size_t len) {
+  for (size_t i = 0; i < len; i++) pixels(glyphWidth(), glyphHeight());
+  return len;
+}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+  width = w;
+  height = h;
+  return this;
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  chargeSpi((uint64_t)width * height);
+}
+
+bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh) {
+  chargeSpi((uint64_t)sw * sh);
+  return true;
+}
+
+// DMA: trasferimento sul bus mentre il core prosegue, una striscia in coda
+// (come TFT_eSPI: pushImageDMA() attende la precedente). Fine sull'orologio
+// del core che l'ha avviato
+static uint64_t dmaDoneNs = 0;
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* image, uint16_t* buffer) {
+  dmaWait();
+  simCharge(simCosts.spiTransactionNs);       // Finestra di indirizzi, a CPU
+  uint64_t ns = (uint64_t)w * h * 16 * 1000000000ULL / simCosts.spiHz;
+  dmaDoneNs = simNowNs() + ns;
+  spiBusyNs += simCosts.spiTransactionNs + ns;
+}
+
+bool TFT_eSPI::dmaBusy() {
+  return simNowNs() < dmaDoneNs;
+}
+
+void TFT_eSPI::dmaWait() {
+  if (dmaBusy()) simSetNowNs(dmaDoneNs);
+}
+
+uint16_t TFT_eSprite::readPixelValue(int32_t x, int32_t y) {
+  simCharge(simCosts.spritePixelNs);
+  return 0;
+}
+
+// ==================== SERIALE ====================
+
+size_t Print::write(const char* s, size_t len) {
+  return len;
+}
+
+size_t HardwareSerial::write(const char* s, size_t len) {
+  if (simSerialEcho) fwrite(s, 1, len, stdout);
+  return len;
+}
+
+size_t Print::print(long v, int base) {
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%ld", v);
+  return print(text);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", v);
+  return print(text);
+}
+
+size_t Print::print(double v, int digits) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.*f", digits, v);
+  return print(text);
+}
+
+// ==================== FREERTOS ====================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  if (handle != nullptr) *handle = (TaskHandle_t)task;
+  return pdPASS;
+}
+
+TickType_t xTaskGetTickCount() {
+  return millis();
+}
+
+void vTaskDelayUntil(TickType_t* wake, TickType_t period) {
+  *wake += period;
+  simSetNowNs((uint64_t)*wake * 1000000);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return 0;
+}
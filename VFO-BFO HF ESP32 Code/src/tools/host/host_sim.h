@@ -0,0 +1,45 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+
+// Back-end simulati per compilare su PC i moduli del firmware (Arduino, Wire,
+// TFT_eSPI, Si5351, PCNT, FreeRTOS): le intestazioni di questa cartella
+// prendono il posto di quelle vere con -I src/tools/host.
+//
+// Orologio virtuale in ns, uno per core: micros()/millis() leggono quello del
+// core che sta eseguendo (simCore). Il codice gira a velocità di PC e non costa
+// niente; costano i bus (I2C, SPI, ADC) con i tempi di SimCosts, più quanto
+// addebitato a mano con simCharge(). I pin cambiano a tempi programmati e si
+// applicano quando il core 1 li osserva (digitalRead, contatore PCNT).
+
+struct SimCosts {
+  uint32_t i2cTransactionNs = 60000;  // Driver I2C dell'IDF: start, indirizzo, stop, attesa
+  uint32_t spiHz = 40000000;          // Clock SPI del display
+  uint32_t spiTransactionNs = 1500;   // Finestra di indirizzi e CS per ogni primitiva
+  uint32_t analogReadNs = 10000;      // Conversione ADC
+  uint32_t spritePixelNs = 150;       // readPixelValue() e tavolozza, per pixel
+};
+
+extern SimCosts simCosts;
+extern uint8_t simCore;               // Core che sta eseguendo (0 o 1)
+extern bool simSerialEcho;            // Serial su stdout (default: scartato)
+
+uint64_t simNowNs();                  // Orologio del core corrente
+void simSetNowNs(uint64_t ns);        // Solo in avanti
+void simCharge(uint64_t ns);          // Il core corrente è occupato per ns
+
+// Pin: cambi di livello programmati in ordine di tempo
+void simSchedulePin(uint64_t ns, uint8_t pin, uint8_t level);
+void simSetPinHook(void (*hook)(uint8_t pin, uint8_t level, uint64_t ns));
+void simSetAnalog(uint8_t pin, int value);
+
+// Bus I2C: clock da Wire.setClock(), registri del Si5351 (0x60) tenuti in copia
+uint32_t simI2CHz();
+uint32_t simI2CTransactions(uint8_t address);
+const uint8_t* simSi5351Registers();
+
+// Display: tempo totale passato sul bus SPI (anche in DMA)
+uint64_t simSpiBusyNs();
+
+#endif
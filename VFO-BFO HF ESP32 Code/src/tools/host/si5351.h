@@ -0,0 +1,57 @@
+#ifndef SI5351_H
+#define SI5351_H
+
+// Libreria Etherkit Si5351 ridotta per i banchi di prova su PC (host_sim.h):
+// le funzioni di configurazione scrivono i registri veri sul bus simulato.
+
+#include <stdint.h>
+
+#define SI5351_BUS_BASE_ADDR        0x60
+#define SI5351_PLL_FIXED            80000000000ULL
+#define SI5351_CRYSTAL_LOAD_8PF     (2 << 6)
+
+#define SI5351_OUTPUT_ENABLE_CTRL   3
+#define SI5351_CLK0_CTRL            16
+#define SI5351_CLK1_CTRL            17
+#define SI5351_CLK2_CTRL            18
+#define SI5351_PLLA_PARAMETERS      26
+#define SI5351_PLLB_PARAMETERS      34
+#define SI5351_CLK0_PARAMETERS      42
+#define SI5351_CLK1_PARAMETERS      50
+#define SI5351_CLK2_PARAMETERS      58
+#define SI5351_PLL_RESET            177
+#define SI5351_CRYSTAL_LOAD         183
+
+#define SI5351_CLK_POWERDOWN        (1 << 7)
+#define SI5351_CLK_INTEGER_MODE     (1 << 6)
+#define SI5351_CLK_PLL_SELECT       (1 << 5)
+#define SI5351_PLL_RESET_B          (1 << 7)
+#define SI5351_PLL_RESET_A          (1 << 5)
+
+enum si5351_clock { SI5351_CLK0, SI5351_CLK1, SI5351_CLK2 };
+enum si5351_pll { SI5351_PLLA, SI5351_PLLB };
+enum si5351_drive { SI5351_DRIVE_2MA, SI5351_DRIVE_4MA, SI5351_DRIVE_6MA, SI5351_DRIVE_8MA };
+enum si5351_pll_input { SI5351_PLL_INPUT_XO, SI5351_PLL_INPUT_CLKIN };
+
+class Si5351 {
+public:
+  bool init(uint8_t xtalLoad, uint32_t xtalFreq, int32_t correction);
+  // Come la libreria: set_pll() scrive il PLL con il riferimento corretto,
+  // set_correction() riscrive entrambi i PLL sull'ultima frequenza impostata
+  void set_pll(uint64_t pllFreq, enum si5351_pll pll);
+  void drive_strength(enum si5351_clock clk, enum si5351_drive drive);
+  void output_enable(enum si5351_clock clk, uint8_t enable);
+  void set_clock_pwr(enum si5351_clock clk, uint8_t power);
+  void set_ms_source(enum si5351_clock clk, enum si5351_pll pll);
+  void set_correction(int32_t correction, enum si5351_pll_input input);
+  void pll_reset(enum si5351_pll pll);
+
+  uint8_t si5351_write(uint8_t reg, uint8_t value);
+  uint8_t si5351_read(uint8_t reg);
+
+private:
+  uint64_t pllFreq[2] = {SI5351_PLL_FIXED, SI5351_PLL_FIXED};  // In centesimi di Hz
+  int32_t refCorrection = 0;                                   // Parti per miliardo
+};
+
+#endif
@@ -0,0 +1,206 @@
+// Simulazione su PC della manipolazione RTTY su CLK2.
+// Usa lo stesso codice del firmware (keyer, PLL_plan, PLL_shadow): il timer
+// scandisce i mezzi bit, a ogni fronte si scrivono solo i registri diversi tra
+// le immagini mark/space e si stima quando l'uscita cambia davvero.
+// Verifica la temporizzazione dei fronti rispetto ai 45.45 baud ideali e
+// ridecodifica i codici ITA2 dalla sequenza d'uscita.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e keyer_sim
+//   .pio/build/keyer_sim/program [opzioni]
+//
+// Opzioni:
+//   --freq HZ           Frequenza mark (default 14085000)
+//   --text TESTO        Testo da trasmettere
+//   --i2c HZ            Clock I2C (default 400000)
+//   --isr-us US         Ritardo ISR -> task radio (default 20)
+//   --max-jitter-us US  Jitter massimo accettato (default 1000)
+//   -v                  Stampa ogni fronte
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "../config.h"
+#include "../keyer.h"
+#include "../PLL_plan.h"
+#include "../PLL_shadow.h"
+
+#define CLK2_MS_REG 58              // SI5351_CLK2_PARAMETERS
+
+struct KeyEdge {
+  uint64_t tick;              // Mezzo bit del timer
+  uint8_t level;
+  double idealUs;             // Istante ideale a 45.45 baud
+  double timerUs;             // Istante del timer hardware
+  double outputUs;            // Uscita effettivamente cambiata
+  uint16_t bytes;             // Byte I2C scritti (registro + dati + indirizzo)
+};
+
+// Bus finto: conta solo i byte
+static uint32_t busBytes = 0;
+static uint8_t simBusWrite(uint8_t reg, const uint8_t* data, uint8_t len) {
+  (void)reg;
+  (void)data;
+  busBytes += len + 2;        // Indirizzo + registro + dati
+  return 0;
+}
+
+// Livello d'uscita all'istante t (µs)
+static uint8_t levelAt(const std::vector<KeyEdge>& edges, double t) {
+  uint8_t level = KEY_MARK;
+  for (const KeyEdge& edge : edges) {
+    if (edge.outputUs > t) break;
+    level = edge.level;
+  }
+  return level;
+}
+
+// Ridecodifica i caratteri come un demodulatore asincrono
+static std::vector<uint8_t> decode(const std::vector<KeyEdge>& edges, double bitUs) {
+  std::vector<uint8_t> codes;
+  double after = 0;
+
+  for (const KeyEdge& edge : edges) {
+    if (edge.level != KEY_SPACE || edge.outputUs < after) continue;
+
+    // Fronte di start: campioni a metà di ogni bit
+    double start = edge.outputUs;
+    uint8_t code = 0;
+    for (uint8_t b = 0; b < 5; b++) {
+      if (levelAt(edges, start + (1.5 + b) * bitUs) == KEY_MARK) code |= 1 << b;
+    }
+    if (levelAt(edges, start + 6.5 * bitUs) != KEY_MARK) code = 0xFF;   // Stop mancante
+
+    codes.push_back(code);
+    after = start + 7.0 * bitUs;
+  }
+  return codes;
+}
+
+int main(int argc, char** argv) {
+  uint32_t freq = 14085000;
+  const char* text = "RYRYRY THE QUICK BROWN FOX 0123456789 -?:()., K";
+  uint32_t i2cHz = 400000;
+  double isrUs = 20;
+  double maxJitterUs = 1000;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (value == nullptr) {
+      fprintf(stderr, "Opzione senza valore: %s\n", argv[i]);
+      return 2;
+    } else if (strcmp(argv[i], "--freq") == 0) {
+      freq = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--text") == 0) {
+      text = value; i++;
+    } else if (strcmp(argv[i], "--i2c") == 0) {
+      i2cHz = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--isr-us") == 0) {
+      isrUs = atof(value); i++;
+    } else if (strcmp(argv[i], "--max-jitter-us") == 0) {
+      maxJitterUs = atof(value); i++;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  // Immagini mark/space come si5351PrepareKey()
+  uint32_t ref = correctedRef(0);
+  SynthPlan plan;
+  SynthImage image[2];
+  if (!planFixedPLL(freq, PLL_FIXED_FREQ, ref, plan)) return 1;
+  encodeSynthImage(plan, image[KEY_MARK]);
+  if (!planFixedPLL(freq - RTTY_SHIFT, PLL_FIXED_FREQ, ref, plan)) return 1;
+  encodeSynthImage(plan, image[KEY_SPACE]);
+
+  // Registri a riposo (mark) già scritti
+  Si5351Shadow shadow;
+  shadow.begin(simBusWrite);
+  for (uint8_t i = 0; i < 8; i++) shadow.seed(CLK2_MS_REG + i, image[KEY_MARK].ms[i]);
+
+  // Testo -> codici ITA2
+  RttySequencer rtty;
+  rtty.reset();
+  std::vector<uint8_t> sent;
+  bool figures = false;
+  sent.push_back(BAUDOT_LTRS);
+  for (const char* c = text; *c; c++) {
+    uint8_t codes[3];
+    uint8_t n = baudotEncode(*c, figures, codes);
+    for (uint8_t j = 0; j < n; j++) sent.push_back(codes[j]);
+  }
+
+  const uint32_t halfTicks = rttyHalfBitTicks();
+  const double halfUs = 1e6 * 100.0 / (2.0 * RTTY_BAUD_X100);
+  const double timerHalfUs = halfTicks * 1e6 / KEYER_TIMER_HZ;
+  const double byteUs = 9 * 1e6 / i2cHz;
+
+  // Timer: ogni mezzo bit un tick; la coda si riempie man mano come dal loop
+  std::vector<KeyEdge> edges;
+  size_t next = 0;
+  uint8_t lastLevel = KEY_MARK;
+  uint64_t idleTicks = 0;
+
+  for (uint64_t tick = 1; idleTicks < 2 * RTTY_HALF_BITS_PER_CHAR; tick++) {
+    while (next < sent.size() && rtty.push(sent[next])) next++;
+
+    uint8_t level = rtty.tick();
+    if (next == sent.size() && rtty.pending() == 0 && level == KEY_MARK) idleTicks++;
+    if (level == lastLevel) continue;
+    lastLevel = level;
+
+    // Fronte: si5351ApplyKey() scrive solo i byte diversi
+    busBytes = 0;
+    shadow.stage(CLK2_MS_REG, image[level].ms, 8);
+    shadow.flush();
+
+    KeyEdge edge;
+    edge.tick = tick;
+    edge.level = level;
+    edge.idealUs = tick * halfUs;
+    edge.timerUs = tick * timerHalfUs;
+    edge.bytes = busBytes;
+    edge.outputUs = edge.timerUs + isrUs + busBytes * byteUs;
+    edges.push_back(edge);
+  }
+
+  // Ritardo uscita - ideale: il jitter è la sua escursione
+  double minDelay = 1e9, maxDelay = -1e9, maxDrift = 0;
+  uint16_t minBytes = UINT16_MAX, maxBytes = 0;
+  for (const KeyEdge& edge : edges) {
+    double delay = edge.outputUs - edge.idealUs;
+    double drift = edge.timerUs - edge.idealUs;
+    if (delay < minDelay) minDelay = delay;
+    if (delay > maxDelay) maxDelay = delay;
+    if (drift < 0) drift = -drift;
+    if (drift > maxDrift) maxDrift = drift;
+    if (edge.bytes < minBytes) minBytes = edge.bytes;
+    if (edge.bytes > maxBytes) maxBytes = edge.bytes;
+
+    if (verbose) {
+      printf("%8.1f us %s  timer %+7.3f us  byte %2u  uscita %+7.1f us\n",
+             edge.idealUs, edge.level == KEY_MARK ? "MARK " : "SPACE",
+             edge.timerUs - edge.idealUs, edge.bytes, delay);
+    }
+  }
+
+  std::vector<uint8_t> received = decode(edges, 2 * halfUs);
+  bool decoded = received == sent;
+  double jitter = maxDelay - minDelay;
+
+  printf("RTTY %u Hz shift %u Hz, %.2f baud, mezzo bit %u tick (%.3f us, ideale %.3f us)\n",
+         freq, (unsigned)RTTY_SHIFT, RTTY_BAUD_X100 / 100.0, halfTicks, timerHalfUs, halfUs);
+  printf("Codici %zu, fronti %zu, byte I2C per fronte %u-%u\n",
+         sent.size(), edges.size(), minBytes, maxBytes);
+  printf("Deriva del timer max %.3f us, ritardo uscita %.1f-%.1f us, jitter %.1f us (max %.0f)\n",
+         maxDrift, minDelay, maxDelay, jitter, maxJitterUs);
+  printf("Ridecodifica: %s (%zu/%zu codici)\n", decoded ? "OK" : "ERRATA", received.size(), sent.size());
+
+  return decoded && jitter <= maxJitterUs ? 0 : 1;
+}
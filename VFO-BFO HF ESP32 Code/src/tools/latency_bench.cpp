@@ -0,0 +1,397 @@
+// Banco di latenza su PC: scatto dell'encoder VFO -> registri del Si5351 scritti.
+// Compila i moduli veri del firmware (VFO_BFO, PLL, bands, modes, display,
+// radio_state, ui_task, EEPROM, DigiOUT, scheduler) sopra i back-end simulati
+// di src/tools/host: pin e PCNT, bus I2C con il clock impostato dal firmware,
+// display SPI, orologio virtuale per core. I fronti dell'encoder arrivano a
+// tempi programmati; per ogni scatto si misura il tempo fino alla fine della
+// scrittura dei registri che lo contengono, decodificando la frequenza dai
+// registri del Si5351 simulato. A fine rotazione si confronta la frequenza
+// sul chip con quella attesa: la differenza sono gli scatti persi. Durante le
+// rotazioni non ci devono essere allocazioni di heap. Lo scenario
+// "calibrazione" cambia il fattore prima di ogni rotazione: il chip deve
+// restare sulla frequenza del display e la copia dei registri allineata.
+//
+// Modello del firmware: loop sul core 1 con i task input, s-meter ed eeprom
+// di main.cpp (keyer, misure e seriale restano fermi in sintonia) e il commit
+// dopo ogni task; il task radio ha priorità più alta sullo stesso core e parte
+// subito alla notifica. Task UI sul core 0 ogni UI_FRAME_MS, o con
+// --single-core nel loop come prima del task UI. Il codice gira a velocità di
+// PC: al tempo di CPU si addebitano le stime qui sotto, i bus costano il loro
+// tempo (host_sim.h).
+//
+// Step uguale a ENC_ACCEL_MAX_STEP: l'accelerazione non moltiplica e ogni
+// scatto vale esattamente uno step.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e latency_bench
+//   .pio/build/latency_bench/program [opzioni]
+//
+// Opzioni:
+//   --budget US       p99 massimo scatto -> registri (default ENC_LATENCY_BUDGET_US)
+//   --single-core     Display nel loop, sullo stesso core dell'encoder
+//   --seed N          Seme dei tempi dei fronti e dei rimbalzi
+//   -v                Messaggi seriali del firmware su stdout
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <random>
+#include "host_sim.h"
+#include "../config.h"
+#include "../VFO_BFO.h"
+#include "../PLL.h"
+#include "../PLL_plan.h"
+#include "../DigiOUT.h"
+#include "../display.h"
+#include "../display_dma.h"
+#include "../EEPROM_manager.h"
+#include "../s_meter.h"
+#include "../radio_state.h"
+#include "../radio_task.h"
+#include "../ui_task.h"
+#include "../scheduler.h"
+#include "../histogram.h"
+#include <Wire.h>
+
+// Tempo di CPU stimato (ESP32 a 240MHz)
+#define CPU_LOOP_NS          2000   // Giro del loop e scelta del task
+#define CPU_INPUT_NS        15000   // Task input: eventi, PCNT, encoder pitch
+#define CPU_COMMIT_NS       10000   // Commit dello stato senza bus
+#define CPU_RADIO_SWITCH_NS  8000   // Notifica e cambio di contesto al task radio
+#define CPU_SYNTH_NS        30000   // Piano Si5351 glide con controllo delle spurie
+#define CPU_UI_FRAME_NS     50000   // Fotogramma UI senza bus
+
+// Allocazioni di heap dentro runUntil() (firmware e simulazione, non i fronti
+// programmati dal banco): malloc di glibc, e quindi new, passa da qui come
+// passa da -Wl,--wrap sul firmware (alloc_counter.cpp)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool countAllocs = false;
+static uint32_t hostAllocs = 0;
+
+extern "C" void* malloc(size_t size) {
+  if (countAllocs) hostAllocs++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  if (countAllocs) hostAllocs++;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  if (countAllocs && size > 0) hostAllocs++;
+  return __libc_realloc(ptr, size);
+}
+
+// Variabili globali di main.cpp
+unsigned long vfoFrequency = 7000000 + IF_FREQUENCY;
+unsigned long displayedFrequency = 7000000;
+unsigned long step = ENC_ACCEL_MAX_STEP;
+unsigned long minFreq = 1000000;
+unsigned long maxFreq = 30000000;
+
+// Sweep mai attivo in sintonia
+bool sweepActive() { return false; }
+bool sweepPlotReady() { return false; }
+void drawSweepPlot() {}
+
+// ==================== MISURA ====================
+
+static std::deque<uint64_t> detentEdges;   // Fronti che completano uno scatto, in attesa
+static uint32_t burstBase = 0;              // Frequenza CLK0 a inizio rotazione
+static uint32_t burstApplied = 0;           // Scatti già scritti sul chip
+static LatencyHistogram latency;            // Scatto -> registri scritti (µs)
+static uint32_t vfoWrites = 0;
+
+// Rapporto di un blocco di 8 registri: (p1 + 512 + p2 / p3) / 128
+static double synthRatio(const uint8_t* r) {
+  uint32_t p1 = ((uint32_t)(r[2] & 0x03) << 16) | (r[3] << 8) | r[4];
+  uint32_t p2 = ((uint32_t)(r[5] & 0x0F) << 16) | (r[6] << 8) | r[7];
+  uint32_t p3 = ((uint32_t)(r[5] & 0xF0) << 12) | (r[0] << 8) | r[1];
+  return (p1 + 512 + (double)p2 / p3) / 128.0;
+}
+
+// Frequenza del CLK0 letta dai registri del chip
+static uint32_t clk0Frequency() {
+  const uint8_t* regs = simSi5351Registers();
+  bool pllB = regs[SI5351_CLK0_CTRL] & SI5351_CLK_PLL_SELECT;
+  double pll = synthRatio(regs + (pllB ? SI5351_PLLB_PARAMETERS : SI5351_PLLA_PARAMETERS));
+  const uint8_t* ms = regs + SI5351_CLK0_PARAMETERS;
+  uint8_t rDiv = (ms[2] >> 4) & 0x07;
+  return (uint32_t)(correctedRef(si5351Calibration.load()) * pll / synthRatio(ms) / (1 << rDiv) + 0.5);
+}
+
+static uint32_t stepsFrom(uint32_t base, uint32_t freq) {
+  uint32_t diff = freq > base ? freq - base : base - freq;
+  return (diff + step / 2) / step;
+}
+
+// Dopo ogni scrittura VFO: gli scatti ora sul chip hanno finito il loro percorso
+static void vfoWritten() {
+  vfoWrites++;
+  uint32_t applied = stepsFrom(burstBase, clk0Frequency());
+  uint64_t now = simNowNs();
+  while (burstApplied < applied && !detentEdges.empty()) {
+    uint64_t edge = detentEdges.front();
+    detentEdges.pop_front();
+    latency.add(now > edge ? (uint32_t)((now - edge) / 1000) : 0);
+    burstApplied++;
+  }
+}
+
+// ==================== TASK RADIO ====================
+
+// Priorità più alta del loop sullo stesso core: parte alla notifica
+void radioPostVFO(uint32_t freq, bool recall) {
+  simCharge(CPU_RADIO_SWITCH_NS + CPU_SYNTH_NS);
+  si5351ApplyVFO(freq, recall);
+  vfoWritten();
+}
+
+void radioPostBFO(uint32_t freq, bool recall) {
+  simCharge(CPU_RADIO_SWITCH_NS + CPU_SYNTH_NS);
+  si5351ApplyBFO(freq, recall);
+}
+
+void radioPostCalibration(int32_t correction) {
+  simCharge(CPU_RADIO_SWITCH_NS + 2 * CPU_SYNTH_NS);
+  si5351ApplyCalibration(correction);
+}
+
+// ==================== LOOP ====================
+
+static void inputTask() {
+  simCharge(CPU_INPUT_NS);
+  readVFOEncoder();
+  updateBFOFromEncoder();
+}
+
+static void sMeterTask() {
+  radioState.setSMeter(readSMeter());
+}
+
+static void eepromTask() {
+  eepromManager.update();
+}
+
+static void uiLoopTask() {
+  simCharge(CPU_UI_FRAME_NS);
+  uiFrame();
+}
+
+// Come in main.cpp; l'ultimo (display nel loop) solo con --single-core
+static SchedTask loopTasks[] = {
+  {"input", inputTask, 1000, 20000, 0},
+  {"s-meter", sMeterTask, 50000, 100000, 3},
+  {"eeprom", eepromTask, EEPROM_WRITE_CYCLE_MS * 1000, 50000, 5},
+  {"ui", uiLoopTask, UI_FRAME_MS * 1000, UI_FRAME_MS * 1000, 1}
+};
+
+static Scheduler loopScheduler;
+static bool singleCore = false;
+static uint64_t uiNextNs = 0;
+
+static uint32_t schedulerClock() {
+  return micros();
+}
+
+static uint64_t coreNowNs(uint8_t core) {
+  uint8_t saved = simCore;
+  simCore = core;
+  uint64_t now = simNowNs();
+  simCore = saved;
+  return now;
+}
+
+// Esegue i due core in ordine di tempo fino a endNs
+static void runUntil(uint64_t endNs) {
+  countAllocs = true;
+  for (;;) {
+    uint64_t loopNs = coreNowNs(1);
+    if (!singleCore && uiNextNs <= loopNs) {
+      simCore = 0;
+      simSetNowNs(uiNextNs);
+      simCharge(CPU_UI_FRAME_NS);
+      uiFrame();
+      // Come vTaskDelayUntil: periodo fisso, nessun recupero se in ritardo
+      uiNextNs += UI_FRAME_MS * 1000000ULL;
+      if (uiNextNs < simNowNs()) uiNextNs = simNowNs();
+      continue;
+    }
+    if (loopNs >= endNs) break;
+
+    simCore = 1;
+    simCharge(CPU_LOOP_NS);
+    if (loopScheduler.runOnce() == nullptr) {
+      uint64_t wait = loopScheduler.untilNextUs() * 1000ULL;
+      simSetNowNs(std::min(simNowNs() + wait, endNs));
+      continue;
+    }
+    simCharge(CPU_COMMIT_NS);
+    radioState.commit();
+  }
+  simCore = 1;
+  countAllocs = false;
+}
+
+static void setup() {
+  // Stesso ordine di setup() in main.cpp
+  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.setClock(400000);
+  setupDisplayDMA();
+  setupDisplaySprites();
+  eepromManager.begin();
+  vfoFrequency = displayedFrequency + IF_FREQUENCY;
+  setupEncoders();
+  setupDigiOUT();
+  setupSI5351();
+  radioState.mark(DIRTY_ALL & ~(DIRTY_SAVE | DIRTY_QUICK_SAVE));
+  radioState.commit();
+  setupUiTask();
+
+  uiNextNs = simNowNs();
+  uint8_t count = sizeof(loopTasks) / sizeof(loopTasks[0]);
+  loopScheduler.begin(loopTasks, singleCore ? count : count - 1, schedulerClock);
+}
+
+// ==================== ENCODER ====================
+
+struct Scenario {
+  const char* name;
+  uint32_t bursts;            // Rotazioni, a versi alterni
+  uint32_t detents;           // Scatti per rotazione
+  uint32_t detentUs;          // Tempo medio per scatto (±25%)
+  uint32_t gapMs;             // Pausa dopo ogni rotazione
+  uint32_t bounceUs;          // Rimbalzi dei contatti dopo ogni fronte (0 = nessuno)
+  int32_t calibration = 0;    // Fattore applicato prima di ogni rotazione, a segni alterni
+};
+
+static const Scenario scenarios[] = {
+  {"lenta", 10, 10, 60000, 400, 0},
+  {"normale", 20, 40, 10000, 400, 0},
+  {"veloce", 20, 100, 2000, 400, 0},
+  {"rimbalzi", 20, 40, 5000, 400, 300},
+  {"salvataggi", 8, 40, 5000, EEPROM_SAVE_DELAY + 5, 0},
+  {"calibrazione", 10, 40, 5000, 400, 0, 3000}
+};
+
+// Stato dei pin in avanti: 11 -> 01 -> 00 -> 10 (quadrature.cpp)
+static const uint8_t forward[4] = {0b11, 0b01, 0b00, 0b10};
+static uint8_t phase = 0;
+
+// Un fronte (e i suoi rimbalzi): cambia un solo pin per passo
+static void scheduleStep(uint64_t ns, int8_t direction, uint32_t bounceUs, std::mt19937& rng) {
+  uint8_t from = forward[phase];
+  phase = (phase + (direction > 0 ? 1 : 3)) & 3;
+  uint8_t to = forward[phase];
+  bool clkChanges = (from ^ to) & 0b10;
+  uint8_t pin = clkChanges ? VFO_ENC_CLK : VFO_ENC_DT;
+  uint8_t level = clkChanges ? (to >> 1) & 1 : to & 1;
+
+  simSchedulePin(ns, pin, level);
+  if (bounceUs == 0) return;
+
+  // Rimbalzi: coppie di impulsi brevi, da pochi µs (filtrati dal PCNT) a bounceUs
+  uint64_t t = ns;
+  for (int n = rng() % 4; n > 0; n--) {
+    t += 1000 + rng() % (bounceUs * 1000 / 4);
+    simSchedulePin(t, pin, !level);
+    t += 2000 + rng() % 38000;
+    simSchedulePin(t, pin, level);
+  }
+}
+
+static bool runScenario(const Scenario& sc, uint32_t budgetUs, std::mt19937& rng) {
+  latency.reset();
+  vfoWrites = 0;
+  uint32_t expected = 0;
+  uint32_t dropped = 0;
+  uint32_t wrongRegisters = 0;
+  uint32_t eepromWrites = simI2CTransactions(EXTERNAL_EEPROM_ADDRESS);
+  uint64_t spiStart = simSpiBusyNs();
+  uint32_t allocStart = hostAllocs;
+  FreqDisplayStats freqStart = freqDisplayStats;
+  uint64_t start = simNowNs();
+
+  for (uint32_t b = 0; b < sc.bursts; b++) {
+    int8_t direction = b & 1 ? -1 : 1;
+    if (sc.calibration != 0) {
+      calibrateSI5351(direction * sc.calibration);
+      if (stepsFrom(clk0Frequency(), vfoFrequency) != 0) wrongRegisters++;
+    }
+    burstBase = clk0Frequency();
+    burstApplied = 0;
+    detentEdges.clear();
+
+    // Fronti della rotazione: ENC_COUNTS_PER_STEP fronti per scatto
+    uint64_t t = simNowNs() + 1000000;
+    for (uint32_t d = 0; d < sc.detents; d++) {
+      uint32_t detentNs = sc.detentUs * (750 + rng() % 501);
+      for (uint8_t e = 0; e < ENC_COUNTS_PER_STEP; e++) {
+        t += detentNs / ENC_COUNTS_PER_STEP;
+        scheduleStep(t, direction, sc.bounceUs, rng);
+      }
+      detentEdges.push_back(t);
+    }
+    runUntil(t + sc.gapMs * 1000000ULL);
+
+    // Fine rotazione: il chip deve avere tutti gli scatti e la frequenza del display
+    uint32_t chip = clk0Frequency();
+    uint32_t applied = stepsFrom(burstBase, chip);
+    expected += sc.detents;
+    dropped += applied < sc.detents ? sc.detents - applied : applied - sc.detents;
+    if (stepsFrom(chip, vfoFrequency) != 0) wrongRegisters++;
+  }
+
+  if (sc.calibration != 0) calibrateSI5351(0);
+
+  uint32_t p99 = latency.percentile(99);
+  uint32_t allocs = hostAllocs - allocStart;
+  bool pass = p99 <= budgetUs && dropped == 0 && wrongRegisters == 0 && allocs == 0;
+  double seconds = (simNowNs() - start) / 1e9;
+  uint32_t freqUpdates = freqDisplayStats.updates - freqStart.updates;
+  uint32_t freqPixels = freqDisplayStats.pixels - freqStart.pixels;
+  printf("%-6s %-12s scatti %5u, persi %3u, scritture VFO %5u, ridisegni %5u, heap %u, EEPROM %3u, SPI %4.1f%%, "
+         "px/frequenza %5u, latenza (us) p50 %5u p99 %5u max %5u\n",
+         pass ? "OK" : "ERRORE", sc.name, expected, dropped, vfoWrites, freqUpdates, allocs,
+         simI2CTransactions(EXTERNAL_EEPROM_ADDRESS) - eepromWrites,
+         (simSpiBusyNs() - spiStart) / 1e9 / seconds * 100,
+         freqUpdates ? freqPixels / freqUpdates : 0,
+         latency.percentile(50), p99, latency.max);
+  if (wrongRegisters) printf("       registri diversi dalla frequenza del display in %u rotazioni\n", wrongRegisters);
+  return pass;
+}
+
+int main(int argc, char** argv) {
+  uint32_t budgetUs = ENC_LATENCY_BUDGET_US;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--single-core") == 0) {
+      singleCore = true;
+    } else if (strcmp(argv[i], "-v") == 0) {
+      simSerialEcho = true;
+    } else if (i + 1 < argc && strcmp(argv[i], "--budget") == 0) {
+      budgetUs = strtoul(argv[++i], nullptr, 10);
+    } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(argv[++i], nullptr, 10);
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  setup();
+  printf("I2C %u kHz, display %s, step %lu Hz, budget p99 %u us\n", simI2CHz() / 1000,
+         singleCore ? "nel loop (core 1)" : "sul core 0", step, budgetUs);
+
+  std::mt19937 rng(seed);
+  bool ok = true;
+  for (const Scenario& sc : scenarios) ok &= runScenario(sc, budgetUs, rng);
+  return ok ? 0 : 1;
+}
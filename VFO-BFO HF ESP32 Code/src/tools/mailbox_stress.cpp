@@ -0,0 +1,223 @@
+// Prova di carico su PC della casella "vince l'ultimo" loop -> task radio
+// (mailbox.h) e dell'istogramma delle latenze (histogram.h).
+// Un thread produttore fa la parte del loop e pubblica i numeri 1..N, un
+// thread consumatore quella del task radio e prende quando può, su core
+// diversi. Ogni valore porta un controllo ricavato dal suo numero: un valore
+// che non torna è rotto. Il consumatore non deve mai vedere un numero più
+// vecchio del precedente e, finito il produttore, deve avere l'ultimo.
+// Le pubblicazioni arrivate tra due letture collassano nell'ultima: il salto
+// di numero tra due letture va in un LatencyHistogram e la somma dei salti
+// deve essere N (nessuna pubblicazione persa nel conteggio).
+//
+// L'istogramma è poi confrontato con i percentili esatti di distribuzioni
+// note: ogni percentile deve cadere nel bucket di quello esatto.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e mailbox_stress
+//   .pio/build/mailbox_stress/program [opzioni]
+//
+// Opzioni:
+//   --posts N         Pubblicazioni per prova (default 2000000, al più 2^24)
+//   --seed N          Seme delle pause e delle distribuzioni
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../mailbox.h"
+#include "../histogram.h"
+
+#define MAX_POSTS (1u << 24)
+
+// Numero nei 24 bit alti, controllo negli 8 bassi
+static uint32_t pack(uint32_t n) {
+  return (n << 8) | ((n * 0x9Du + 0x5Bu) & 0xFF);
+}
+
+static bool unpack(uint32_t value, uint32_t& n) {
+  n = value >> 8;
+  return pack(n) == value;
+}
+
+struct Result {
+  uint32_t posted = 0, takes = 0, empty = 0;
+  uint32_t torn = 0, backwards = 0, repeated = 0;
+  uint32_t last = 0;
+  uint64_t collapsed = 0;       // Somma dei salti tra due letture
+  LatencyHistogram gaps;        // Pubblicazioni per lettura
+  double postSeconds = 0;
+};
+
+// Con pause il consumatore fa la parte di una scrittura lunga sul bus
+static Result runCase(uint32_t posts, bool slowConsumer, uint32_t seed) {
+  LatestMailbox<uint32_t> mailbox;
+  std::atomic<bool> done{false};
+  Result r;
+  r.gaps.reset();
+
+  std::thread producer([&] {
+    std::mt19937 rng(seed);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 1; n <= posts; n++) {
+      mailbox.post(pack(n));
+      // Ogni tanto cede il processore: con un solo core il consumatore resta a metà
+      if (rng() % 128 == 0) std::this_thread::yield();
+    }
+    r.postSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done.store(true, std::memory_order_release);
+  });
+
+  std::thread consumer([&] {
+    std::mt19937 rng(seed + 1);
+    for (;;) {
+      bool finished = done.load(std::memory_order_acquire);
+      uint32_t value;
+      if (mailbox.take(value)) {
+        r.takes++;
+        uint32_t n;
+        if (!unpack(value, n)) {
+          r.torn++;
+        } else if (n < r.last) {
+          r.backwards++;
+        } else if (n == r.last) {
+          // Valore più nuovo della sequenza letta: già preso, si ripete
+          r.repeated++;
+        } else {
+          r.gaps.add(n - r.last);
+          r.collapsed += n - r.last;
+          r.last = n;
+        }
+      } else {
+        r.empty++;
+      }
+
+      // Lettura fatta dopo la fine del produttore: ha visto l'ultima pubblicazione
+      if (finished) break;
+      if (slowConsumer && rng() % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+      else if (rng() % 16 == 0) std::this_thread::yield();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  r.posted = mailbox.posted();
+  return r;
+}
+
+static bool report(const char* name, uint32_t posts, const Result& r) {
+  bool pass = r.torn == 0 && r.backwards == 0 && r.posted == posts && r.last == posts &&
+              r.collapsed == posts && r.gaps.count <= posts;
+  printf("%-6s %-22s pubblicate %u, lette %u, vuote %u, rotte %u, all'indietro %u, ripetute %u, "
+         "ultima %u, salto p50 %u p99 %u max %u, %.1f Mpub/s\n",
+         pass ? "OK" : "ERRORE", name, r.posted, r.takes, r.empty, r.torn, r.backwards, r.repeated,
+         r.last, r.gaps.percentile(50), r.gaps.percentile(99), r.gaps.max, r.posted / r.postSeconds / 1e6);
+  return pass;
+}
+
+// Un solo thread: tre pubblicazioni prima di leggere danno la terza, una volta sola
+static bool checkCollapse() {
+  LatestMailbox<uint32_t> mailbox;
+  uint32_t value = 0;
+  bool pass = !mailbox.take(value);
+  mailbox.post(10);
+  mailbox.post(20);
+  mailbox.post(30);
+  pass &= mailbox.take(value) && value == 30;
+  pass &= !mailbox.take(value) && value == 30;
+  mailbox.post(40);
+  pass &= mailbox.take(value) && value == 40 && mailbox.posted() == 4;
+  printf("%-6s %-22s\n", pass ? "OK" : "ERRORE", "vince l'ultimo");
+  return pass;
+}
+
+// Percentili dell'istogramma contro quelli esatti: stesso bucket, mai sotto
+static bool checkPercentiles(const char* name, std::vector<uint32_t> values) {
+  LatencyHistogram h;
+  h.reset();
+  for (uint32_t v : values) h.add(v);
+  std::sort(values.begin(), values.end());
+
+  static const uint8_t points[] = {1, 10, 50, 90, 99, 100};
+  bool pass = h.count == values.size() && h.max == values.back();
+  printf("%-6s %-22s", "", name);
+  for (uint8_t p : points) {
+    // Percentile esatto: il più piccolo valore con almeno p% dei campioni fino a lui
+    size_t rank = ((uint64_t)values.size() * p + 99) / 100;
+    uint32_t exact = values[rank ? rank - 1 : 0];
+    uint32_t approx = h.percentile(p);
+    bool ok = approx >= exact && LatencyHistogram::bucketOf(approx) == LatencyHistogram::bucketOf(exact);
+    pass &= ok;
+    printf(" p%u %u/%u%s", p, exact, approx, ok ? "" : "!");
+  }
+  printf("\n%-6s %-22s esatto/istogramma, campioni %zu\n", pass ? "OK" : "ERRORE", name, values.size());
+  return pass;
+}
+
+static bool checkHistogram(uint32_t seed) {
+  std::mt19937 rng(seed);
+  bool pass = true;
+
+  // Vuoto e limiti dei bucket
+  LatencyHistogram h;
+  h.reset();
+  bool edges = h.percentile(50) == 0 && LatencyHistogram::bucketOf(0) == 0 &&
+               LatencyHistogram::bucketOf(1) == 1 && LatencyHistogram::bucketOf(1023) == 10 &&
+               LatencyHistogram::bucketOf(1024) == 11 &&
+               LatencyHistogram::bucketOf(UINT32_MAX) == HISTOGRAM_BUCKETS - 1;
+  printf("%-6s %-22s\n", edges ? "OK" : "ERRORE", "bucket e vuoto");
+  pass &= edges;
+
+  std::vector<uint32_t> values;
+  for (uint32_t v = 1; v <= 1000; v++) values.push_back(v);
+  pass &= checkPercentiles("uniforme 1..1000", values);
+
+  // Latenze come quelle del task radio: un picco stretto e una coda lunga
+  values.clear();
+  std::exponential_distribution<double> tail(1.0 / 400);
+  for (uint32_t i = 0; i < 100000; i++) values.push_back(1800 + (uint32_t)tail(rng));
+  pass &= checkPercentiles("picco e coda", values);
+
+  // Costante: tutti i percentili sono il valore (tagliati al massimo)
+  values.assign(5000, 2375);
+  pass &= checkPercentiles("costante 2375", values);
+  return pass;
+}
+
+int main(int argc, char** argv) {
+  uint32_t posts = 2000000;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      fprintf(stderr, "Opzione senza valore: %s\n", argv[i]);
+      return 2;
+    } else if (strcmp(argv[i], "--posts") == 0) {
+      posts = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(value, nullptr, 10); i++;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (posts == 0 || posts >= MAX_POSTS) {
+    fprintf(stderr, "--posts tra 1 e %u\n", MAX_POSTS - 1);
+    return 2;
+  }
+
+  printf("Thread hardware: %u\n", std::thread::hardware_concurrency());
+
+  bool ok = checkCollapse();
+  ok &= report("casella VFO", posts, runCase(posts, false, seed));
+  ok &= report("casella, task lento", posts, runCase(posts, true, seed));
+  ok &= checkHistogram(seed);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+// Verifica su PC del piano Si5351 su tutta la gamma di sintonia.
+// Usa lo stesso codice del firmware (PLL_plan, PLL_spur) e per ogni passo
+// riporta divisori, modo intero/frazionario, errore d'uscita e tempo di calcolo.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e pll_sweep
+//   .pio/build/pll_sweep/program [opzioni] > sweep.csv
+//
+// Opzioni:
+//   --from HZ      Frequenza visualizzata iniziale (default 1000000)
+//   --to HZ        Frequenza visualizzata finale (default 30000000)
+//   --step HZ      Passo (default 10)
+//   --cal PPB      Correzione del quarzo come in EEPROM (default 0)
+//   --threads N    Thread di calcolo (default: tutti i core)
+//   --no-timing    Tempo di calcolo a 0, per confronti tra versioni con diff
+//   --binary       Record binari SweepRecord invece del CSV
+//   -o FILE        File d'uscita (default stdout)
+//
+// Per ogni frequenza si producono due righe: piano fisso (PLL a 800MHz,
+// Multisynth frazionario) e piano glide (Multisynth intero dal piano di banda).
+// Il glide è calcolato come al richiamo, senza isteresi: il risultato non
+// dipende dall'ordine di calcolo né dal numero di thread.
+// Il riepilogo (punti irraggiungibili, errore massimo, tempi) va su stderr.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../config.h"
+#include "../PLL_plan.h"
+#include "../PLL_spur.h"
+#include "../histogram.h"
+
+#define SWEEP_BLOCK 262144          // Punti calcolati per blocco prima di scrivere
+
+enum SweepMode : uint8_t {
+  SWEEP_FIXED = 0,
+  SWEEP_GLIDE = 1
+};
+
+enum SweepFlags : uint8_t {
+  SWEEP_OK = 0x01,            // Piano valido
+  SWEEP_MS_INT = 0x02,        // Multisynth intero
+  SWEEP_PLL_INT = 0x04,       // PLL intero
+  SWEEP_SPUR = 0x08           // Uscita in zona spuria
+};
+
+#pragma pack(push, 1)
+struct SweepRecord {
+  uint32_t dial;              // Frequenza visualizzata
+  uint32_t output;            // Uscita VFO richiesta (dial + IF)
+  uint8_t mode;
+  uint8_t flags;
+  uint8_t rDiv;
+  uint16_t pllA;
+  uint32_t pllB, pllC;
+  uint16_t msA;
+  uint32_t msB, msC;
+  int32_t errorMilliHz;       // Uscita calcolata - richiesta
+  uint32_t costNs;            // Tempo di calcolo del piano
+};
+#pragma pack(pop)
+
+struct SweepOptions {
+  uint32_t from = 1000000;
+  uint32_t to = 30000000;
+  uint32_t step = 10;
+  int32_t correction = 0;
+  unsigned threads = 0;
+  bool timing = true;
+  bool binary = false;
+  const char* output = nullptr;
+};
+
+struct SweepStats {
+  uint64_t points = 0;
+  uint64_t failed = 0;
+  uint64_t msInteger = 0;
+  uint64_t spurProne = 0;
+  int32_t maxError = 0;
+  uint32_t maxErrorDial = 0;
+  LatencyHistogram cost;
+};
+
+static uint64_t nowNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void fillRecord(SweepRecord& rec, const SynthPlan& plan, bool ok, uint32_t ref, bool spur) {
+  rec.flags = 0;
+  if (!ok) return;
+
+  rec.flags = SWEEP_OK;
+  if (plan.msB == 0) rec.flags |= SWEEP_MS_INT;
+  if (plan.pllB == 0) rec.flags |= SWEEP_PLL_INT;
+  if (spur) rec.flags |= SWEEP_SPUR;
+
+  rec.rDiv = plan.rDiv;
+  rec.pllA = plan.pllA;
+  rec.pllB = plan.pllB;
+  rec.pllC = plan.pllC;
+  rec.msA = plan.msA;
+  rec.msB = plan.msB;
+  rec.msC = plan.msC;
+
+  int64_t error = (int64_t)planOutputMilliHz(plan, ref) - (int64_t)rec.output * 1000;
+  rec.errorMilliHz = (int32_t)error;
+}
+
+// Calcola i due piani (fisso e glide) per una frequenza visualizzata
+static void sweepPoint(uint32_t dial, uint32_t ref, bool timing, SweepRecord* out) {
+  uint32_t freq = dial + IF_FREQUENCY;
+  SynthPlan plan = {};
+
+  memset(out, 0, 2 * sizeof(SweepRecord));
+  out[0].dial = out[1].dial = dial;
+  out[0].output = out[1].output = freq;
+  out[0].mode = SWEEP_FIXED;
+  out[1].mode = SWEEP_GLIDE;
+
+  // Piano fisso: come synthImage() con msDiv = 0
+  uint64_t start = timing ? nowNs() : 0;
+  bool ok = planFixedPLL(freq, PLL_FIXED_FREQ, ref, plan);
+  uint64_t end = timing ? nowNs() : 0;
+  fillRecord(out[0], plan, ok, ref, false);
+  out[0].costNs = (uint32_t)(end - start);
+
+  // Piano glide: finestra dal piano di banda, poi PLL = freq * msDiv
+  GlideWindow window = {0, 0, 0};
+  start = timing ? nowNs() : 0;
+  planSpurAwareWindow(freq, ref, GlideWindow{0, 0, 0}, window);
+  ok = window.msDiv != 0 && planGlide(freq, window.msDiv, ref, plan);
+  end = timing ? nowNs() : 0;
+  fillRecord(out[1], plan, ok, ref, ok && spurProne(freq, window.msDiv, ref));
+  out[1].costNs = (uint32_t)(end - start);
+}
+
+static void accumulate(SweepStats& stats, const SweepRecord& rec) {
+  stats.points++;
+  if (!(rec.flags & SWEEP_OK)) {
+    stats.failed++;
+    return;
+  }
+  if (rec.flags & SWEEP_MS_INT) stats.msInteger++;
+  if (rec.flags & SWEEP_SPUR) stats.spurProne++;
+
+  int32_t error = rec.errorMilliHz < 0 ? -rec.errorMilliHz : rec.errorMilliHz;
+  if (error > stats.maxError) {
+    stats.maxError = error;
+    stats.maxErrorDial = rec.dial;
+  }
+  stats.cost.add(rec.costNs);
+}
+
+static void writeCsvHeader(FILE* file) {
+  fprintf(file, "dial,output,mode,ok,ms_int,pll_int,spur,r_div,pll_a,pll_b,pll_c,ms_a,ms_b,ms_c,error_mhz,cost_ns\n");
+}
+
+static void writeCsv(FILE* file, const SweepRecord& rec) {
+  fprintf(file, "%u,%u,%s,%d,%d,%d,%d,%u,%u,%u,%u,%u,%u,%u,%d,%u\n",
+          rec.dial, rec.output, rec.mode == SWEEP_GLIDE ? "glide" : "fixed",
+          (rec.flags & SWEEP_OK) != 0, (rec.flags & SWEEP_MS_INT) != 0,
+          (rec.flags & SWEEP_PLL_INT) != 0, (rec.flags & SWEEP_SPUR) != 0,
+          rec.rDiv, rec.pllA, rec.pllB, rec.pllC, rec.msA, rec.msB, rec.msC,
+          rec.errorMilliHz, rec.costNs);
+}
+
+static void printStats(const char* name, const SweepStats& stats) {
+  fprintf(stderr, "%-6s punti %llu, non validi %llu, MS intero %llu, in zona spuria %llu\n",
+          name, (unsigned long long)stats.points, (unsigned long long)stats.failed,
+          (unsigned long long)stats.msInteger, (unsigned long long)stats.spurProne);
+  fprintf(stderr, "       errore max %d mHz a %u Hz\n", stats.maxError, stats.maxErrorDial);
+  if (stats.cost.max > 0) {
+    fprintf(stderr, "       calcolo p50 %u ns, p99 %u ns, max %u ns\n",
+            stats.cost.percentile(50), stats.cost.percentile(99), stats.cost.max);
+  }
+}
+
+static bool parseOptions(int argc, char** argv, SweepOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (strcmp(arg, "--no-timing") == 0) {
+      options.timing = false;
+    } else if (strcmp(arg, "--binary") == 0) {
+      options.binary = true;
+    } else if (value == nullptr) {
+      return false;
+    } else if (strcmp(arg, "--from") == 0) {
+      options.from = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(arg, "--to") == 0) {
+      options.to = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(arg, "--step") == 0) {
+      options.step = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(arg, "--cal") == 0) {
+      options.correction = strtol(value, nullptr, 10); i++;
+    } else if (strcmp(arg, "--threads") == 0) {
+      options.threads = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(arg, "-o") == 0) {
+      options.output = value; i++;
+    } else {
+      return false;
+    }
+  }
+  return options.step > 0 && options.from > 0 && options.from <= options.to;
+}
+
+int main(int argc, char** argv) {
+  SweepOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    fprintf(stderr, "Uso: %s [--from HZ] [--to HZ] [--step HZ] [--cal PPB] [--threads N] "
+                    "[--no-timing] [--binary] [-o FILE]\n", argv[0]);
+    return 2;
+  }
+
+  FILE* file = options.output ? fopen(options.output, options.binary ? "wb" : "w") : stdout;
+  if (file == nullptr) {
+    perror(options.output);
+    return 1;
+  }
+
+  unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+
+  const uint32_t ref = correctedRef(options.correction);
+  const uint64_t total = (uint64_t)(options.to - options.from) / options.step + 1;
+
+  std::vector<SweepRecord> block((size_t)SWEEP_BLOCK * 2);
+  SweepStats fixedStats, glideStats;
+  fixedStats.cost.reset();
+  glideStats.cost.reset();
+
+  if (!options.binary) writeCsvHeader(file);
+  uint64_t started = nowNs();
+
+  for (uint64_t first = 0; first < total; first += SWEEP_BLOCK) {
+    uint64_t count = total - first < SWEEP_BLOCK ? total - first : SWEEP_BLOCK;
+
+    // Ogni thread calcola una fetta contigua del blocco
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+      uint64_t from = count * t / threads;
+      uint64_t to = count * (t + 1) / threads;
+      workers.emplace_back([&, from, to]() {
+        for (uint64_t i = from; i < to; i++) {
+          uint32_t dial = (uint32_t)(options.from + (first + i) * options.step);
+          sweepPoint(dial, ref, options.timing, &block[i * 2]);
+        }
+      });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    // Scrittura in ordine di frequenza
+    for (uint64_t i = 0; i < count; i++) {
+      accumulate(fixedStats, block[i * 2]);
+      accumulate(glideStats, block[i * 2 + 1]);
+    }
+    if (options.binary) {
+      fwrite(block.data(), sizeof(SweepRecord), count * 2, file);
+    } else {
+      for (uint64_t i = 0; i < count * 2; i++) writeCsv(file, block[i]);
+    }
+  }
+
+  if (file != stdout) fclose(file);
+
+  fprintf(stderr, "Sweep %u-%u Hz passo %u Hz, IF %u Hz, correzione %ld ppb, %u thread, %.2f s\n",
+          options.from, options.to, options.step, (unsigned)IF_FREQUENCY,
+          (long)options.correction, threads, (nowNs() - started) / 1e9);
+  printStats("fisso", fixedStats);
+  printStats("glide", glideStats);
+
+  return fixedStats.failed + glideStats.failed ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// Prova di carico su PC della coda SPSC degli eventi di ingresso (spsc_ring.h).
+// Un thread produttore fa la parte dell'ISR, un thread consumatore quella del
+// loop, su core diversi e senza sincronizzazione oltre a quella della coda.
+// Ogni elemento porta un numero di sequenza e un controllo: la coda non deve
+// mai restituire elementi a metà scrittura, duplicati o fuori ordine.
+//
+// Senza perdite: il produttore riprova a coda piena, devono arrivare tutti.
+// Con perdite: il produttore non aspetta mai (come l'ISR) e il consumatore si
+// ferma ogni tanto (come un ridisegno lungo): ricevuti + scartati = prodotti.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e ring_stress
+//   .pio/build/ring_stress/program [opzioni]
+//
+// Opzioni:
+//   --items N         Elementi per prova (default 1000000)
+//   --seed N          Seme delle pause casuali
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include "../config.h"
+#include "../spsc_ring.h"
+
+// 12 byte: una scrittura non atomica, una lettura a metà si vedrebbe nel controllo
+struct Item {
+  uint32_t seq;
+  uint32_t us;
+  uint32_t check;
+};
+
+static uint32_t checkOf(uint32_t seq, uint32_t us) {
+  return (seq * 2654435761u) ^ us ^ 0xA5A5A5A5u;
+}
+
+struct Result {
+  uint32_t produced = 0, received = 0, dropped = 0;
+  uint32_t torn = 0, disorder = 0, oversize = 0;
+  uint32_t highWater = 0;
+  double seconds = 0;
+};
+
+// Attesa a coda piena/vuota: qualche yield, poi una pausa vera. Con un solo
+// core yield() può ridare il processore allo stesso thread.
+static void backoff(uint32_t& spins) {
+  if (++spins < 16) std::this_thread::yield();
+  else std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+template <uint32_t N>
+static Result runCase(uint32_t items, bool lossy, uint32_t seed) {
+  std::unique_ptr<SpscRing<Item, N>> queue(new SpscRing<Item, N>());   // Nuova per ogni prova
+  SpscRing<Item, N>& ring = *queue;
+  std::atomic<bool> done{false};
+  Result r;
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::thread producer([&] {
+    std::mt19937 rng(seed);
+    for (uint32_t seq = 0; seq < items; seq++) {
+      Item item;
+      item.seq = seq;
+      item.us = rng();
+      item.check = checkOf(seq, item.us);
+      if (lossy) {
+        ring.push(item);
+        // Raffiche di fronti e pause, come i rimbalzi di un pulsante
+        if (rng() % 64 == 0) std::this_thread::yield();
+      } else {
+        uint32_t spins = 0;
+        while (!ring.push(item)) backoff(spins);
+      }
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  std::thread consumer([&] {
+    std::mt19937 rng(seed + 1);
+    uint32_t expected = 0;
+    Item item;
+    uint32_t spins = 0;
+    for (;;) {
+      bool finished = done.load(std::memory_order_acquire);
+      if (ring.size() > N) r.oversize++;
+      bool any = false;
+      while (ring.pop(item)) {
+        any = true;
+        r.received++;
+        if (item.check != checkOf(item.seq, item.us)) r.torn++;
+        // Con perdite la sequenza può saltare in avanti, mai tornare indietro
+        if (lossy ? item.seq < expected : item.seq != expected) r.disorder++;
+        expected = item.seq + 1;
+      }
+      // Coda svuotata dopo la fine del produttore: non arriva più niente
+      if (finished && !any) break;
+      if (any) spins = 0;
+      else backoff(spins);
+      // Loop occupato altrove: lascia riempire la coda
+      if (lossy && rng() % 256 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  r.produced = items;
+  r.dropped = lossy ? ring.dropped() : 0;    // Senza perdite sono solo tentativi ripetuti
+  r.highWater = ring.highWater();
+  return r;
+}
+
+static bool report(const char* name, uint32_t capacity, bool lossy, const Result& r) {
+  bool pass = r.torn == 0 && r.disorder == 0 && r.oversize == 0 && r.highWater <= capacity &&
+              r.received + r.dropped == r.produced && (lossy || r.dropped == 0);
+  printf("%-6s %-12s N=%-4u prodotti %u, ricevuti %u, scartati %u, rotti %u, fuori ordine %u, "
+         "max in coda %u, %.1f Mel/s\n",
+         pass ? "OK" : "ERRORE", name, capacity, r.produced, r.received, r.dropped, r.torn,
+         r.disorder, r.highWater, r.produced / r.seconds / 1e6);
+  return pass;
+}
+
+template <uint32_t N>
+static bool runBoth(uint32_t items, uint32_t seed) {
+  bool ok = report("senza perdite", N, false, runCase<N>(items, false, seed));
+  ok &= report("con perdite", N, true, runCase<N>(items, true, seed));
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  uint32_t items = 1000000;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      fprintf(stderr, "Opzione senza valore: %s\n", argv[i]);
+      return 2;
+    } else if (strcmp(argv[i], "--items") == 0) {
+      items = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(value, nullptr, 10); i++;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  printf("Thread hardware: %u\n", std::thread::hardware_concurrency());
+
+  // Coda minima (pieno/vuoto continui), intermedia e quella del firmware
+  bool ok = runBoth<2>(items, seed);
+  ok &= runBoth<64>(items, seed);
+  ok &= runBoth<INPUT_EVENT_QUEUE>(items, seed);
+  return ok ? 0 : 1;
+}
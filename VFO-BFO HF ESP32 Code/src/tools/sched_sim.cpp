@@ -0,0 +1,216 @@
+// Simulazione su PC dello scheduler del loop (scheduler.cpp) con orologio virtuale.
+// I task non fanno nulla: fanno avanzare l'orologio della loro durata simulata,
+// così periodi, priorità, ritardi, sforamenti e rilasci saltati si verificano
+// in modo deterministico, anche attorno al giro dei 32 bit di micros().
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e sched_sim
+//   .pio/build/sched_sim/program [-v]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../scheduler.h"
+
+static uint32_t virtualNow = 0;
+static bool verbose = false;
+static bool allOk = true;
+
+static uint32_t virtualClock() {
+  return virtualNow;
+}
+
+// Durata simulata di ogni task: fissa, più un picco a una certa esecuzione
+struct SimCost {
+  uint32_t us;
+  uint32_t spikeRun;            // Esecuzione con il picco (0 = nessuno)
+  uint32_t spikeUs;
+  uint32_t calls;
+  std::vector<uint32_t> starts; // Tempi di partenza (per ordine e raffiche)
+};
+
+#define SIM_TASKS 8
+static SimCost costs[SIM_TASKS];
+
+template <int I>
+static void simTask() {
+  SimCost& c = costs[I];
+  c.calls++;
+  c.starts.push_back(virtualNow);
+  virtualNow += c.calls == c.spikeRun ? c.spikeUs : c.us;
+}
+
+static void (*const simTasks[SIM_TASKS])() = {
+  simTask<0>, simTask<1>, simTask<2>, simTask<3>, simTask<4>, simTask<5>, simTask<6>, simTask<7>
+};
+
+static void check(const char* scenario, const char* what, bool pass, const char* detail = "") {
+  printf("%-6s %-18s %s %s\n", pass ? "OK" : "ERRORE", scenario, what, detail);
+  allOk &= pass;
+}
+
+// Prepara la tabella: funzioni e durate dei task nell'ordine dato
+static void setup(SchedTask* tasks, uint8_t count, const uint32_t* costUs) {
+  for (uint8_t i = 0; i < count; i++) {
+    costs[i] = SimCost();
+    costs[i].us = costUs[i];
+    tasks[i].run = simTasks[i];
+  }
+}
+
+// Esegue per durationUs di tempo virtuale; a vuoto salta al prossimo rilascio
+static void run(Scheduler& scheduler, uint32_t durationUs) {
+  uint32_t start = virtualNow;
+  while (virtualNow - start < durationUs) {
+    if (scheduler.runOnce() == nullptr) {
+      uint32_t wait = scheduler.untilNextUs();
+      virtualNow += wait ? wait : 1;
+    }
+  }
+}
+
+static void printStats(const Scheduler& scheduler) {
+  if (!verbose) return;
+  for (uint8_t i = 0; i < scheduler.size(); i++) {
+    const SchedTask& t = scheduler.task(i);
+    printf("    %-10s esecuzioni %6u, sforamenti %4u, saltati %4u, ritardo max %6u us, durata max %6u us\n",
+           t.name, t.runs, t.overruns, t.skipped, t.maxLateUs, t.maxRunUs);
+  }
+}
+
+// Tabella simile a quella del firmware, durate tipiche: conteggi esatti, nessuno sforamento
+static void scenarioPeriods(uint32_t startUs, const char* name) {
+  SchedTask tasks[] = {
+    {"input", nullptr, 1000, 20000, 0},
+    {"keyer", nullptr, 5000, 10000, 1},
+    {"misure", nullptr, 5000, 20000, 2},
+    {"display", nullptr, 20000, 40000, 3},
+    {"s-meter", nullptr, 50000, 100000, 4},
+    {"seriale", nullptr, 20000, 100000, 5},
+    {"eeprom", nullptr, 10000, 50000, 6}
+  };
+  const uint32_t cost[] = {30, 20, 50, 2500, 800, 100, 1200};
+  const uint8_t count = sizeof(tasks) / sizeof(tasks[0]);
+  setup(tasks, count, cost);
+
+  virtualNow = startUs;
+  Scheduler scheduler;
+  scheduler.begin(tasks, count, virtualClock);
+  const uint32_t duration = 10000000;
+  run(scheduler, duration);
+  printStats(scheduler);
+
+  bool counts = true, clean = true;
+  char detail[96] = "";
+  for (uint8_t i = 0; i < count; i++) {
+    uint32_t expected = duration / tasks[i].periodUs;
+    if (tasks[i].runs + 1 < expected || tasks[i].runs > expected + 1) {
+      counts = false;
+      snprintf(detail, sizeof(detail), "(%s: %u invece di %u)", tasks[i].name, tasks[i].runs, expected);
+    }
+    if (tasks[i].overruns || tasks[i].skipped) clean = false;
+  }
+  check(name, "esecuzioni = durata / periodo", counts, detail);
+  check(name, "nessuno sforamento", clean);
+
+  // Senza prelazione: l'input aspetta al più il task più lungo
+  uint32_t longest = 0;
+  for (uint8_t i = 1; i < count; i++) if (cost[i] > longest) longest = cost[i];
+  snprintf(detail, sizeof(detail), "(%u us, task più lungo %u us)", tasks[0].maxLateUs, longest);
+  check(name, "ritardo input limitato", tasks[0].maxLateUs <= longest, detail);
+}
+
+// Tre task pronti insieme: partono in ordine di priorità, non di tabella
+static void scenarioPriority() {
+  SchedTask tasks[] = {
+    {"basso", nullptr, 10000, 10000, 2},
+    {"alto", nullptr, 10000, 10000, 0},
+    {"medio", nullptr, 10000, 10000, 1}
+  };
+  const uint32_t cost[] = {100, 100, 100};
+  setup(tasks, 3, cost);
+
+  virtualNow = 5000;
+  Scheduler scheduler;
+  scheduler.begin(tasks, 3, virtualClock);
+  run(scheduler, 1000000);
+
+  bool ordered = true;
+  for (size_t k = 0; k < costs[0].starts.size(); k++) {
+    if (!(costs[1].starts[k] < costs[2].starts[k] && costs[2].starts[k] < costs[0].starts[k])) ordered = false;
+  }
+  check("priorità", "ordine alto > medio > basso", ordered);
+}
+
+// Task più lento della sua deadline: ogni esecuzione è uno sforamento
+static void scenarioOverrun() {
+  SchedTask tasks[] = {
+    {"lento", nullptr, 10000, 5000, 1},
+    {"veloce", nullptr, 10000, 5000, 0}
+  };
+  const uint32_t cost[] = {7000, 1000};
+  setup(tasks, 2, cost);
+
+  virtualNow = 0;
+  Scheduler scheduler;
+  scheduler.begin(tasks, 2, virtualClock);
+  run(scheduler, 1000000);
+  printStats(scheduler);
+
+  char detail[64];
+  snprintf(detail, sizeof(detail), "(%u su %u)", tasks[0].overruns, tasks[0].runs);
+  check("sforamento", "deadline mancate contate", tasks[0].overruns == tasks[0].runs && tasks[0].runs > 0, detail);
+  check("sforamento", "task veloce in regola", tasks[1].overruns == 0);
+}
+
+// Un task blocca il loop per 200ms: i rilasci persi dell'input si saltano.
+// Dopo il blocco: il rilascio rimasto in sospeso, uno di recupero e poi il
+// periodo normale, cioè al più 7 esecuzioni nei 5ms seguenti (non 200)
+static void scenarioStall() {
+  SchedTask tasks[] = {
+    {"input", nullptr, 1000, 20000, 0},
+    {"display", nullptr, 20000, 40000, 3}
+  };
+  const uint32_t cost[] = {30, 2000};
+  setup(tasks, 2, cost);
+  costs[1].spikeRun = 50;
+  costs[1].spikeUs = 200000;
+
+  virtualNow = 0;
+  Scheduler scheduler;
+  scheduler.begin(tasks, 2, virtualClock);
+  run(scheduler, 3000000);
+  printStats(scheduler);
+
+  // Fine del blocco e partenze dell'input nei 5ms seguenti
+  uint32_t stallEnd = costs[1].starts[49] + costs[1].spikeUs;
+  uint32_t burst = 0;
+  for (uint32_t s : costs[0].starts) {
+    if (s >= stallEnd && s - stallEnd < 5000) burst++;
+  }
+  char detail[64];
+  snprintf(detail, sizeof(detail), "(%u saltati)", tasks[0].skipped);
+  check("blocco", "rilasci persi saltati", tasks[0].skipped >= 195 && tasks[0].skipped <= 200, detail);
+  snprintf(detail, sizeof(detail), "(%u esecuzioni in 5ms)", burst);
+  check("blocco", "nessuna raffica dopo", burst <= 7, detail);
+  check("blocco", "sforamento del display", tasks[1].overruns == 1);
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  scenarioPeriods(0, "periodi");
+  scenarioPeriods(UINT32_MAX - 5000000, "giro di micros()");
+  scenarioPriority();
+  scenarioOverrun();
+  scenarioStall();
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Prova di carico su PC dell'istantanea radio -> display (seqlock.h).
+// Un thread scrittore fa la parte del loop e pubblica di continuo, un thread
+// lettore quella del task UI e copia di continuo, su core diversi. Ogni valore
+// pubblicato è ricavato dal suo numero n: una copia mescolata tra due
+// pubblicazioni (scrittura a metà) non torna col controllo.
+// Inoltre la versione letta deve essere 2n (nessuna pubblicazione persa nel
+// conteggio) e non tornare mai indietro. Lo scrittore non aspetta mai il lettore.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e seqlock_stress
+//   .pio/build/seqlock_stress/program [opzioni]
+//
+// Opzioni:
+//   --writes N        Pubblicazioni per prova (default 2000000)
+//   --seed N          Seme delle pause casuali
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include "../seqlock.h"
+#include "../ui_task.h"
+
+// L'istantanea del firmware: tutti i campi ricavati da displayedFrequency
+static void fill(RadioSnapshot& s, uint32_t n) {
+  s.displayedFrequency = n;
+  s.step = n * 2654435761u;
+  s.bfoFrequency = ~n;
+  s.mode = n & 3;
+  s.bfoEnabled = n & 4;
+  s.agcFast = n & 8;
+  s.attenuator = n & 16;
+  s.sMeter = n % 26;
+  s.sweepActive = n & 32;
+  s.sweepPlot = n & 64;
+}
+
+static bool consistent(const RadioSnapshot& s, uint32_t& n) {
+  n = s.displayedFrequency;
+  RadioSnapshot expected;
+  fill(expected, n);
+  return s.step == expected.step && s.bfoFrequency == expected.bfoFrequency &&
+         s.mode == expected.mode && s.bfoEnabled == expected.bfoEnabled &&
+         s.agcFast == expected.agcFast && s.attenuator == expected.attenuator &&
+         s.sMeter == expected.sMeter && s.sweepActive == expected.sweepActive &&
+         s.sweepPlot == expected.sweepPlot;
+}
+
+// 64 byte: finestra di scrittura più larga, copie a metà più probabili
+struct Wide {
+  uint32_t words[16];
+};
+
+static void fill(Wide& w, uint32_t n) {
+  for (uint32_t i = 0; i < 16; i++) w.words[i] = n ^ (i * 0x9E3779B9u);
+}
+
+static bool consistent(const Wide& w, uint32_t& n) {
+  n = w.words[0];
+  for (uint32_t i = 1; i < 16; i++) {
+    if (w.words[i] != (n ^ (i * 0x9E3779B9u))) return false;
+  }
+  return true;
+}
+
+struct Result {
+  uint32_t written = 0, reads = 0, retries = 0;
+  uint32_t torn = 0, wrongVersion = 0, backwards = 0;
+  double writeSeconds = 0;
+};
+
+// Scrittore a metà: qualche yield, poi una pausa vera. Con un solo core
+// yield() può ridare il processore allo stesso thread.
+static void backoff(uint32_t& spins) {
+  if (++spins < 16) std::this_thread::yield();
+  else std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+// Con pause il lettore fa la parte di un ridisegno lungo: lo scrittore non deve accorgersene
+template <typename T>
+static Result runCase(uint32_t writes, bool slowReader, uint32_t seed) {
+  std::unique_ptr<Seqlock<T>> lock(new Seqlock<T>());
+  Seqlock<T>& snapshot = *lock;
+  std::atomic<bool> done{false};
+  Result r;
+
+  std::thread writer([&] {
+    std::mt19937 rng(seed);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 1; n <= writes; n++) {
+      T value;
+      fill(value, n);
+      snapshot.write(value);
+      // Ogni tanto cede il processore: con un solo core il lettore resta a metà copia
+      if (rng() % 128 == 0) std::this_thread::yield();
+    }
+    r.writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done.store(true, std::memory_order_release);
+  });
+
+  std::thread reader([&] {
+    std::mt19937 rng(seed + 1);
+    uint32_t last = 0;
+    for (;;) {
+      bool finished = done.load(std::memory_order_acquire);
+      T value;
+      uint32_t version, spins = 0;
+      while (!snapshot.tryRead(value, version)) {
+        r.retries++;
+        backoff(spins);
+      }
+      r.reads++;
+
+      uint32_t n = 0;
+      if (version != 0) {
+        if (!consistent(value, n)) r.torn++;
+        if (version != 2 * n) r.wrongVersion++;
+      }
+      if (version < last) r.backwards++;
+      last = version;
+
+      if (finished) break;
+      if (slowReader && rng() % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+      else if (rng() % 16 == 0) std::this_thread::yield();
+    }
+    // L'ultima lettura dopo la fine deve vedere l'ultima pubblicazione
+    if (last != 2 * writes) r.wrongVersion++;
+  });
+
+  writer.join();
+  reader.join();
+
+  r.written = writes;
+  return r;
+}
+
+static bool report(const char* name, const Result& r) {
+  bool pass = r.torn == 0 && r.wrongVersion == 0 && r.backwards == 0;
+  printf("%-6s %-22s pubblicate %u, letture %u, ripetute %u, rotte %u, versione errata %u, "
+         "all'indietro %u, %.1f Mpub/s\n",
+         pass ? "OK" : "ERRORE", name, r.written, r.reads, r.retries, r.torn, r.wrongVersion,
+         r.backwards, r.written / r.writeSeconds / 1e6);
+  return pass;
+}
+
+// Prima di ogni pubblicazione: versione 0 e valore azzerato, senza attese
+static bool checkEmpty() {
+  Seqlock<RadioSnapshot> snapshot;
+  RadioSnapshot s;
+  memset(&s, 0xFF, sizeof(s));
+  uint32_t version = 1;
+  bool pass = snapshot.tryRead(s, version) && version == 0 && s.displayedFrequency == 0 &&
+              snapshot.version() == 0;
+  printf("%-6s %-22s\n", pass ? "OK" : "ERRORE", "mai pubblicato");
+  return pass;
+}
+
+int main(int argc, char** argv) {
+  uint32_t writes = 2000000;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      fprintf(stderr, "Opzione senza valore: %s\n", argv[i]);
+      return 2;
+    } else if (strcmp(argv[i], "--writes") == 0) {
+      writes = strtoul(value, nullptr, 10); i++;
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(value, nullptr, 10); i++;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  printf("Thread hardware: %u\n", std::thread::hardware_concurrency());
+
+  bool ok = checkEmpty();
+  ok &= report("istantanea radio", runCase<RadioSnapshot>(writes, false, seed));
+  ok &= report("istantanea, UI lenta", runCase<RadioSnapshot>(writes, true, seed));
+  ok &= report("64 byte", runCase<Wide>(writes, false, seed));
+  ok &= report("64 byte, UI lenta", runCase<Wide>(writes, true, seed));
+  return ok ? 0 : 1;
+}
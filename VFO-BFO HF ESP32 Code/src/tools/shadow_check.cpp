@@ -0,0 +1,225 @@
+// Verifica su PC delle scritture diff del Si5351 (PLL_plan + PLL_shadow).
+// Un bus finto tiene la copia dei registri del chip e conta transazioni e byte;
+// le risintonie seguono lo stesso percorso del firmware (si5351ApplyVFO e
+// si5351ApplyBFO in PLL.cpp): finestra glide dal piano di banda, immagine dei
+// registri, stage dei blocchi Multisynth e PLL, flush.
+//
+// Dopo ogni flush i registri del chip devono essere uguali all'immagine
+// calcolata (nessun byte perso dalla scrittura parziale) e il traffico deve
+// restare nei limiti del tipo di risintonia:
+//   10 Hz glide           una transazione, 2-3 byte bassi di p2 in PLLA; fino
+//                         a 5 solo quando il riporto arriva in p1 (sotto l'1%)
+//   1 kHz glide           una transazione dentro il blocco PLLA
+//   cambio divisore       blocco PLL + blocco Multisynth (banda o zona spuria)
+//   BFO 10 Hz             una transazione nel Multisynth 1
+//   stessa frequenza      nessuna transazione
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e shadow_check
+//   .pio/build/shadow_check/program [-v]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../config.h"
+#include "../bands.h"
+#include "../PLL_plan.h"
+#include "../PLL_spur.h"
+#include "../PLL_shadow.h"
+
+// Indirizzi dei registri (libreria Etherkit)
+#define REG_PLLA 26
+#define REG_PLLB 34
+#define REG_MS0  42
+#define REG_MS1  50
+
+// ==================== BUS FINTO ====================
+
+static uint8_t chip[SHADOW_REG_COUNT];
+static uint32_t busTransactions = 0;
+static uint32_t busBytes = 0;           // Byte di dati, senza l'indirizzo del registro
+static bool verbose = false;
+
+static uint8_t mockBusWrite(uint8_t reg, const uint8_t* data, uint8_t len) {
+  memcpy(chip + reg, data, len);
+  busTransactions++;
+  busBytes += len;
+  if (verbose) {
+    printf("    reg %3u:", reg);
+    for (uint8_t i = 0; i < len; i++) printf(" %02X", data[i]);
+    printf("\n");
+  }
+  return 0;
+}
+
+// ==================== SINTONIA ====================
+
+static Si5351Shadow shadow;
+static GlideWindow vfoWindow = {0, 0, 0};
+static const uint32_t ref = correctedRef(0);
+
+struct Retune {
+  bool ok;                // Piano valido e registri del chip uguali all'immagine
+  bool replan;            // Divisore del Multisynth cambiato
+  uint32_t transactions;
+  uint32_t bytes;
+};
+
+static Retune flushAndCheck(uint8_t pllReg, uint8_t msReg, const SynthImage& image, bool replan) {
+  uint32_t transactions = busTransactions;
+  uint32_t bytes = busBytes;
+  shadow.flush();
+
+  Retune r;
+  r.ok = memcmp(chip + pllReg, image.pll, 8) == 0 && memcmp(chip + msReg, image.ms, 8) == 0;
+  r.replan = replan;
+  r.transactions = busTransactions - transactions;
+  r.bytes = busBytes - bytes;
+  return r;
+}
+
+// Come si5351ApplyVFO() in modo glide; recall riparte dal divisore primario
+static Retune tuneVFO(uint32_t freq, bool recall) {
+  GlideWindow next;
+  GlideWindow current = recall ? GlideWindow{0, 0, 0} : vfoWindow;
+  planSpurAwareWindow(freq, ref, current, next);
+
+  SynthPlan plan;
+  if (next.msDiv == 0 || !planGlide(freq, next.msDiv, ref, plan)) return Retune{false, false, 0, 0};
+  bool replan = next.msDiv != vfoWindow.msDiv;
+  vfoWindow = next;
+
+  SynthImage image;
+  encodeSynthImage(plan, image);
+  shadow.stage(REG_MS0, image.ms, 8);
+  shadow.stage(REG_PLLA, image.pll, 8);
+  return flushAndCheck(REG_PLLA, REG_MS0, image, replan);
+}
+
+// Come si5351ApplyBFO(): PLLB fisso, sintonia nel Multisynth 1
+static Retune tuneBFO(uint32_t freq) {
+  SynthPlan plan;
+  if (!planFixedPLL(freq, PLL_FIXED_FREQ, ref, plan)) return Retune{false, false, 0, 0};
+
+  SynthImage image;
+  encodeSynthImage(plan, image);
+  shadow.stage(REG_MS1, image.ms, 8);
+  shadow.stage(REG_PLLB, image.pll, 8);
+  return flushAndCheck(REG_PLLB, REG_MS1, image, false);
+}
+
+// ==================== VERIFICHE ====================
+
+// Limiti per risintonia: transazioni e byte di dati, e byte del caso tipico
+// (almeno il 99% delle risintonie, 0 = nessun limite a parte)
+struct Limits {
+  uint32_t transactions;
+  uint32_t bytes;
+  uint32_t typicalBytes;
+};
+
+struct Tally {
+  uint32_t retunes = 0, failed = 0, replans = 0, overTypical = 0;
+  uint32_t maxTransactions = 0, maxBytes = 0;
+  uint64_t bytes = 0;
+};
+
+static void count(Tally& t, const Retune& r, const Limits& limits) {
+  t.retunes++;
+  if (r.replan) t.replans++;
+  if (!r.ok || r.transactions > limits.transactions || r.bytes > limits.bytes) t.failed++;
+  if (limits.typicalBytes && r.bytes > limits.typicalBytes) t.overTypical++;
+  if (r.transactions > t.maxTransactions) t.maxTransactions = r.transactions;
+  if (r.bytes > t.maxBytes) t.maxBytes = r.bytes;
+  t.bytes += r.bytes;
+}
+
+static bool report(const char* name, const Tally& t, const Limits& limits) {
+  bool pass = t.retunes > 0 && t.failed == 0 && (uint64_t)t.overTypical * 100 <= t.retunes;
+  printf("%-6s %-16s risintonie %6u, fuori limite %4u, cambi divisore %4u, "
+         "transazioni max %u (limite %u), byte max %2u (limite %2u), medi %.2f",
+         pass ? "OK" : "ERRORE", name, t.retunes, t.failed, t.replans,
+         t.maxTransactions, limits.transactions, t.maxBytes, limits.bytes,
+         t.retunes ? (double)t.bytes / t.retunes : 0.0);
+  if (limits.typicalBytes) printf(", oltre %u byte %u (%.2f%%)", limits.typicalBytes, t.overTypical,
+                                  100.0 * t.overTypical / t.retunes);
+  printf("\n");
+  return pass;
+}
+
+// Passi glide su tutte le bande: quelli che restano nel divisore vanno in
+// "steady", quelli che lo cambiano (zona spuria) in "replan"
+static void glideSteps(uint32_t stepHz, const Limits& steady, const Limits& replan,
+                       Tally& steadyTally, Tally& replanTally) {
+  for (int b = 0; b < totalBands; b++) {
+    uint32_t low = bands[b].startFreq + IF_FREQUENCY;
+    uint32_t high = bands[b].endFreq + IF_FREQUENCY;
+    tuneVFO(low, true);
+    for (uint32_t f = low + stepHz; f <= high; f += stepHz) {
+      Retune r = tuneVFO(f, false);
+      if (r.replan) count(replanTally, r, replan);
+      else count(steadyTally, r, steady);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  // Chip appena acceso: la copia non conosce nessun registro
+  memset(chip, 0, sizeof(chip));
+  shadow.begin(mockBusWrite);
+
+  const Limits fine = {1, 5, 3};    // Passo piccolo: byte bassi di p2, riporto in p1
+  const Limits coarse = {1, 8, 0};  // Al più il blocco PLL
+  const Limits full = {2, 16, 0};   // Blocco PLL + blocco Multisynth
+  const Limits none = {0, 0, 0};
+  bool ok = true;
+
+  // Prima scrittura: tutto da inviare
+  Tally first;
+  count(first, tuneVFO(bands[0].startFreq + IF_FREQUENCY, true), full);
+  ok &= report("prima scrittura", first, full);
+
+  // Passi su tutte le bande: il divisore cambia solo entrando nelle zone spurie
+  Tally fine10, fineReplan;
+  glideSteps(10, fine, full, fine10, fineReplan);
+  ok &= report("VFO 10 Hz", fine10, fine);
+  if (fineReplan.retunes) ok &= report("VFO 10 Hz zone", fineReplan, full);
+
+  Tally coarse1k, coarseReplan;
+  glideSteps(1000, coarse, full, coarse1k, coarseReplan);
+  ok &= report("VFO 1 kHz", coarse1k, coarse);
+  if (coarseReplan.retunes) ok &= report("VFO 1 kHz zone", coarseReplan, full);
+
+  // Cambio banda: richiamo dell'inizio banda, divisore nuovo ogni volta
+  Tally bandChange;
+  for (int round = 0; round < 2; round++) {
+    for (int b = 0; b < totalBands; b++) {
+      count(bandChange, tuneVFO(bands[b].startFreq + IF_FREQUENCY, true), full);
+    }
+  }
+  ok &= report("cambio banda", bandChange, full);
+
+  // Stessa frequenza due volte: la copia non deve scrivere niente
+  Tally repeat;
+  uint32_t f = bands[3].startFreq + IF_FREQUENCY + 12340;
+  tuneVFO(f, false);
+  for (int i = 0; i < 100; i++) count(repeat, tuneVFO(f, false), none);
+  ok &= report("stessa frequenza", repeat, none);
+
+  // BFO: PLLB fisso a 800MHz, passi di pitch nel Multisynth 1
+  Tally bfo;
+  tuneBFO(BFO_USB_BASE);
+  for (uint32_t b = BFO_USB_BASE + 10; b <= BFO_USB_BASE + 3000; b += 10) count(bfo, tuneBFO(b), coarse);
+  ok &= report("BFO 10 Hz", bfo, coarse);
+
+  return ok ? 0 : 1;
+}
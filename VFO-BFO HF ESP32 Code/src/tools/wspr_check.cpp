@@ -0,0 +1,344 @@
+// Verifica su PC del codificatore WSPR del firmware (wspr.cpp).
+// Il controllo non usa niente di wspr.cpp oltre a wsprEncode(): un codificatore
+// di riferimento scritto qui dalla descrizione del protocollo (G4JNT, "The
+// WSPR Coding Process") ha la sua tabella di sincronismo, i suoi polinomi, il
+// suo impacchettamento e il suo interleave a inversione di bit. Per ogni
+// messaggio i 162 simboli del firmware devono essere uguali a quelli del
+// riferimento e la decodifica (con le tabelle di qui) deve ridare nominativo,
+// locatore e potenza.
+// I simboli sono poi confrontati uno a uno con vettori fissi (vectors[]): uno
+// pubblicato da WSJT-X e uno fissato contro le regressioni. Con --ref confronta
+// anche con un vettore da file, per esempio i "channel symbols" stampati da
+// wsprcode di WSJT-X per lo stesso messaggio.
+//
+// Compilazione ed esecuzione (ambiente nativo di PlatformIO):
+//   pio run -e wspr_check
+//   .pio/build/wspr_check/program [--ref FILE NOMINATIVO LOCATORE DBM]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../wspr.h"
+
+struct WsprMessage {
+  const char* call;
+  const char* locator;
+  int8_t dBm;
+  const char* expectedCall;   // Nominativo come viene ricostruito
+};
+
+static const WsprMessage messages[] = {
+  {"K1ABC", "FN42", 37, "K1ABC"},
+  {"IZ0ABC", "JN61", 10, "IZ0ABC"},
+  {"g4jnt", "io90", 30, "G4JNT"},
+  {"2E0XYZ", "IO91", 0, "2E0XYZ"},
+  {"W1AW", "FN31", 60, "W1AW"},
+  {"A1B", "AA00", 3, "A1B"},
+  {"ZZ9ZZZ", "RR99", 53, "ZZ9ZZZ"}
+};
+
+// Messaggi che il codificatore deve rifiutare
+static const WsprMessage invalid[] = {
+  {"ABCDEF", "JN61", 10, nullptr},    // Nessuna cifra in terza posizione
+  {"IZ0ABC", "JS61", 10, nullptr},    // Locatore oltre R
+  {"IZ0ABC", "JN61", 11, nullptr},    // Potenza non ammessa
+  {"IZ0ABCD", "JN61", 10, nullptr}    // Nominativo troppo lungo
+};
+
+// Vettori fissi. published: uscita di wsprcode di WSJT-X per il messaggio di
+// esempio della documentazione; gli altri sono istantanee di questo
+// codificatore, controllate con il riferimento qui sotto e fissate contro le
+// regressioni (non sono un riferimento esterno).
+struct WsprVector {
+  const char* call;
+  const char* locator;
+  int8_t dBm;
+  bool published;
+  uint8_t symbols[WSPR_SYMBOL_COUNT];
+};
+
+static const WsprVector vectors[] = {
+  {"K1ABC", "FN42", 37, true, {
+    3, 3, 0, 0, 2, 0, 0, 0, 1, 0, 2, 0, 1, 3, 1, 2, 2, 2, 1, 0, 0, 3, 2, 3, 1, 3, 3,
+    2, 2, 0, 2, 0, 0, 0, 3, 2, 0, 1, 2, 3, 2, 2, 0, 0, 2, 2, 3, 2, 1, 1, 0, 2, 3, 3,
+    2, 1, 0, 2, 2, 1, 3, 2, 1, 2, 2, 2, 0, 3, 3, 0, 3, 0, 3, 0, 1, 2, 1, 0, 2, 1, 2,
+    0, 3, 2, 1, 3, 2, 0, 0, 3, 3, 2, 3, 0, 3, 2, 2, 0, 3, 0, 2, 0, 2, 0, 1, 0, 2, 3,
+    0, 2, 1, 1, 1, 2, 3, 3, 0, 2, 3, 1, 2, 1, 2, 2, 2, 1, 3, 3, 2, 0, 0, 0, 0, 1, 0,
+    3, 2, 0, 1, 3, 2, 2, 2, 2, 2, 0, 2, 3, 3, 2, 3, 2, 3, 3, 2, 0, 0, 3, 1, 2, 2, 2
+  }},
+  {"G4JNT", "IO90", 30, false, {
+    3, 3, 2, 2, 0, 0, 0, 0, 1, 2, 2, 2, 3, 3, 3, 0, 2, 2, 1, 0, 0, 1, 2, 1, 1, 3, 3,
+    2, 2, 0, 2, 0, 0, 0, 3, 0, 0, 1, 2, 1, 0, 0, 0, 0, 2, 0, 1, 2, 1, 1, 2, 0, 3, 3,
+    0, 3, 0, 2, 0, 1, 1, 2, 1, 0, 2, 0, 2, 1, 3, 0, 1, 0, 3, 0, 1, 0, 1, 2, 0, 3, 2,
+    0, 1, 0, 1, 1, 0, 2, 2, 1, 1, 2, 3, 0, 1, 2, 2, 2, 3, 2, 0, 0, 0, 2, 3, 2, 0, 1,
+    0, 0, 1, 1, 1, 2, 1, 1, 2, 0, 3, 1, 2, 3, 0, 0, 0, 3, 3, 1, 2, 2, 2, 2, 0, 1, 2,
+    1, 2, 0, 3, 1, 0, 0, 2, 2, 2, 2, 2, 1, 3, 0, 1, 2, 1, 3, 2, 0, 0, 3, 1, 2, 2, 2
+  }}
+};
+
+// ==================== CODIFICATORE DI RIFERIMENTO ====================
+
+// Vettore di sincronismo come nella descrizione del protocollo
+static const char refSync[] =
+  "110000001000111000100101111000000010010100000010110011"
+  "010001101000011010101010010010110001101010001000001001"
+  "001110110011010001110000010100110000000110101100011000";
+
+#define REF_POLY1 0xF2D05351UL
+#define REF_POLY2 0xE4613C47UL
+#define REF_DATA_BITS 50
+#define REF_CODED_BITS 81            // Dati + 31 zeri di coda
+
+// refOrder[k]: posizione in trasmissione del k-esimo simbolo della convoluzione
+static uint8_t refOrder[WSPR_SYMBOL_COUNT];
+
+static uint8_t reverseBits(uint8_t v) {
+  uint8_t r = 0;
+  for (uint8_t b = 0; b < 8; b++) {
+    r = (r << 1) | (v & 1);
+    v >>= 1;
+  }
+  return r;
+}
+
+// Indici 0..255 a bit invertiti, tenendo solo quelli sotto 162
+static void buildOrder() {
+  uint8_t k = 0;
+  for (uint16_t i = 0; i < 256; i++) {
+    uint8_t j = reverseBits(i);
+    if (j < WSPR_SYMBOL_COUNT) refOrder[k++] = j;
+  }
+}
+
+static uint8_t refSyncBit(uint8_t i) {
+  return refSync[i] - '0';
+}
+
+// 0-9 -> 0-9, A-Z -> 10-35, spazio -> 36
+static uint32_t refCharValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+  return 36;
+}
+
+static uint8_t parity32(uint32_t v) {
+  v ^= v >> 16;
+  v ^= v >> 8;
+  v ^= v >> 4;
+  v ^= v >> 2;
+  v ^= v >> 1;
+  return v & 1;
+}
+
+static void upperCopy(const char* in, char* out) {
+  while (*in) {
+    *out++ = (*in >= 'a' && *in <= 'z') ? *in - ('a' - 'A') : *in;
+    in++;
+  }
+  *out = '\0';
+}
+
+// Solo messaggi validi: la validazione è del firmware e si verifica a parte
+static void referenceEncode(const char* callIn, const char* locatorIn, int8_t dBm,
+                            uint8_t symbols[WSPR_SYMBOL_COUNT]) {
+  char upper[8], loc[5];
+  upperCopy(callIn, upper);
+  upperCopy(locatorIn, loc);
+
+  // Cifra in terza posizione: se è la seconda si aggiunge uno spazio davanti
+  char call[7] = "      ";
+  uint8_t shift = (upper[2] >= '0' && upper[2] <= '9') ? 0 : 1;
+  for (uint8_t i = 0; upper[i] && i + shift < 6; i++) call[i + shift] = upper[i];
+
+  uint32_t n = refCharValue(call[0]);
+  n = n * 36 + refCharValue(call[1]);
+  n = n * 10 + refCharValue(call[2]);
+  for (uint8_t i = 3; i < 6; i++) n = n * 27 + refCharValue(call[i]) - 10;
+
+  uint32_t m = (179 - 10 * (loc[0] - 'A') - (loc[2] - '0')) * 180 + 10 * (loc[1] - 'A') + (loc[3] - '0');
+  m = m * 128 + dBm + 64;
+
+  uint8_t bits[REF_CODED_BITS] = {0};
+  for (uint8_t i = 0; i < 28; i++) bits[i] = (n >> (27 - i)) & 1;
+  for (uint8_t i = 0; i < 22; i++) bits[28 + i] = (m >> (21 - i)) & 1;
+
+  uint32_t reg = 0;
+  for (uint8_t i = 0; i < REF_CODED_BITS; i++) {
+    reg = (reg << 1) | bits[i];
+    uint8_t j0 = refOrder[2 * i], j1 = refOrder[2 * i + 1];
+    symbols[j0] = refSyncBit(j0) + 2 * parity32(reg & REF_POLY1);
+    symbols[j1] = refSyncBit(j1) + 2 * parity32(reg & REF_POLY2);
+  }
+}
+
+// ==================== DECODIFICA ====================
+
+static char callChar(uint32_t value) {
+  if (value < 10) return '0' + value;
+  if (value < 36) return 'A' + value - 10;
+  return ' ';
+}
+
+// Inverte la codifica: false se sincronismo o ridondanza non tornano
+static bool decodeSymbols(const uint8_t symbols[WSPR_SYMBOL_COUNT], char call[7], char locator[5], int& dBm) {
+  uint8_t coded[WSPR_SYMBOL_COUNT];
+  for (uint8_t i = 0; i < WSPR_SYMBOL_COUNT; i++) {
+    uint8_t j = refOrder[i];
+    if ((symbols[j] & 1) != refSyncBit(j) || symbols[j] >= WSPR_TONES) return false;
+    coded[i] = symbols[j] >> 1;
+  }
+
+  // Il bit 0 di REF_POLY1 è 1: ogni bit d'ingresso si ricava dal primo simbolo
+  uint8_t bits[REF_CODED_BITS];
+  uint32_t reg = 0;
+  for (uint8_t i = 0; i < REF_CODED_BITS; i++) {
+    uint8_t bit = coded[2 * i] ^ parity32((reg << 1) & REF_POLY1);
+    reg = (reg << 1) | bit;
+    if (coded[2 * i + 1] != parity32(reg & REF_POLY2)) return false;
+    bits[i] = bit;
+  }
+  for (uint8_t i = REF_DATA_BITS; i < REF_CODED_BITS; i++) {
+    if (bits[i] != 0) return false;   // Coda a zero
+  }
+
+  uint32_t n = 0, m = 0;
+  for (uint8_t i = 0; i < 28; i++) n = (n << 1) | bits[i];
+  for (uint8_t i = 28; i < REF_DATA_BITS; i++) m = (m << 1) | bits[i];
+
+  char c[6];
+  for (int8_t i = 5; i >= 3; i--) {
+    c[i] = callChar(n % 27 + 10);
+    n /= 27;
+  }
+  c[2] = callChar(n % 10);
+  n /= 10;
+  c[1] = callChar(n % 36);
+  c[0] = callChar(n / 36);
+
+  // Nominativo senza spazi iniziali e finali
+  uint8_t first = 0, last = 6;
+  while (first < last && c[first] == ' ') first++;
+  while (last > first && c[last - 1] == ' ') last--;
+  memcpy(call, c + first, last - first);
+  call[last - first] = '\0';
+
+  dBm = (int)(m % 128) - 64;
+  uint32_t grid = m / 128;
+  uint32_t t = 179 - grid / 180;
+  locator[0] = 'A' + t / 10;
+  locator[1] = 'A' + (grid % 180) / 10;
+  locator[2] = '0' + t % 10;
+  locator[3] = '0' + grid % 10;
+  locator[4] = '\0';
+  return true;
+}
+
+// Confronto simbolo per simbolo tra due vettori
+static bool compareSymbols(const char* what, const char* call, const char* locator, int8_t dBm,
+                           const uint8_t symbols[WSPR_SYMBOL_COUNT], const uint8_t expected[WSPR_SYMBOL_COUNT]) {
+  int differences = 0;
+  for (int i = 0; i < WSPR_SYMBOL_COUNT; i++) {
+    if (symbols[i] == expected[i]) continue;
+    if (differences++ < 10) printf("  simbolo %3d: %u invece di %u\n", i, symbols[i], expected[i]);
+  }
+  printf("%-6s %-6s %s %2d %s: %d simboli diversi\n",
+         differences ? "ERRORE" : "OK", call, locator, dBm, what, differences);
+  return differences == 0;
+}
+
+// Firmware uguale al riferimento e decodificabile nel suo messaggio
+static bool checkMessage(const WsprMessage& msg) {
+  uint8_t symbols[WSPR_SYMBOL_COUNT], reference[WSPR_SYMBOL_COUNT];
+  if (!wsprEncode(msg.call, msg.locator, msg.dBm, symbols)) {
+    printf("ERRORE %s %s %d: rifiutato\n", msg.call, msg.locator, msg.dBm);
+    return false;
+  }
+  referenceEncode(msg.call, msg.locator, msg.dBm, reference);
+  bool ok = compareSymbols("contro il riferimento", msg.call, msg.locator, msg.dBm, symbols, reference);
+
+  char call[7], locator[5], expectedLocator[5];
+  int dBm;
+  upperCopy(msg.locator, expectedLocator);
+  bool decoded = decodeSymbols(symbols, call, locator, dBm) &&
+                 strcmp(call, msg.expectedCall) == 0 &&
+                 strcmp(locator, expectedLocator) == 0 && dBm == msg.dBm;
+
+  printf("%-6s %-6s %s %2d -> %s %s %d\n", decoded ? "OK" : "ERRORE",
+         msg.call, msg.locator, msg.dBm, decoded ? call : "?", decoded ? locator : "?", decoded ? dBm : 0);
+  return ok && decoded;
+}
+
+// Vettore fisso: uguale al firmware e al riferimento
+static bool checkVector(const WsprVector& v) {
+  const char* what = v.published ? "contro wsprcode" : "contro l'istantanea";
+  uint8_t symbols[WSPR_SYMBOL_COUNT], reference[WSPR_SYMBOL_COUNT];
+  if (!wsprEncode(v.call, v.locator, v.dBm, symbols)) {
+    printf("ERRORE %s %s %d: rifiutato\n", v.call, v.locator, v.dBm);
+    return false;
+  }
+  referenceEncode(v.call, v.locator, v.dBm, reference);
+  bool ok = compareSymbols(what, v.call, v.locator, v.dBm, symbols, v.symbols);
+  if (v.published) ok &= compareSymbols("riferimento contro wsprcode", v.call, v.locator, v.dBm, reference, v.symbols);
+  return ok;
+}
+
+// Confronto con un vettore da file: 162 cifre 0-3 separate da spazi
+static bool checkReference(const char* path, const char* call, const char* locator, int8_t dBm) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    perror(path);
+    return false;
+  }
+
+  uint8_t reference[WSPR_SYMBOL_COUNT];
+  int count = 0;
+  int c;
+  while (count < WSPR_SYMBOL_COUNT && (c = fgetc(file)) != EOF) {
+    if (c >= '0' && c <= '3') reference[count++] = c - '0';
+  }
+  fclose(file);
+
+  if (count != WSPR_SYMBOL_COUNT) {
+    printf("ERRORE %s: %d simboli letti\n", path, count);
+    return false;
+  }
+
+  uint8_t symbols[WSPR_SYMBOL_COUNT];
+  if (!wsprEncode(call, locator, dBm, symbols)) {
+    printf("ERRORE %s %s %d: rifiutato\n", call, locator, dBm);
+    return false;
+  }
+  return compareSymbols(path, call, locator, dBm, symbols, reference);
+}
+
+int main(int argc, char** argv) {
+  bool ok = true;
+  buildOrder();
+
+  for (const WsprMessage& msg : messages) ok &= checkMessage(msg);
+
+  for (const WsprVector& v : vectors) ok &= checkVector(v);
+
+  for (const WsprMessage& msg : invalid) {
+    uint8_t symbols[WSPR_SYMBOL_COUNT];
+    bool rejected = !wsprEncode(msg.call, msg.locator, msg.dBm, symbols);
+    printf("%-6s %s %s %d rifiutato\n", rejected ? "OK" : "ERRORE", msg.call, msg.locator, msg.dBm);
+    ok &= rejected;
+  }
+
+  if (argc == 6 && strcmp(argv[1], "--ref") == 0) {
+    ok &= checkReference(argv[2], argv[3], argv[4], (int8_t)atoi(argv[5]));
+  } else if (argc != 1) {
+    fprintf(stderr, "Uso: %s [--ref FILE NOMINATIVO LOCATORE DBM]\n", argv[0]);
+    return 2;
+  }
+
+  // Tempo di simbolo e spaziatura toni
+  printf("Simbolo %.4f s (%.4f baud), toni:", (double)WSPR_SYMBOL_NUM / WSPR_SYMBOL_DEN,
+         (double)WSPR_SYMBOL_DEN / WSPR_SYMBOL_NUM);
+  for (uint8_t t = 0; t < WSPR_TONES; t++) printf(" %u.%03u", wsprToneMilliHz(t) / 1000, wsprToneMilliHz(t) % 1000);
+  printf(" Hz\n");
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#include "tuning_accel.h"
+
+void TuningAccel::begin(const AccelPoint* accelCurve, uint8_t count, uint32_t idleUs) {
+  curve = accelCurve;
+  points = count;
+  idle = idleUs;
+  rateX16 = 0;
+  lastDirection = 0;
+  lastMultiplier = 1;
+}
+
+uint16_t TuningAccel::hzAt(uint32_t rate) const {
+  if (points == 0) return 0;
+  if (rate <= curve[0].rate) return curve[0].hzPerDetent;
+  for (uint8_t i = 1; i < points; i++) {
+    if (rate >= curve[i].rate) continue;
+    const AccelPoint& a = curve[i - 1];
+    const AccelPoint& b = curve[i];
+    return a.hzPerDetent + (int32_t)(b.hzPerDetent - a.hzPerDetent) * (int32_t)(rate - a.rate) / (b.rate - a.rate);
+  }
+  return curve[points - 1].hzPerDetent;
+}
+
+int32_t TuningAccel::apply(int32_t detents, uint32_t nowUs, uint32_t stepHz) {
+  if (detents == 0) return 0;
+
+  int8_t direction = detents > 0 ? 1 : -1;
+  uint32_t count = detents > 0 ? detents : -detents;
+  uint32_t elapsed = nowUs - lastUs;
+  lastUs = nowUs;
+
+  // Pausa o inversione: precisione, si riparte da fermi
+  if (direction != lastDirection || elapsed > idle) {
+    rateX16 = 0;
+  } else {
+    // Velocità di questo giro, poi media mobile 1/4
+    uint32_t instantX16 = elapsed ? (uint32_t)((uint64_t)count * 16000000 / elapsed) : rateX16;
+    rateX16 += ((int32_t)instantX16 - (int32_t)rateX16) / 4;
+  }
+  lastDirection = direction;
+
+  // Hz per scatto in passi interi di step, almeno uno
+  uint32_t hz = hzAt(rateX16 / 16);
+  lastMultiplier = stepHz && hz > stepHz ? hz / stepHz : 1;
+  return detents * (int32_t)lastMultiplier;
+}
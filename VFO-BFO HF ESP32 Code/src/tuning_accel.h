@@ -0,0 +1,42 @@
+#ifndef TUNING_ACCEL_H
+#define TUNING_ACCEL_H
+
+#include <stdint.h>
+
+// Accelerazione della sintonia in base alla velocità dell'encoder.
+// La velocità (scatti/s) è una media mobile dei tempi tra gli scatti; la curva
+// la converte in Hz per scatto, interpolando tra i punti. Il passo applicato è
+// il valore della curva arrotondato a un multiplo dello step, mai sotto lo
+// step: a parità di velocità si copre la stessa banda con qualunque step.
+// Dopo una pausa o un'inversione di verso si riparte dallo step: la sintonia
+// lenta resta quella di sempre. Senza dipendenze Arduino: compila anche su host.
+
+struct AccelPoint {
+  uint16_t rate;              // Scatti al secondo
+  uint16_t hzPerDetent;       // Passo per scatto a quella velocità
+};
+
+class TuningAccel {
+public:
+  // curve: punti in ordine di velocità crescente; sotto il primo vale il primo
+  void begin(const AccelPoint* curve, uint8_t points, uint32_t idleUs);
+
+  // Scatti letti in questo giro -> passi di stepHz da applicare (con segno)
+  int32_t apply(int32_t detents, uint32_t nowUs, uint32_t stepHz);
+
+  uint16_t rate() const { return rateX16 / 16; }
+  uint32_t multiplier() const { return lastMultiplier; }
+
+private:
+  uint16_t hzAt(uint32_t rate) const;
+
+  const AccelPoint* curve = nullptr;
+  uint8_t points = 0;
+  uint32_t idle = 0;
+  uint32_t lastUs = 0;
+  uint32_t rateX16 = 0;       // Velocità media in 1/16 di scatto/s
+  int8_t lastDirection = 0;
+  uint32_t lastMultiplier = 1;
+};
+
+#endif
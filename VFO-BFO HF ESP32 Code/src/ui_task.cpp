@@ -0,0 +1,211 @@
+#include "ui_task.h"
+#include "config.h"
+#include "display.h"
+#include "display_dma.h"
+#include "s_meter.h"
+#include "bands.h"
+#include "modes.h"
+#include "functions.h"
+#include "sweep.h"
+#include "seqlock.h"
+#include "histogram.h"
+#include "profiler.h"
+#include <Arduino.h>
+
+static TaskHandle_t uiTaskHandle = nullptr;
+
+// Scritto dal loop, letto dal task UI
+static Seqlock<RadioSnapshot> radioSnapshot;
+
+// Statistiche (scritte solo dal task UI)
+static uint32_t uiFrames = 0;
+static uint32_t uiRedraws = 0;              // Fotogrammi con qualcosa da ridisegnare
+static uint32_t uiCoalesced = 0;            // Istantanee mai mostrate (superate dalla successiva)
+static uint32_t uiRegionDraws[UI_REGIONS];  // Ridisegni per zona
+static uint32_t uiLastVersion = 0;
+static uint32_t uiRetriesAtReset = 0;
+static LatencyHistogram uiDrawTime;         // Durata dei ridisegni (µs)
+
+void publishRadioState() {
+  RadioSnapshot s;
+  s.displayedFrequency = displayedFrequency;
+  s.step = step;
+  s.bfoFrequency = bfoFrequency;
+  s.mode = currentMode;
+  s.bfoEnabled = bfoEnabled;
+  s.agcFast = agcFastMode;
+  s.attenuator = attenuatorEnabled;
+  s.sMeter = sMeterValue;
+  s.sweepActive = sweepActive();
+  s.sweepPlot = sweepPlotReady();
+  radioSnapshot.write(s);
+}
+
+// Zone sporche: campi dell'istantanea diversi da quelli mostrati. Il picco
+// dell'S-meter scende col tempo anche a segnale fermo
+static uint16_t dirtyRegions(const RadioSnapshot& s, const RadioSnapshot& shown) {
+  uint16_t dirty = 0;
+  if (s.displayedFrequency != shown.displayedFrequency) dirty |= UI_FREQUENCY | UI_BAND;
+  if (s.step != shown.step) dirty |= UI_STEP;
+  if (s.bfoEnabled != shown.bfoEnabled || s.bfoFrequency != shown.bfoFrequency) dirty |= UI_BFO;
+  if (s.mode != shown.mode) dirty |= UI_MODE;
+  if (s.agcFast != shown.agcFast) dirty |= UI_AGC;
+  if (s.attenuator != shown.attenuator) dirty |= UI_ATT;
+  if (s.sweepActive != shown.sweepActive || s.sweepPlot != shown.sweepPlot) dirty |= UI_SWEEP;
+  if (!s.sweepActive && (s.sMeter != shown.sMeter || sMeterPeak > s.sMeter)) dirty |= UI_SMETER;
+  return dirty;
+}
+
+// Ridisegna le zone sporche con i valori dell'istantanea
+static void render(const RadioSnapshot& s, const RadioSnapshot& shown, uint16_t dirty) {
+  if (dirty & UI_FREQUENCY) {
+    PerfScope perf(PERF_UI_FREQUENCY);
+    updateFrequencyDisplay(s.displayedFrequency);
+  }
+  if (dirty & UI_BAND) updateBandInfo(s.displayedFrequency);
+  if (dirty & UI_STEP) updateStepDisplay(s.step);
+  if (dirty & UI_MODE) updateModeInfo(s.mode);
+  if (dirty & UI_BFO) {
+    PerfScope perf(PERF_UI_BFO);
+    drawBFODisplay(s.bfoEnabled, s.bfoFrequency);
+  }
+  if (dirty & UI_AGC) updateAGCDisplay(s.agcFast);
+  if (dirty & UI_ATT) updateATTDisplay(s.attenuator);
+
+  // Sweep: il grafico prende il posto dell'S-meter finché non viene chiuso
+  if (dirty & UI_SWEEP) {
+    if (s.sweepPlot && !shown.sweepPlot) drawSweepPlot();
+    if (!s.sweepActive && shown.sweepActive) {
+      setupSMeter();
+      drawSMeterScale();
+    }
+  }
+  if (dirty & UI_SMETER) {
+    PerfScope perf(PERF_UI_SMETER);
+    drawSMeter(s.sMeter);
+  }
+}
+
+// Stato del display (solo task UI)
+static RadioSnapshot uiShown = {};
+static bool uiFirstFrame = true;
+
+// Un fotogramma ogni UI_FRAME_MS al massimo: le istantanee pubblicate nel
+// frattempo si fondono e si disegna solo l'ultima, zona per zona
+void uiFrame() {
+  // Strisce in DMA del fotogramma precedente: finite prima di disegnare
+  displayFence();
+  if (uiFirstFrame) drawDisplayLayout();
+
+  RadioSnapshot s;
+  uint32_t version = radioSnapshot.read(s);
+  uint16_t dirty = uiFirstFrame ? (uint16_t)UI_ALL : dirtyRegions(s, uiShown);
+
+  uiFrames++;
+  if (!uiFirstFrame && version != uiLastVersion) {
+    uint32_t published = (version - uiLastVersion) / 2;
+    if (published > 1) uiCoalesced += published - 1;
+  }
+  uiLastVersion = version;
+  if (dirty == 0) return;
+
+  uint32_t start = micros();
+  {
+    PerfScope perf(PERF_UI_FRAME);
+    render(s, uiShown, dirty);
+    flushDisplay();           // Sprite in DMA: l'ultima striscia resta in volo
+  }
+  uint32_t elapsed = micros() - start;
+  uiShown = s;
+
+  uiRedraws++;
+  uiDrawTime.add(elapsed);
+  for (uint8_t i = 0; i < UI_REGIONS; i++) {
+    if (dirty & (1 << i)) uiRegionDraws[i]++;
+  }
+  uiFirstFrame = false;
+}
+
+static void uiTask(void*) {
+  TickType_t wake = xTaskGetTickCount();
+  for (;;) {
+    uiFrame();
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(UI_FRAME_MS));
+  }
+}
+
+void setupUiTask() {
+  uiDrawTime.reset();
+  publishRadioState();
+  xTaskCreatePinnedToCore(uiTask, "ui", UI_TASK_STACK, nullptr,
+                          UI_TASK_PRIORITY, &uiTaskHandle, UI_TASK_CORE);
+}
+
+void resetUiStats() {
+  uiFrames = 0;
+  uiRedraws = 0;
+  uiCoalesced = 0;
+  memset(uiRegionDraws, 0, sizeof(uiRegionDraws));
+  uiRetriesAtReset = radioSnapshot.retries;
+  uiDrawTime.reset();
+  freqDisplayStats = {0, 0, 0};
+  displayDmaStats = {0, 0, 0, 0};
+}
+
+void printUiStats() {
+  Serial.println("=== Task UI ===");
+  Serial.print("Core: ");
+  Serial.print(UI_TASK_CORE);
+  Serial.print(", fotogrammi: ");
+  Serial.print(uiFrames);
+  Serial.print(", con ridisegno: ");
+  Serial.println(uiRedraws);
+
+  Serial.print("Istantanee pubblicate: ");
+  Serial.print(radioSnapshot.version() / 2);
+  Serial.print(", fuse nel fotogramma dopo: ");
+  Serial.print(uiCoalesced);
+  Serial.print(", letture ripetute: ");
+  Serial.println(radioSnapshot.retries - uiRetriesAtReset);
+
+  static const char* const regionNames[UI_REGIONS] = {
+    "frequenza", "step", "BFO", "banda", "modo", "AGC", "ATT", "sweep", "S-meter"
+  };
+  Serial.print("Zone ridisegnate:");
+  for (uint8_t i = 0; i < UI_REGIONS; i++) {
+    Serial.print(" ");
+    Serial.print(regionNames[i]);
+    Serial.print(" ");
+    Serial.print(uiRegionDraws[i]);
+  }
+  Serial.println();
+
+  Serial.print("Ridisegno (us) p50: ");
+  Serial.print(uiDrawTime.percentile(50));
+  Serial.print(" p99: ");
+  Serial.print(uiDrawTime.percentile(99));
+  Serial.print(" max: ");
+  Serial.println(uiDrawTime.max);
+
+  Serial.print("Frequenza: ");
+  Serial.print(freqDisplayStats.updates);
+  Serial.print(" ridisegni, celle per ridisegno: ");
+  Serial.print(freqDisplayStats.updates ? (float)freqDisplayStats.cells / freqDisplayStats.updates : 0.0f, 1);
+  Serial.print(", pixel per ridisegno: ");
+  Serial.println(freqDisplayStats.updates ? freqDisplayStats.pixels / freqDisplayStats.updates : 0);
+
+  Serial.print("DMA: ");
+  Serial.print(displayDmaStats.windows);
+  Serial.print(" finestre, ");
+  Serial.print(displayDmaStats.strips);
+  Serial.print(" strisce, ");
+  Serial.print(displayDmaStats.pixels);
+  Serial.print(" pixel, recinti in attesa: ");
+  Serial.println(displayDmaStats.fenceWaits);
+
+  if (uiTaskHandle != nullptr) {
+    Serial.print("Stack libero: ");
+    Serial.print(uxTaskGetStackHighWaterMark(uiTaskHandle));
+    Serial.println(" byte");
+  }
+}
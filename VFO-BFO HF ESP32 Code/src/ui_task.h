@@ -0,0 +1,49 @@
+#ifndef UI_TASK_H
+#define UI_TASK_H
+
+#include <stdint.h>
+
+// Task FreeRTOS del display, sul core UI_TASK_CORE: encoder, Si5351, DigiOUT ed
+// EEPROM restano sull'altro core (loop e task radio), così il disegno non può
+// ritardare una sintonia. Il loop pubblica lo stato in un'istantanea (seqlock),
+// il task UI la copia una volta per fotogramma e ridisegna solo le zone
+// cambiate. Al più UI_MAX_FPS fotogrammi al secondo: durante una rotazione
+// veloce le istantanee intermedie si perdono e si mostra sempre l'ultima.
+// Dopo setupUiTask() nessun altro deve toccare tft.
+
+// Stato della radio visto dal display
+struct RadioSnapshot {
+  uint32_t displayedFrequency;
+  uint32_t step;
+  uint32_t bfoFrequency;
+  uint8_t mode;
+  bool bfoEnabled;
+  bool agcFast;
+  bool attenuator;
+  uint8_t sMeter;           // Segmenti accesi (0..S_METER_SEGMENTS)
+  bool sweepActive;         // Sweep in corso o grafico visibile: S-meter sospeso
+  bool sweepPlot;           // Grafico dello sweep da mostrare
+};
+
+// Zone del display, una per bit: un fotogramma ridisegna solo quelle sporche
+enum UiRegion : uint16_t {
+  UI_FREQUENCY = 1 << 0,
+  UI_STEP      = 1 << 1,
+  UI_BFO       = 1 << 2,    // Frequenza e grafico del BFO
+  UI_BAND      = 1 << 3,    // Riquadro BAND: segue la frequenza
+  UI_MODE      = 1 << 4,
+  UI_AGC       = 1 << 5,
+  UI_ATT       = 1 << 6,
+  UI_SWEEP     = 1 << 7,    // Grafico dello sweep, o ritorno all'S-meter
+  UI_SMETER    = 1 << 8,    // Segmenti e picco
+  UI_ALL       = (1 << 9) - 1
+};
+#define UI_REGIONS 9
+
+void setupUiTask();         // Disegna il layout e avvia il task
+void publishRadioState();   // Dal commit dello stato: nuova istantanea
+void uiFrame();             // Un fotogramma (dal task; su PC da src/tools/latency_bench.cpp)
+void printUiStats();        // Statistiche su seriale (comando UI)
+void resetUiStats();
+
+#endif
@@ -0,0 +1,126 @@
+#include "wspr.h"
+#include <string.h>
+
+const uint8_t wsprSync[WSPR_SYMBOL_COUNT] = {
+  1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1, 0, 0, 0,
+  0, 0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 0, 1,
+  1, 0, 1, 0, 0, 0, 0, 1, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1,
+  1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 1, 1, 0, 0, 1, 1,
+  0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
+  1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0
+};
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static bool isLetter(char c) { return c >= 'A' && c <= 'Z'; }
+
+static char upper(char c) {
+  return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+// 0-9 -> 0-9, A-Z -> 10-35, spazio -> 36
+static uint8_t charValue(char c) {
+  if (isDigit(c)) return c - '0';
+  if (isLetter(c)) return c - 'A' + 10;
+  return 36;
+}
+
+// Nominativo su 6 caratteri con la cifra in terza posizione
+static bool normalizeCall(const char* call, char out[6]) {
+  size_t len = strlen(call);
+  if (len < 3 || len > 6) return false;
+
+  char c[7];
+  for (size_t i = 0; i < len; i++) c[i] = upper(call[i]);
+
+  // "K1ABC" -> " K1ABC"
+  size_t offset = isDigit(c[1]) && !isDigit(c[2]) ? 1 : 0;
+  if (len + offset > 6) return false;
+
+  memset(out, ' ', 6);
+  memcpy(out + offset, c, len);
+
+  if (!(isDigit(out[0]) || isLetter(out[0]) || out[0] == ' ')) return false;
+  if (!(isDigit(out[1]) || isLetter(out[1]))) return false;
+  if (!isDigit(out[2])) return false;
+  for (uint8_t i = 3; i < 6; i++) {
+    if (!(isLetter(out[i]) || out[i] == ' ')) return false;
+  }
+  return true;
+}
+
+bool wsprPack(const char* call, const char* locator, int8_t dBm, uint8_t packed[11]) {
+  char c[6];
+  if (!normalizeCall(call, c)) return false;
+
+  char l[4];
+  if (strlen(locator) != 4) return false;
+  for (uint8_t i = 0; i < 4; i++) l[i] = upper(locator[i]);
+  if (l[0] < 'A' || l[0] > 'R' || l[1] < 'A' || l[1] > 'R') return false;
+  if (!isDigit(l[2]) || !isDigit(l[3])) return false;
+
+  // Potenze ammesse: 0..60 dBm terminanti in 0, 3 o 7
+  uint8_t last = dBm % 10;
+  if (dBm < 0 || dBm > 60 || (last != 0 && last != 3 && last != 7)) return false;
+
+  // Nominativo in 28 bit
+  uint32_t n = charValue(c[0]);
+  n = n * 36 + charValue(c[1]);
+  n = n * 10 + charValue(c[2]);
+  for (uint8_t i = 3; i < 6; i++) n = n * 27 + charValue(c[i]) - 10;
+
+  // Locatore (15 bit) e potenza (7 bit)
+  uint32_t m = (179 - 10 * (l[0] - 'A') - (l[2] - '0')) * 180 + 10 * (l[1] - 'A') + (l[3] - '0');
+  m = m * 128 + dBm + 64;
+
+  memset(packed, 0, 11);
+  packed[0] = n >> 20;
+  packed[1] = n >> 12;
+  packed[2] = n >> 4;
+  packed[3] = ((n & 0x0F) << 4) | ((m >> 18) & 0x0F);
+  packed[4] = m >> 10;
+  packed[5] = m >> 2;
+  packed[6] = (m & 0x03) << 6;
+  return true;
+}
+
+static uint8_t parity(uint32_t value) {
+  return __builtin_parity(value);
+}
+
+uint8_t wsprInterleave(uint8_t index) {
+  // Inversione dei bit dell'indice a 8 bit, saltando i valori oltre 161
+  uint8_t p = 0;
+  for (uint16_t i = 0; i < 256; i++) {
+    uint8_t j = (uint8_t)i;
+    j = (j & 0xF0) >> 4 | (j & 0x0F) << 4;
+    j = (j & 0xCC) >> 2 | (j & 0x33) << 2;
+    j = (j & 0xAA) >> 1 | (j & 0x55) << 1;
+    if (j >= WSPR_SYMBOL_COUNT) continue;
+    if (p == index) return j;
+    p++;
+  }
+  return 0;
+}
+
+bool wsprEncode(const char* call, const char* locator, int8_t dBm, uint8_t symbols[WSPR_SYMBOL_COUNT]) {
+  uint8_t packed[11];
+  if (!wsprPack(call, locator, dBm, packed)) return false;
+
+  // Convoluzione: due bit per bit d'ingresso, 81 bit -> 162 simboli
+  uint8_t coded[WSPR_SYMBOL_COUNT];
+  uint32_t reg = 0;
+  uint8_t k = 0;
+  for (uint8_t i = 0; i < WSPR_ENCODED_BITS; i++) {
+    uint8_t bit = (packed[i / 8] >> (7 - i % 8)) & 1;
+    reg = (reg << 1) | bit;
+    coded[k++] = parity(reg & WSPR_POLY1);
+    coded[k++] = parity(reg & WSPR_POLY2);
+  }
+
+  // Interleave e sincronismo: tono = sync + 2 * dato
+  for (uint8_t i = 0; i < WSPR_SYMBOL_COUNT; i++) {
+    uint8_t j = wsprInterleave(i);
+    symbols[j] = wsprSync[j] + 2 * coded[i];
+  }
+  return true;
+}
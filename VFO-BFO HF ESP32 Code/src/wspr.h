@@ -0,0 +1,41 @@
+#ifndef WSPR_H
+#define WSPR_H
+
+#include <stdint.h>
+
+// Codifica di un messaggio WSPR tipo 1 (nominativo, locatore a 4 caratteri,
+// potenza in dBm) nei 162 simboli a 4 toni da trasmettere.
+// Senza dipendenze Arduino: compila anche su host (src/tools/wspr_check.cpp).
+
+#define WSPR_SYMBOL_COUNT 162
+#define WSPR_TONES 4
+#define WSPR_BITS 50                // 28 bit nominativo + 15 locatore + 7 potenza
+#define WSPR_ENCODED_BITS 81        // Dati + 31 bit di coda del codificatore
+
+// Tempo di simbolo e spaziatura toni: 8192 campioni a 12000Hz
+#define WSPR_SYMBOL_NUM 8192
+#define WSPR_SYMBOL_DEN 12000
+
+// Spaziatura del tono k in millesimi di Hz (k * 12000/8192 Hz)
+inline uint32_t wsprToneMilliHz(uint8_t tone) {
+  return (uint32_t)(((uint64_t)tone * WSPR_SYMBOL_DEN * 1000 + WSPR_SYMBOL_NUM / 2) / WSPR_SYMBOL_NUM);
+}
+
+// Vettore di sincronismo: bit 0 di ogni simbolo
+extern const uint8_t wsprSync[WSPR_SYMBOL_COUNT];
+
+// Polinomi del codice convoluzionale K=32, r=1/2
+#define WSPR_POLY1 0xF2D05351UL
+#define WSPR_POLY2 0xE4613C47UL
+
+// Impacchetta il messaggio nei primi 50 bit di packed (MSB per primo).
+// false se nominativo, locatore o potenza non sono validi.
+bool wsprPack(const char* call, const char* locator, int8_t dBm, uint8_t packed[11]);
+
+// Codifica completa: pacchetto -> convoluzione -> interleave -> sincronismo
+bool wsprEncode(const char* call, const char* locator, int8_t dBm, uint8_t symbols[WSPR_SYMBOL_COUNT]);
+
+// Indice di interleave: posizione del simbolo i-esimo della convoluzione
+uint8_t wsprInterleave(uint8_t index);
+
+#endif